@@ -20,6 +20,7 @@
 // XR_DOCS_TAG_BEGIN_include_GraphicsAPI_Vulkan
 #include <GraphicsAPI_Vulkan.h>
 // XR_DOCS_TAG_END_include_GraphicsAPI_Vulkan
+#include <GraphicsAPI_Null.h>
 // XR_DOCS_TAG_BEGIN_include_OpenXRDebugUtils
 #include <OpenXRDebugUtils.h>
 // XR_DOCS_TAG_END_include_OpenXRDebugUtils
@@ -498,6 +499,8 @@ private:
 #if defined(XR_USE_GRAPHICS_API_VULKAN)
             m_graphicsAPI = std::make_unique<GraphicsAPI_Vulkan>(m_xrInstance, m_systemID);
 #endif
+        } else if (m_apiType == NULL_API) {
+            m_graphicsAPI = std::make_unique<GraphicsAPI_Null>(m_xrInstance, m_systemID);
         } else {
             XR_TUT_LOG_ERROR("ERROR: Unknown Graphics API.");
             DEBUG_BREAK;
@@ -579,7 +582,8 @@ private:
         // XR_DOCS_TAG_BEGIN_Update_numberOfCuboids
         size_t numberOfCuboids = m_maxBlockCount + 2 + 2;
         // XR_DOCS_TAG_END_Update_numberOfCuboids
-        m_uniformBuffer_Camera = m_graphicsAPI->CreateBuffer({GraphicsAPI::BufferCreateInfo::Type::UNIFORM, 0, sizeof(CameraConstants) * numberOfCuboids, nullptr});
+        // Each cuboid's constants are a separate allocation, rounded up to the transient alignment.
+        m_graphicsAPI->ReserveTransientUniformData(Align<size_t>(sizeof(CameraConstants), m_graphicsAPI->GetTransientAlignment()) * numberOfCuboids);
         m_uniformBuffer_Normals = m_graphicsAPI->CreateBuffer({GraphicsAPI::BufferCreateInfo::Type::UNIFORM, 0, sizeof(normals), &normals});
         // XR_DOCS_TAG_END_CreateResources1_1
 
@@ -635,6 +639,11 @@ private:
             m_fragmentShader = m_graphicsAPI->CreateShader({GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT, fragmentSource.data(), fragmentSource.size()});
         }
         // XR_DOCS_TAG_END_CreateResources2_D3D
+        if (m_apiType == NULL_API) {
+            // GraphicsAPI_Null doesn't compile shaders, so no source is needed.
+            m_vertexShader = m_graphicsAPI->CreateShader({GraphicsAPI::ShaderCreateInfo::Type::VERTEX, nullptr, 0});
+            m_fragmentShader = m_graphicsAPI->CreateShader({GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT, nullptr, 0});
+        }
 
         // XR_DOCS_TAG_BEGIN_CreateResources3
         GraphicsAPI::PipelineCreateInfo pipelineCI;
@@ -685,7 +694,6 @@ private:
         m_graphicsAPI->DestroyPipeline(m_pipeline);
         m_graphicsAPI->DestroyShader(m_fragmentShader);
         m_graphicsAPI->DestroyShader(m_vertexShader);
-        m_graphicsAPI->DestroyBuffer(m_uniformBuffer_Camera);
         m_graphicsAPI->DestroyBuffer(m_uniformBuffer_Normals);
         m_graphicsAPI->DestroyBuffer(m_indexBuffer);
         m_graphicsAPI->DestroyBuffer(m_vertexBuffer);
@@ -1062,21 +1070,18 @@ private:
         // XR_DOCS_TAG_END_DestroySwapchains
     }
 
-    // XR_DOCS_TAG_BEGIN_RenderCuboid1
-    size_t renderCuboidIndex = 0;
-    // XR_DOCS_TAG_END_RenderCuboid1
     void RenderCuboid(XrPosef pose, XrVector3f scale, XrVector3f color) {
         // XR_DOCS_TAG_BEGIN_RenderCuboid2
         XrMatrix4x4f_CreateTranslationRotationScale(&cameraConstants.model, &pose.position, &pose.orientation, &scale);
 
         XrMatrix4x4f_Multiply(&cameraConstants.modelViewProj, &cameraConstants.viewProj, &cameraConstants.model);
         cameraConstants.color = {color.x, color.y, color.z, 1.0};
-        size_t offsetCameraUB = sizeof(CameraConstants) * renderCuboidIndex;
 
         m_graphicsAPI->SetPipeline(m_pipeline);
 
-        m_graphicsAPI->SetBufferData(m_uniformBuffer_Camera, offsetCameraUB, sizeof(CameraConstants), &cameraConstants);
-        m_graphicsAPI->SetDescriptor({0, m_uniformBuffer_Camera, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::VERTEX, false, offsetCameraUB, sizeof(CameraConstants)});
+        // Copy the constants into this frame's transient uniform memory and bind that range.
+        GraphicsAPI::TransientAllocation cameraConstantsUB = m_graphicsAPI->AllocateTransientUniformData(sizeof(CameraConstants), &cameraConstants);
+        m_graphicsAPI->SetDescriptor({0, cameraConstantsUB.buffer, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::VERTEX, false, cameraConstantsUB.offset, cameraConstantsUB.size});
         m_graphicsAPI->SetDescriptor({1, m_uniformBuffer_Normals, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::VERTEX, false, 0, sizeof(normals)});
 
         m_graphicsAPI->UpdateDescriptors();
@@ -1084,8 +1089,6 @@ private:
         m_graphicsAPI->SetVertexBuffers(&m_vertexBuffer, 1);
         m_graphicsAPI->SetIndexBuffer(m_indexBuffer);
         m_graphicsAPI->DrawIndexed(36);
-
-        renderCuboidIndex++;
         // XR_DOCS_TAG_END_RenderCuboid2
     }
 
@@ -1225,7 +1228,6 @@ private:
             // XR_DOCS_TAG_END_SetupFrameRendering
 
             // XR_DOCS_TAG_BEGIN_CallRenderCuboid
-            renderCuboidIndex = 0;
             // Draw a floor. Scale it by 2 in the X and Z, and 0.1 in the Y,
             RenderCuboid({{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, -m_viewHeightM, 0.0f}}, {2.0f, 0.1f, 2.0f}, {0.4f, 0.5f, 0.5f});
             // Draw a "table".
@@ -1400,8 +1402,6 @@ private:
     // Vertex and index buffers: geometry for our cuboids.
     void *m_vertexBuffer = nullptr;
     void *m_indexBuffer = nullptr;
-    // Camera values constant buffer for the shaders.
-    void *m_uniformBuffer_Camera = nullptr;
     // The normals are stored in a uniform buffer to simplify our vertex geometry.
     void *m_uniformBuffer_Normals = nullptr;
 
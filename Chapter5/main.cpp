@@ -20,6 +20,13 @@
 // XR_DOCS_TAG_BEGIN_include_GraphicsAPI_Vulkan
 #include <GraphicsAPI_Vulkan.h>
 // XR_DOCS_TAG_END_include_GraphicsAPI_Vulkan
+#include <GraphicsAPI_Null.h>
+#include <FileView.h>
+#include <FrameTimings.h>
+#include <JobSystem.h>
+#include <SpatialGrid.h>
+#include <ThreadPool.h>
+#include <TripleBuffer.h>
 // XR_DOCS_TAG_BEGIN_include_OpenXRDebugUtils
 #include <OpenXRDebugUtils.h>
 // XR_DOCS_TAG_END_include_OpenXRDebugUtils
@@ -41,6 +48,7 @@ XrVector3f operator*(XrVector3f a, float b) {
     return {a.x * b, a.y * b, a.z * b};
 }
 // XR_DOCS_TAG_END_include_linear_algebra
+#include <xr_linear_algebra_batch.h>
 // XR_DOCS_TAG_BEGIN_include_algorithm_random
 // Include <algorithm> for std::min and max
 #include <algorithm>
@@ -49,6 +57,11 @@ XrVector3f operator*(XrVector3f a, float b) {
 static std::uniform_real_distribution<float> pseudorandom_distribution(0, 1.f);
 static std::mt19937 pseudo_random_generator;
 // XR_DOCS_TAG_END_include_algorithm_random
+#include <condition_variable>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <thread>
 
 #define XR_DOCS_CHAPTER_VERSION XR_DOCS_CHAPTER_5_2
 
@@ -113,6 +126,7 @@ public:
 #if XR_DOCS_CHAPTER_VERSION >= XR_DOCS_CHAPTER_3_3
         CreateResources();
 #endif
+        StartSimulationThread();
 
 #if XR_DOCS_CHAPTER_VERSION >= XR_DOCS_CHAPTER_2_3
         while (m_applicationRunning) {
@@ -123,6 +137,19 @@ public:
             }
         }
 #endif
+        StopSimulationThread();
+
+        // Set XR_TUTORIAL_FRAME_TIMINGS to a path prefix to also write the per-frame timings to <prefix>.csv and <prefix>.json.
+        m_frameTimings.LogSummary();
+        LogGpuTimings();
+        LogStateStatistics();
+        LogCullingStats();
+        LogJobStatistics();
+        std::string frameTimingsPath = GetEnv("XR_TUTORIAL_FRAME_TIMINGS");
+        if (!frameTimingsPath.empty()) {
+            m_frameTimings.WriteCSV(frameTimingsPath + ".csv");
+            m_frameTimings.WriteJSON(frameTimingsPath + ".json");
+        }
 
 #if XR_DOCS_CHAPTER_VERSION >= XR_DOCS_CHAPTER_3_1
         DestroySwapchains();
@@ -538,8 +565,15 @@ private:
 #endif
         } else if (m_apiType == VULKAN) {
 #if defined(XR_USE_GRAPHICS_API_VULKAN)
-            m_graphicsAPI = std::make_unique<GraphicsAPI_Vulkan>(m_xrInstance, m_systemID);
+#if defined(__ANDROID__)
+            const std::string pipelineCachePath = std::string(androidApp->activity->internalDataPath) + "/pipeline_cache_vulkan.bin";
+#else
+            const std::string pipelineCachePath = "pipeline_cache_vulkan.bin";
 #endif
+            m_graphicsAPI = std::make_unique<GraphicsAPI_Vulkan>(m_xrInstance, m_systemID, 2, pipelineCachePath);
+#endif
+        } else if (m_apiType == NULL_API) {
+            m_graphicsAPI = std::make_unique<GraphicsAPI_Null>(m_xrInstance, m_systemID);
         } else {
             XR_TUT_LOG_ERROR("ERROR: Unknown Graphics API.");
             DEBUG_BREAK;
@@ -570,15 +604,91 @@ private:
 
     // XR_DOCS_TAG_BEGIN_CreateResources1
     struct CameraConstants {
-        XrMatrix4x4f viewProj;
-        XrMatrix4x4f modelViewProj;
+        // The multiview shaders index this with the view index. The others only read viewProj[0].
+        XrMatrix4x4f viewProj[2];
+    };
+    CameraConstants cameraConstants;
+    // Per-cuboid data, read by the vertex shader from a per-instance vertex buffer.
+    struct CuboidInstance {
         XrMatrix4x4f model;
         XrVector4f color;
-        XrVector4f pad1;
-        XrVector4f pad2;
-        XrVector4f pad3;
     };
-    CameraConstants cameraConstants;
+    std::vector<CuboidInstance> m_cuboidInstances;
+    // The poses and scales of the queued cuboids as a structure of arrays, the layout the batch transform functions take.
+    struct CuboidTransforms {
+        std::vector<float> positionX, positionY, positionZ;
+        std::vector<float> orientationX, orientationY, orientationZ, orientationW;
+        std::vector<float> scaleX, scaleY, scaleZ;
+
+        void Add(const XrPosef &pose, const XrVector3f &scale) {
+            positionX.push_back(pose.position.x);
+            positionY.push_back(pose.position.y);
+            positionZ.push_back(pose.position.z);
+            orientationX.push_back(pose.orientation.x);
+            orientationY.push_back(pose.orientation.y);
+            orientationZ.push_back(pose.orientation.z);
+            orientationW.push_back(pose.orientation.w);
+            scaleX.push_back(scale.x);
+            scaleY.push_back(scale.y);
+            scaleZ.push_back(scale.z);
+        }
+        void Clear() {
+            for (std::vector<float> *elements : GetElements()) {
+                elements->clear();
+            }
+        }
+        void Reserve(size_t count) {
+            for (std::vector<float> *elements : GetElements()) {
+                elements->reserve(count);
+            }
+        }
+        // The transforms from index first onwards.
+        XrTransformsSoA Get(size_t first = 0) const {
+            return {positionX.data() + first, positionY.data() + first, positionZ.data() + first, orientationX.data() + first, orientationY.data() + first, orientationZ.data() + first, orientationW.data() + first, scaleX.data() + first, scaleY.data() + first, scaleZ.data() + first};
+        }
+        std::vector<std::vector<float> *> GetElements() {
+            return {&positionX, &positionY, &positionZ, &orientationX, &orientationY, &orientationZ, &orientationW, &scaleX, &scaleY, &scaleZ};
+        }
+    };
+    CuboidTransforms m_cuboidTransforms;
+    // The number of cuboids culled by RenderCuboid() since the last RenderCuboids().
+    uint64_t m_culledCuboidCount = 0;
+    // The number of objects drawn and culled, summed over the views and frames.
+    struct CullingStats {
+        uint64_t drawn = 0;
+        uint64_t culled = 0;
+    };
+    CullingStats m_cuboidCullingStats;
+    CullingStats m_handJointCullingStats;
+    // The view-projection of a frustum containing all the views, that cuboids are culled against.
+    XrMatrix4x4f m_cullViewProj;
+    // The cuboids prepared for this frame, as ranges of m_cuboidInstances.
+    struct CuboidRange {
+        uint32_t first = 0;
+        uint32_t count = 0;
+    };
+    CuboidRange m_sceneCuboids;
+    CuboidRange m_handJointCuboids;
+    // A cuboid passed to RenderCuboid().
+    struct SceneCuboid {
+        XrPosef pose;
+        XrVector3f scale;
+        XrVector3f color;
+    };
+    // The cuboids to draw in a frame, captured by CaptureScene() from the state that PollActions() and BlockInteraction()
+    // update. The rendering thread only reads the scene from a snapshot, so that with pipelined frames the simulation
+    // thread can update that state while a frame is drawn.
+    struct SceneSnapshot {
+        XrTime predictedDisplayTime = 0;  // The time the actions were polled for.
+        std::vector<SceneCuboid> cuboids;
+        size_t handJointCuboidsFirst = 0;  // The hand joint cuboids follow the rest of the scene.
+        // Nanoseconds spent on the simulation thread, added to the timings of the frame that draws the snapshot.
+        int64_t pollActionsDuration = 0;
+        int64_t blockInteractionDuration = 0;
+    };
+    TripleBuffer<SceneSnapshot> m_sceneSnapshots;
+    // The snapshot that RenderCuboid() adds to, while CaptureScene() runs.
+    SceneSnapshot *m_capturingScene = nullptr;
     XrVector4f normals[6] = {
         {1.00f, 0.00f, 0.00f, 0},
         {-1.00f, 0.00f, 0.00f, 0},
@@ -621,9 +731,9 @@ private:
             30, 31, 32, 33, 34, 35,  // +Z
         };
 
-        m_vertexBuffer = m_graphicsAPI->CreateBuffer({GraphicsAPI::BufferCreateInfo::Type::VERTEX, sizeof(float) * 4, sizeof(cubeVertices), &cubeVertices});
+        m_vertexBuffer = m_graphicsAPI->CreateBuffer({GraphicsAPI::BufferCreateInfo::Type::VERTEX, sizeof(float) * 4, sizeof(cubeVertices), &cubeVertices, GraphicsAPI::BufferCreateInfo::Usage::STATIC});
 
-        m_indexBuffer = m_graphicsAPI->CreateBuffer({GraphicsAPI::BufferCreateInfo::Type::INDEX, sizeof(uint32_t), sizeof(cubeIndices), &cubeIndices});
+        m_indexBuffer = m_graphicsAPI->CreateBuffer({GraphicsAPI::BufferCreateInfo::Type::INDEX, sizeof(uint32_t), sizeof(cubeIndices), &cubeIndices, GraphicsAPI::BufferCreateInfo::Usage::STATIC});
 
         // XR_DOCS_TAG_BEGIN_Update_numberOfCuboids
         size_t numberOfCuboids = 64 + 2 + 2;
@@ -631,80 +741,77 @@ private:
         // XR_DOCS_TAG_BEGIN_AddHandCuboids
         numberOfCuboids += XR_HAND_JOINT_COUNT_EXT * 2;
         // XR_DOCS_TAG_END_AddHandCuboids
-        m_uniformBuffer_Camera = m_graphicsAPI->CreateBuffer({GraphicsAPI::BufferCreateInfo::Type::UNIFORM, 0, sizeof(CameraConstants) * numberOfCuboids, nullptr});
-        m_uniformBuffer_Normals = m_graphicsAPI->CreateBuffer({GraphicsAPI::BufferCreateInfo::Type::UNIFORM, 0, sizeof(normals), &normals});
+        m_graphicsAPI->ReserveTransientVertexData(sizeof(CuboidInstance) * numberOfCuboids);
+        m_cuboidInstances.reserve(numberOfCuboids);
+        m_cuboidTransforms.Reserve(numberOfCuboids);
+        m_uniformBuffer_Normals = m_graphicsAPI->CreateBuffer({GraphicsAPI::BufferCreateInfo::Type::UNIFORM, 0, sizeof(normals), &normals, GraphicsAPI::BufferCreateInfo::Usage::STATIC});
         // XR_DOCS_TAG_END_CreateResources1_1
 
+        // Shaders and the pipeline are created on m_resourceThreadPool when the graphics API allows it, so that the event loop
+        // keeps running while they compile. Set XR_TUTORIAL_SYNC_RESOURCES to create them here instead.
+        m_resourceCreationStart = std::chrono::steady_clock::now();
+        if (m_graphicsAPI->SupportsThreadedPipelineCreation() && GetEnv("XR_TUTORIAL_SYNC_RESOURCES").empty()) {
+            // One thread per shader stage.
+            m_resourceThreadPool = std::make_unique<ThreadPool>(2);
+        }
+        // Work split out of the frame loop runs on m_jobSystem. The scene is recorded in chunks on it when the graphics API
+        // allows it. Set XR_TUTORIAL_NO_PARALLEL_RECORDING to record it all on the rendering thread instead.
+        m_jobSystem = std::make_unique<JobSystem>();
+        m_parallelRecording = m_graphicsAPI->SupportsParallelRecording() && GetEnv("XR_TUTORIAL_NO_PARALLEL_RECORDING").empty();
+        XR_TUT_LOG("Job system running on " << m_jobSystem->GetWorkerCount() + 1 << " threads" << (m_parallelRecording ? ", recording the scene in parallel." : "."));
+        std::shared_future<void *> vertexShader, fragmentShader;
+
         // XR_DOCS_TAG_BEGIN_CreateResources2_OpenGL
         if (m_apiType == OPENGL) {
-            std::string vertexSource = ReadTextFile("VertexShader.glsl");
-            m_vertexShader = m_graphicsAPI->CreateShader({GraphicsAPI::ShaderCreateInfo::Type::VERTEX, vertexSource.data(), vertexSource.size()});
-
-            std::string fragmentSource = ReadTextFile("PixelShader.glsl");
-            m_fragmentShader = m_graphicsAPI->CreateShader({GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT, fragmentSource.data(), fragmentSource.size()});
+            vertexShader = CreateShaderTask(GraphicsAPI::ShaderCreateInfo::Type::VERTEX, []() { return FileView("VertexShader_Instanced.glsl"); });
+            fragmentShader = CreateShaderTask(GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT, []() { return FileView("PixelShader.glsl"); });
         }
         // XR_DOCS_TAG_END_CreateResources2_OpenGL
         // XR_DOCS_TAG_BEGIN_CreateResources2_VulkanWindowsLinux
         if (m_apiType == VULKAN) {
-            std::vector<char> vertexSource = ReadBinaryFile("VertexShader.spv");
-            m_vertexShader = m_graphicsAPI->CreateShader({GraphicsAPI::ShaderCreateInfo::Type::VERTEX, vertexSource.data(), vertexSource.size()});
-
-            std::vector<char> fragmentSource = ReadBinaryFile("PixelShader.spv");
-            m_fragmentShader = m_graphicsAPI->CreateShader({GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT, fragmentSource.data(), fragmentSource.size()});
+            const char *vertexShaderFilepath = m_multiview ? "VertexShader_Instanced_MV.spv" : "VertexShader_Instanced.spv";
+            vertexShader = CreateShaderTask(GraphicsAPI::ShaderCreateInfo::Type::VERTEX, [vertexShaderFilepath]() { return FileView(vertexShaderFilepath); });
+            fragmentShader = CreateShaderTask(GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT, []() { return FileView("PixelShader.spv"); });
         }
         // XR_DOCS_TAG_END_CreateResources2_VulkanWindowsLinux
 #if defined(__ANDROID__)
         // XR_DOCS_TAG_BEGIN_CreateResources2_VulkanAndroid
         if (m_apiType == VULKAN) {
-            std::vector<char> vertexSource = ReadBinaryFile("shaders/VertexShader.spv", androidApp->activity->assetManager);
-            m_vertexShader = m_graphicsAPI->CreateShader({GraphicsAPI::ShaderCreateInfo::Type::VERTEX, vertexSource.data(), vertexSource.size()});
-            std::vector<char> fragmentSource = ReadBinaryFile("shaders/PixelShader.spv", androidApp->activity->assetManager);
-            m_fragmentShader = m_graphicsAPI->CreateShader({GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT, fragmentSource.data(), fragmentSource.size()});
+            const char *vertexShaderFilepath = m_multiview ? "shaders/VertexShader_Instanced_MV.spv" : "shaders/VertexShader_Instanced.spv";
+            vertexShader = CreateShaderTask(GraphicsAPI::ShaderCreateInfo::Type::VERTEX, [vertexShaderFilepath]() { return FileView(vertexShaderFilepath, androidApp->activity->assetManager); });
+            fragmentShader = CreateShaderTask(GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT, []() { return FileView("shaders/PixelShader.spv", androidApp->activity->assetManager); });
         }
         // XR_DOCS_TAG_END_CreateResources2_VulkanAndroid
         // XR_DOCS_TAG_BEGIN_CreateResources2_OpenGLES
         if (m_apiType == OPENGL_ES) {
-            std::string vertexSource = ReadTextFile("shaders/VertexShader_GLES.glsl", androidApp->activity->assetManager);
-            m_vertexShader = m_graphicsAPI->CreateShader({GraphicsAPI::ShaderCreateInfo::Type::VERTEX, vertexSource.data(), vertexSource.size()});
-            std::string fragmentSource = ReadTextFile("shaders/PixelShader_GLES.glsl", androidApp->activity->assetManager);
-            m_fragmentShader = m_graphicsAPI->CreateShader({GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT, fragmentSource.data(), fragmentSource.size()});
+            const char *vertexShaderFilepath = m_multiview ? "shaders/VertexShader_Instanced_GLES_MV.glsl" : "shaders/VertexShader_Instanced_GLES.glsl";
+            vertexShader = CreateShaderTask(GraphicsAPI::ShaderCreateInfo::Type::VERTEX, [vertexShaderFilepath]() { return FileView(vertexShaderFilepath, androidApp->activity->assetManager); });
+            fragmentShader = CreateShaderTask(GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT, []() { return FileView("shaders/PixelShader_GLES.glsl", androidApp->activity->assetManager); });
         }
         // XR_DOCS_TAG_END_CreateResources2_OpenGLES
 #endif
         // XR_DOCS_TAG_BEGIN_CreateResources2_D3D
         if (m_apiType == D3D11) {
-            std::vector<char> vertexSource = ReadBinaryFile("VertexShader_5_0.cso");
-            m_vertexShader = m_graphicsAPI->CreateShader({GraphicsAPI::ShaderCreateInfo::Type::VERTEX, vertexSource.data(), vertexSource.size()});
-
-            std::vector<char> fragmentSource = ReadBinaryFile("PixelShader_5_0.cso");
-            m_fragmentShader = m_graphicsAPI->CreateShader({GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT, fragmentSource.data(), fragmentSource.size()});
+            vertexShader = CreateShaderTask(GraphicsAPI::ShaderCreateInfo::Type::VERTEX, []() { return FileView("VertexShader_Instanced_5_0.cso"); });
+            fragmentShader = CreateShaderTask(GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT, []() { return FileView("PixelShader_5_0.cso"); });
         }
         if (m_apiType == D3D12) {
-            std::vector<char> vertexSource = ReadBinaryFile("VertexShader_5_1.cso");
-            m_vertexShader = m_graphicsAPI->CreateShader({GraphicsAPI::ShaderCreateInfo::Type::VERTEX, vertexSource.data(), vertexSource.size()});
-
-            std::vector<char> fragmentSource = ReadBinaryFile("PixelShader_5_1.cso");
-            m_fragmentShader = m_graphicsAPI->CreateShader({GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT, fragmentSource.data(), fragmentSource.size()});
+            vertexShader = CreateShaderTask(GraphicsAPI::ShaderCreateInfo::Type::VERTEX, []() { return FileView("VertexShader_Instanced_5_1.cso"); });
+            fragmentShader = CreateShaderTask(GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT, []() { return FileView("PixelShader_5_1.cso"); });
         }
         // XR_DOCS_TAG_END_CreateResources2_D3D
+        if (m_apiType == NULL_API) {
+            // GraphicsAPI_Null doesn't compile shaders, so no source is needed.
+            vertexShader = CreateShaderTask(GraphicsAPI::ShaderCreateInfo::Type::VERTEX, []() { return std::vector<char>(); });
+            fragmentShader = CreateShaderTask(GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT, []() { return std::vector<char>(); });
+        }
 
-        // XR_DOCS_TAG_BEGIN_CreateResources3
-        GraphicsAPI::PipelineCreateInfo pipelineCI;
-        pipelineCI.shaders = {m_vertexShader, m_fragmentShader};
-        pipelineCI.vertexInputState.attributes = {{0, 0, GraphicsAPI::VertexType::VEC4, 0, "TEXCOORD"}};
-        pipelineCI.vertexInputState.bindings = {{0, 0, 4 * sizeof(float)}};
-        pipelineCI.inputAssemblyState = {GraphicsAPI::PrimitiveTopology::TRIANGLE_LIST, false};
-        pipelineCI.rasterisationState = {false, false, GraphicsAPI::PolygonMode::FILL, GraphicsAPI::CullMode::BACK, GraphicsAPI::FrontFace::COUNTER_CLOCKWISE, false, 0.0f, 0.0f, 0.0f, 1.0f};
-        pipelineCI.multisampleState = {1, false, 1.0f, 0xFFFFFFFF, false, false};
-        pipelineCI.depthStencilState = {true, true, GraphicsAPI::CompareOp::LESS_OR_EQUAL, false, false, {}, {}, 0.0f, 1.0f};
-        pipelineCI.colorBlendState = {false, GraphicsAPI::LogicOp::NO_OP, {{true, GraphicsAPI::BlendFactor::SRC_ALPHA, GraphicsAPI::BlendFactor::ONE_MINUS_SRC_ALPHA, GraphicsAPI::BlendOp::ADD, GraphicsAPI::BlendFactor::ONE, GraphicsAPI::BlendFactor::ZERO, GraphicsAPI::BlendOp::ADD, (GraphicsAPI::ColorComponentBit)15}}, {0.0f, 0.0f, 0.0f, 0.0f}};
-        pipelineCI.colorFormats = {m_colorSwapchainInfos[0].swapchainFormat};
-        pipelineCI.depthFormat = m_depthSwapchainInfos[0].swapchainFormat;
-        pipelineCI.layout = {{0, nullptr, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::VERTEX},
-                             {1, nullptr, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::VERTEX},
-                             {2, nullptr, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::FRAGMENT}};
-        m_pipeline = m_graphicsAPI->CreatePipeline(pipelineCI);
-        // XR_DOCS_TAG_END_CreateResources3
+        // The pipeline task is submitted after the shader tasks, so a worker has already taken them when it waits for them.
+        m_pipelineCreation = SubmitResourceTask([this, vertexShader, fragmentShader]() {
+            m_vertexShader = vertexShader.get();
+            m_fragmentShader = fragmentShader.get();
+            CreateCuboidPipeline();
+        });
 
         // XR_DOCS_TAG_BEGIN_Setup_Blocks
         // Create sixty-four cubic blocks, 20cm wide, evenly distributed,
@@ -728,13 +835,85 @@ private:
             }
         }
         // XR_DOCS_TAG_END_Setup_Blocks
+        RebuildBlockGrid();
+    }
+
+    // Runs task on m_resourceThreadPool, or straight away if there isn't one.
+    template <typename Task>
+    std::future<decltype(std::declval<Task &>()())> SubmitResourceTask(Task task) {
+        if (m_resourceThreadPool) {
+            return m_resourceThreadPool->Submit(std::move(task));
+        }
+        std::packaged_task<decltype(std::declval<Task &>()())()> packagedTask(std::move(task));
+        auto future = packagedTask.get_future();
+        packagedTask();
+        return future;
     }
+
+    // Reads a shader's source or bytecode with readSource, which returns a container such as a FileView, and creates the
+    // shader from it.
+    template <typename ReadSource>
+    std::shared_future<void *> CreateShaderTask(GraphicsAPI::ShaderCreateInfo::Type type, ReadSource readSource) {
+        auto createShader = [this, type, readSource]() {
+            auto source = readSource();
+            return m_graphicsAPI->CreateShader({type, source.data(), source.size()});
+        };
+        return SubmitResourceTask(createShader).share();
+    }
+
+    // Creates m_pipeline from m_vertexShader and m_fragmentShader.
+    void CreateCuboidPipeline() {
+        // XR_DOCS_TAG_BEGIN_CreateResources3
+        GraphicsAPI::PipelineCreateInfo pipelineCI;
+        pipelineCI.shaders = {m_vertexShader, m_fragmentShader};
+        // Binding 0 holds the cube's vertices. Binding 1 holds a CuboidInstance for each instance: the columns of the model matrix, then the color.
+        pipelineCI.vertexInputState.attributes = {{0, 0, GraphicsAPI::VertexType::VEC4, 0, "TEXCOORD"},
+                                                  {1, 1, GraphicsAPI::VertexType::VEC4, offsetof(CuboidInstance, model) + 0 * sizeof(XrVector4f), "TEXCOORD"},
+                                                  {2, 1, GraphicsAPI::VertexType::VEC4, offsetof(CuboidInstance, model) + 1 * sizeof(XrVector4f), "TEXCOORD"},
+                                                  {3, 1, GraphicsAPI::VertexType::VEC4, offsetof(CuboidInstance, model) + 2 * sizeof(XrVector4f), "TEXCOORD"},
+                                                  {4, 1, GraphicsAPI::VertexType::VEC4, offsetof(CuboidInstance, model) + 3 * sizeof(XrVector4f), "TEXCOORD"},
+                                                  {5, 1, GraphicsAPI::VertexType::VEC4, offsetof(CuboidInstance, color), "TEXCOORD"}};
+        pipelineCI.vertexInputState.bindings = {{0, 0, 4 * sizeof(float)},
+                                                {1, 0, sizeof(CuboidInstance), GraphicsAPI::VertexInputRate::INSTANCE}};
+        pipelineCI.inputAssemblyState = {GraphicsAPI::PrimitiveTopology::TRIANGLE_LIST, false};
+        pipelineCI.rasterisationState = {false, false, GraphicsAPI::PolygonMode::FILL, GraphicsAPI::CullMode::BACK, GraphicsAPI::FrontFace::COUNTER_CLOCKWISE, false, 0.0f, 0.0f, 0.0f, 1.0f};
+        pipelineCI.multisampleState = {1, false, 1.0f, 0xFFFFFFFF, false, false};
+        pipelineCI.depthStencilState = {true, true, GraphicsAPI::CompareOp::LESS_OR_EQUAL, false, false, {}, {}, 0.0f, 1.0f};
+        pipelineCI.colorBlendState = {false, GraphicsAPI::LogicOp::NO_OP, {{true, GraphicsAPI::BlendFactor::SRC_ALPHA, GraphicsAPI::BlendFactor::ONE_MINUS_SRC_ALPHA, GraphicsAPI::BlendOp::ADD, GraphicsAPI::BlendFactor::ONE, GraphicsAPI::BlendFactor::ZERO, GraphicsAPI::BlendOp::ADD, (GraphicsAPI::ColorComponentBit)15}}, {0.0f, 0.0f, 0.0f, 0.0f}};
+        pipelineCI.colorFormats = {m_colorSwapchainInfos[0].swapchainFormat};
+        pipelineCI.depthFormat = m_depthSwapchainInfos[0].swapchainFormat;
+        pipelineCI.layout = {{0, nullptr, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::VERTEX},
+                             {1, nullptr, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::VERTEX},
+                             {2, nullptr, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::FRAGMENT}};
+        pipelineCI.viewMask = m_multiview ? (1u << m_viewConfigurationViews.size()) - 1 : 0;
+        m_pipeline = m_graphicsAPI->CreatePipeline(pipelineCI);
+        // XR_DOCS_TAG_END_CreateResources3
+    }
+
+    // Returns true once the pipeline started by CreateResources() has been created and can be drawn with.
+    bool IsPipelineReady() {
+        if (!m_pipelineReady && m_pipelineCreation.valid() && m_pipelineCreation.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            m_pipelineCreation.get();
+            m_pipelineReady = true;
+            double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_resourceCreationStart).count();
+            XR_TUT_LOG("Shaders and pipeline ready " << milliseconds << " ms after CreateResources() began" << (m_resourceThreadPool ? ", created on the resource threads." : "."));
+            m_resourceThreadPool.reset();
+        }
+        return m_pipelineReady;
+    }
+
     void DestroyResources() {
+        // The application may be closing before the resource threads have finished.
+        if (m_pipelineCreation.valid()) {
+            m_pipelineCreation.wait();
+        }
+        m_resourceThreadPool.reset();
+        m_jobSystem.reset();
+
         // XR_DOCS_TAG_BEGIN_DestroyResources
         m_graphicsAPI->DestroyPipeline(m_pipeline);
         m_graphicsAPI->DestroyShader(m_fragmentShader);
         m_graphicsAPI->DestroyShader(m_vertexShader);
-        m_graphicsAPI->DestroyBuffer(m_uniformBuffer_Camera);
         m_graphicsAPI->DestroyBuffer(m_uniformBuffer_Normals);
         m_graphicsAPI->DestroyBuffer(m_indexBuffer);
         m_graphicsAPI->DestroyBuffer(m_vertexBuffer);
@@ -931,23 +1110,13 @@ private:
     void BlockInteraction() {
         // For each hand:
         for (int i = 0; i < 2; i++) {
-            float nearest = 1.0f;
             // If not currently holding a block:
             if (m_grabbedBlock[i] == -1) {
                 m_nearBlock[i] = -1;
                 // Only if the pose was detected this frame:
                 if (m_handPoseState[i].isActive) {
-                    // For each block:
-                    for (int j = 0; j < m_blocks.size(); j++) {
-                        auto block = m_blocks[j];
-                        // How far is it from the hand to this block?
-                        XrVector3f diff = block.pose.position - m_handPose[i].position;
-                        float distance = std::max(fabs(diff.x), std::max(fabs(diff.y), fabs(diff.z)));
-                        if (distance < 0.1f && distance < nearest) {
-                            m_nearBlock[i] = j;
-                            nearest = distance;
-                        }
-                    }
+                    // Find the nearest block within 10cm of the hand.
+                    m_nearBlock[i] = m_blockGrid.FindNearest(m_handPose[i].position, 0.1f);
                 }
                 if (m_nearBlock[i] != -1) {
                     if (m_grabState[i].isActive && m_grabState[i].currentState > 0.5f) {
@@ -961,10 +1130,15 @@ private:
                 }
             } else {
                 m_nearBlock[i] = m_grabbedBlock[i];
-                if (m_handPoseState[i].isActive)
-                    m_blocks[m_grabbedBlock[i]].pose.position = m_handPose[i].position;
+                auto &grabbedBlock = m_blocks[m_grabbedBlock[i]];
+                // Move the block with the hand, keeping the grid up to date with its position.
+                if (m_handPoseState[i].isActive) {
+                    grabbedBlock.pose.position = m_handPose[i].position;
+                    m_blockGrid.Move(static_cast<uint32_t>(m_grabbedBlock[i]), grabbedBlock.pose.position);
+                }
                 if (!m_grabState[i].isActive || m_grabState[i].currentState < 0.5f) {
-                    m_blocks[m_grabbedBlock[i]].pose.position = FixPosition(m_blocks[m_grabbedBlock[i]].pose.position);
+                    grabbedBlock.pose.position = FixPosition(grabbedBlock.pose.position);
+                    m_blockGrid.Move(static_cast<uint32_t>(m_grabbedBlock[i]), grabbedBlock.pose.position);
                     m_grabbedBlock[i] = -1;
                     m_buzz[i] = 0.2f;
                 }
@@ -972,6 +1146,12 @@ private:
         }
     }
     // XR_DOCS_TAG_END_BlockInteraction
+    void RebuildBlockGrid() {
+        m_blockGrid.Clear();
+        for (size_t j = 0; j < m_blocks.size(); j++) {
+            m_blockGrid.Insert(static_cast<uint32_t>(j), m_blocks[j].pose.position);
+        }
+    }
 
     void CreateReferenceSpace() {
         // XR_DOCS_TAG_BEGIN_CreateReferenceSpace
@@ -1003,14 +1183,27 @@ private:
         }
         // XR_DOCS_TAG_END_EnumerateSwapchainFormats
 
+        // Draw all the views in one pass if the graphics API supports multiview, the views are the same size and there are
+        // multiview shaders for the graphics API. Set XR_TUTORIAL_NO_MULTIVIEW to draw each view in its own pass instead.
+        m_multiview = m_graphicsAPI->SupportsMultiview() && (m_apiType == VULKAN || m_apiType == OPENGL_ES) && m_viewConfigurationViews.size() == 2 && GetEnv("XR_TUTORIAL_NO_MULTIVIEW").empty();
+        for (const XrViewConfigurationView &viewConfigurationView : m_viewConfigurationViews) {
+            if (viewConfigurationView.recommendedImageRectWidth != m_viewConfigurationViews[0].recommendedImageRectWidth || viewConfigurationView.recommendedImageRectHeight != m_viewConfigurationViews[0].recommendedImageRectHeight) {
+                m_multiview = false;
+            }
+        }
+        XR_TUT_LOG((m_multiview ? "Drawing the views in one pass with multiview." : "Drawing each view in its own pass."));
+
         // XR_DOCS_TAG_BEGIN_ResizeSwapchainInfos
         //Resize the SwapchainInfo to match the number of view in the View Configuration.
-        m_colorSwapchainInfos.resize(m_viewConfigurationViews.size());
-        m_depthSwapchainInfos.resize(m_viewConfigurationViews.size());
+        //With multiview, there is one swapchain with a layer per view.
+        const size_t swapchainCount = m_multiview ? 1 : m_viewConfigurationViews.size();
+        const uint32_t swapchainArraySize = m_multiview ? static_cast<uint32_t>(m_viewConfigurationViews.size()) : 1;
+        m_colorSwapchainInfos.resize(swapchainCount);
+        m_depthSwapchainInfos.resize(swapchainCount);
         // XR_DOCS_TAG_END_ResizeSwapchainInfos
 
-        // Per view, create a color and depth swapchain, and their associated image views.
-        for (size_t i = 0; i < m_viewConfigurationViews.size(); i++) {
+        // Per view, or once with multiview, create a color and depth swapchain, and their associated image views.
+        for (size_t i = 0; i < swapchainCount; i++) {
             // XR_DOCS_TAG_BEGIN_CreateSwapchains
             SwapchainInfo &colorSwapchainInfo = m_colorSwapchainInfos[i];
             SwapchainInfo &depthSwapchainInfo = m_depthSwapchainInfos[i];
@@ -1025,7 +1218,7 @@ private:
             swapchainCI.width = m_viewConfigurationViews[i].recommendedImageRectWidth;
             swapchainCI.height = m_viewConfigurationViews[i].recommendedImageRectHeight;
             swapchainCI.faceCount = 1;
-            swapchainCI.arraySize = 1;
+            swapchainCI.arraySize = swapchainArraySize;
             swapchainCI.mipCount = 1;
             OPENXR_CHECK(xrCreateSwapchain(m_session, &swapchainCI, &colorSwapchainInfo.swapchain), "Failed to create Color Swapchain");
             colorSwapchainInfo.swapchainFormat = swapchainCI.format;  // Save the swapchain format for later use.
@@ -1038,7 +1231,7 @@ private:
             swapchainCI.width = m_viewConfigurationViews[i].recommendedImageRectWidth;
             swapchainCI.height = m_viewConfigurationViews[i].recommendedImageRectHeight;
             swapchainCI.faceCount = 1;
-            swapchainCI.arraySize = 1;
+            swapchainCI.arraySize = swapchainArraySize;
             swapchainCI.mipCount = 1;
             OPENXR_CHECK(xrCreateSwapchain(m_session, &swapchainCI, &depthSwapchainInfo.swapchain), "Failed to create Depth Swapchain");
             depthSwapchainInfo.swapchainFormat = swapchainCI.format;  // Save the swapchain format for later use.
@@ -1063,26 +1256,26 @@ private:
                 GraphicsAPI::ImageViewCreateInfo imageViewCI;
                 imageViewCI.image = m_graphicsAPI->GetSwapchainImage(colorSwapchainInfo.swapchain, j);
                 imageViewCI.type = GraphicsAPI::ImageViewCreateInfo::Type::RTV;
-                imageViewCI.view = GraphicsAPI::ImageViewCreateInfo::View::TYPE_2D;
+                imageViewCI.view = m_multiview ? GraphicsAPI::ImageViewCreateInfo::View::TYPE_2D_ARRAY : GraphicsAPI::ImageViewCreateInfo::View::TYPE_2D;
                 imageViewCI.format = colorSwapchainInfo.swapchainFormat;
                 imageViewCI.aspect = GraphicsAPI::ImageViewCreateInfo::Aspect::COLOR_BIT;
                 imageViewCI.baseMipLevel = 0;
                 imageViewCI.levelCount = 1;
                 imageViewCI.baseArrayLayer = 0;
-                imageViewCI.layerCount = 1;
+                imageViewCI.layerCount = swapchainArraySize;
                 colorSwapchainInfo.imageViews.push_back(m_graphicsAPI->CreateImageView(imageViewCI));
             }
             for (uint32_t j = 0; j < depthSwapchainImageCount; j++) {
                 GraphicsAPI::ImageViewCreateInfo imageViewCI;
                 imageViewCI.image = m_graphicsAPI->GetSwapchainImage(depthSwapchainInfo.swapchain, j);
                 imageViewCI.type = GraphicsAPI::ImageViewCreateInfo::Type::DSV;
-                imageViewCI.view = GraphicsAPI::ImageViewCreateInfo::View::TYPE_2D;
+                imageViewCI.view = m_multiview ? GraphicsAPI::ImageViewCreateInfo::View::TYPE_2D_ARRAY : GraphicsAPI::ImageViewCreateInfo::View::TYPE_2D;
                 imageViewCI.format = depthSwapchainInfo.swapchainFormat;
                 imageViewCI.aspect = GraphicsAPI::ImageViewCreateInfo::Aspect::DEPTH_BIT;
                 imageViewCI.baseMipLevel = 0;
                 imageViewCI.levelCount = 1;
                 imageViewCI.baseArrayLayer = 0;
-                imageViewCI.layerCount = 1;
+                imageViewCI.layerCount = swapchainArraySize;
                 depthSwapchainInfo.imageViews.push_back(m_graphicsAPI->CreateImageView(imageViewCI));
             }
             // XR_DOCS_TAG_END_CreateImageViews
@@ -1091,8 +1284,8 @@ private:
 
     void DestroySwapchains() {
         // XR_DOCS_TAG_BEGIN_DestroySwapchains
-        // Per view in the view configuration:
-        for (size_t i = 0; i < m_viewConfigurationViews.size(); i++) {
+        // Per swapchain, which is one per view in the view configuration without multiview:
+        for (size_t i = 0; i < m_colorSwapchainInfos.size(); i++) {
             SwapchainInfo &colorSwapchainInfo = m_colorSwapchainInfos[i];
             SwapchainInfo &depthSwapchainInfo = m_depthSwapchainInfos[i];
 
@@ -1115,44 +1308,279 @@ private:
         // XR_DOCS_TAG_END_DestroySwapchains
     }
 
-    // XR_DOCS_TAG_BEGIN_RenderCuboid1
-    size_t renderCuboidIndex = 0;
-    // XR_DOCS_TAG_END_RenderCuboid1
+    // Adds a cuboid to the scene being captured.
     void RenderCuboid(XrPosef pose, XrVector3f scale, XrVector3f color) {
+        m_capturingScene->cuboids.push_back({pose, scale, color});
+    }
+
+    // Queues a cuboid of the scene snapshot to be drawn into this frame's views.
+    void QueueCuboid(XrPosef pose, XrVector3f scale, XrVector3f color) {
+        // Skip cuboids that are entirely outside the frustum of every view. The bounds tested are a box around the
+        // cuboid's bounding sphere, which needs no model matrix.
+        float radius = 0.5f * XrVector3f_Length(&scale);
+        XrVector3f mins = {pose.position.x - radius, pose.position.y - radius, pose.position.z - radius};
+        XrVector3f maxs = {pose.position.x + radius, pose.position.y + radius, pose.position.z + radius};
+        if (XrMatrix4x4f_CullBounds(&m_cullViewProj, &mins, &maxs)) {
+            m_culledCuboidCount++;
+            return;
+        }
         // XR_DOCS_TAG_BEGIN_RenderCuboid2
-        XrMatrix4x4f_CreateTranslationRotationScale(&cameraConstants.model, &pose.position, &pose.orientation, &scale);
+        // Queue the cuboid. PrepareScene() creates the model matrices of all the queued cuboids in one batch, and
+        // RenderCuboids() draws them with a single instanced draw.
+        m_cuboidTransforms.Add(pose, scale);
+        CuboidInstance cuboidInstance;
+        cuboidInstance.color = {color.x, color.y, color.z, 1.0};
+        m_cuboidInstances.push_back(cuboidInstance);
+        // XR_DOCS_TAG_END_RenderCuboid2
+    }
 
-        XrMatrix4x4f_Multiply(&cameraConstants.modelViewProj, &cameraConstants.viewProj, &cameraConstants.model);
-        cameraConstants.color = {color.x, color.y, color.z, 1.0};
-        size_t offsetCameraUB = sizeof(CameraConstants) * renderCuboidIndex;
+    // Returns the cuboids queued since first, and adds how many were queued and culled to cullingStats.
+    CuboidRange EndCuboidRange(size_t first, CullingStats &cullingStats) {
+        CuboidRange range = {static_cast<uint32_t>(first), static_cast<uint32_t>(m_cuboidInstances.size() - first)};
+        cullingStats.drawn += range.count;
+        cullingStats.culled += m_culledCuboidCount;
+        m_culledCuboidCount = 0;
+        return range;
+    }
+
+    // Draws a range of the cuboids prepared by PrepareScene() into the current view.
+    void RenderCuboids(const CuboidRange &range) {
+        if (range.count == 0) {
+            return;
+        }
 
         m_graphicsAPI->SetPipeline(m_pipeline);
 
-        m_graphicsAPI->SetBufferData(m_uniformBuffer_Camera, offsetCameraUB, sizeof(CameraConstants), &cameraConstants);
-        m_graphicsAPI->SetDescriptor({0, m_uniformBuffer_Camera, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::VERTEX, false, offsetCameraUB, sizeof(CameraConstants)});
+        // Copy the constants into this frame's transient uniform memory and bind that range.
+        GraphicsAPI::TransientAllocation cameraConstantsUB = m_graphicsAPI->AllocateTransientUniformData(sizeof(CameraConstants), &cameraConstants);
+        m_graphicsAPI->SetDescriptor({0, cameraConstantsUB.buffer, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::VERTEX, false, cameraConstantsUB.offset, cameraConstantsUB.size});
         m_graphicsAPI->SetDescriptor({1, m_uniformBuffer_Normals, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::VERTEX, false, 0, sizeof(normals)});
 
         m_graphicsAPI->UpdateDescriptors();
 
-        m_graphicsAPI->SetVertexBuffers(&m_vertexBuffer, 1);
+        // Upload the per-instance data and bind it alongside the cube's vertices. The upload is repeated for each view,
+        // as transient memory is only guaranteed to live as long as the rendering that allocated it.
+        GraphicsAPI::TransientAllocation instanceVB = m_graphicsAPI->AllocateTransientVertexData(sizeof(CuboidInstance) * range.count, &m_cuboidInstances[range.first]);
+        void *vertexBuffers[] = {m_vertexBuffer, instanceVB.buffer};
+        size_t vertexBufferOffsets[] = {0, instanceVB.offset};
+        m_graphicsAPI->SetVertexBuffers(vertexBuffers, 2, vertexBufferOffsets);
         m_graphicsAPI->SetIndexBuffer(m_indexBuffer);
-        m_graphicsAPI->DrawIndexed(36);
+        m_graphicsAPI->DrawIndexed(36, range.count);
+    }
 
-        renderCuboidIndex++;
-        // XR_DOCS_TAG_END_RenderCuboid2
+    // Draws the scene and hand joint cuboids into the current view, recording chunks of the scene as jobs on m_jobSystem.
+    // The chunks are executed in order, followed by the hand joints.
+    void RenderCuboidsInParallel(const GraphicsAPI::Viewport &viewport, const GraphicsAPI::Rect2D &scissor) {
+        // Small chunks cost more to set up than they save.
+        const uint32_t minCuboidsPerChunk = 16;
+        const uint32_t threadCount = m_jobSystem->GetWorkerCount() + 1;
+        const uint32_t chunkCount = std::max(std::min(threadCount, m_sceneCuboids.count / minCuboidsPerChunk), 1u);
+        const uint32_t cuboidsPerChunk = (m_sceneCuboids.count + chunkCount - 1) / chunkCount;
+
+        // Viewports, scissors and the pipeline aren't inherited by the parallel command lists.
+        auto RecordChunk = [this, viewport, scissor](uint32_t index, CuboidRange range) {
+            GraphicsAPI::Viewport chunkViewport = viewport;
+            GraphicsAPI::Rect2D chunkScissor = scissor;
+            m_graphicsAPI->BeginParallelCommands(index);
+            m_graphicsAPI->SetViewports(&chunkViewport, 1);
+            m_graphicsAPI->SetScissors(&chunkScissor, 1);
+            RenderCuboids(range);
+            m_graphicsAPI->EndParallelCommands();
+        };
+        m_jobSystem->ParallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t chunk = begin; chunk < end; chunk++) {
+                uint32_t first = std::min(chunk * cuboidsPerChunk, m_sceneCuboids.count);
+                RecordChunk(chunk, {m_sceneCuboids.first + first, std::min(cuboidsPerChunk, m_sceneCuboids.count - first)});
+            }
+        });
+        RecordChunk(chunkCount, m_handJointCuboids);
+
+        // Timestamps can't be written between the command lists, so the hand joints are timed along with the scene.
+        m_graphicsAPI->BeginTimestampScope("Cuboids");
+        m_graphicsAPI->ExecuteParallelCommands();
+        m_graphicsAPI->EndTimestampScope();
+    }
+
+    void AccumulateGpuTimings() {
+        // Results arrive in the order their scopes began, so a scope's parents always precede it.
+        std::vector<std::string> path;
+        for (const GraphicsAPI::TimestampResult &result : m_graphicsAPI->GetTimestampResults()) {
+            path.resize(result.depth);
+            path.push_back(result.name);
+            std::string key;
+            for (const std::string &name : path) {
+                key += (key.empty() ? "" : "/") + name;
+            }
+            GpuTiming &gpuTiming = m_gpuTimings[key];
+            gpuTiming.totalMilliseconds += result.milliseconds;
+            gpuTiming.count++;
+        }
+    }
+
+    void LogGpuTimings() {
+        if (m_gpuTimings.empty()) {
+            return;
+        }
+        std::ostringstream stream;
+        stream << std::fixed << std::setprecision(3) << "GPU timings (ms, mean):";
+        for (const auto &gpuTiming : m_gpuTimings) {
+            stream << "\n    " << gpuTiming.first << ": " << gpuTiming.second.totalMilliseconds / static_cast<double>(gpuTiming.second.count);
+        }
+        XR_TUT_LOG(stream.str());
+    }
+
+    void AccumulateStateStatistics() {
+        GraphicsAPI::StateStatistics statistics = m_graphicsAPI->GetStateStatistics();
+        m_stateStatistics.issued += statistics.issued;
+        m_stateStatistics.elided += statistics.elided;
+        m_stateStatisticsFrameCount++;
+    }
+
+    void LogStateStatistics() {
+        uint64_t total = m_stateStatistics.issued + m_stateStatistics.elided;
+        if (total == 0) {
+            return;
+        }
+        std::ostringstream stream;
+        stream << std::fixed << std::setprecision(1) << "Pipeline state calls over " << m_stateStatisticsFrameCount << " frames: " << m_stateStatistics.issued << " issued, "
+               << m_stateStatistics.elided << " elided (" << 100.0 * static_cast<double>(m_stateStatistics.elided) / static_cast<double>(total) << "%), "
+               << static_cast<double>(m_stateStatistics.issued) / static_cast<double>(m_stateStatisticsFrameCount) << " issued per frame.";
+        XR_TUT_LOG(stream.str());
+    }
+
+    void LogJobStatistics() {
+        if (!m_jobSystem) {
+            return;
+        }
+        JobSystem::Statistics statistics = m_jobSystem->GetStatistics();
+        std::ostringstream stream;
+        stream << std::fixed << std::setprecision(1) << "Job system utilisation over " << statistics.elapsedMilliseconds / 1000.0 << " s:";
+        for (size_t i = 0; i < statistics.workers.size(); i++) {
+            const JobSystem::WorkerStatistics &worker = statistics.workers[i];
+            stream << "\n    " << (i == 0 ? std::string("Frame loop") : "Worker " + std::to_string(i)) << ": " << 100.0 * worker.utilisation << "%, "
+                   << worker.jobCount << " jobs (" << worker.stolenJobCount << " stolen)";
+        }
+        XR_TUT_LOG(stream.str());
+    }
+
+    void LogCullingStats() {
+        std::ostringstream stream;
+        stream << "Frustum culling (against all views combined):";
+        auto Line = [&](const char *name, const CullingStats &cullingStats) {
+            uint64_t total = cullingStats.drawn + cullingStats.culled;
+            stream << "\n    " << name << ": " << cullingStats.drawn << " drawn, " << cullingStats.culled << " culled";
+            if (total > 0) {
+                stream << " (" << std::fixed << std::setprecision(1) << 100.0 * static_cast<double>(cullingStats.culled) / static_cast<double>(total) << "%)";
+            }
+        };
+        Line("Cuboids", m_cuboidCullingStats);
+        Line("HandJoints", m_handJointCullingStats);
+        XR_TUT_LOG(stream.str());
+    }
+
+    // Set XR_TUTORIAL_PIPELINED_FRAMES to poll the actions and update the blocks for each frame on a simulation thread,
+    // while the rendering thread draws the frame before it. The CPU time of a frame is then the longer of the two stages
+    // rather than their sum, at the cost of the scene being simulated one frame ahead, for a predicted display time.
+    void StartSimulationThread() {
+        m_pipelinedFrames = !GetEnv("XR_TUTORIAL_PIPELINED_FRAMES").empty();
+        if (m_pipelinedFrames) {
+            m_simulationThread = std::thread(&OpenXRTutorial::SimulationThreadMain, this);
+            XR_TUT_LOG("Pipelined frames: the scene is simulated on its own thread, one frame ahead of rendering.");
+        }
+    }
+
+    void StopSimulationThread() {
+        if (!m_simulationThread.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_simulationMutex);
+            m_stopSimulation = true;
+        }
+        m_simulationCondition.notify_all();
+        m_simulationThread.join();
+    }
+
+    void RequestSimulationStep(XrTime predictedDisplayTime) {
+        {
+            std::lock_guard<std::mutex> lock(m_simulationMutex);
+            m_simulationTime = predictedDisplayTime;
+            m_simulationStepPending = true;
+        }
+        m_simulationCondition.notify_all();
+    }
+
+    void WaitForSimulationStep() {
+        if (!m_pipelinedFrames) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(m_simulationMutex);
+        m_simulationCondition.wait(lock, [this]() { return !m_simulationStepPending; });
+    }
+
+    void SimulationThreadMain() {
+        while (true) {
+            XrTime predictedDisplayTime = 0;
+            {
+                std::unique_lock<std::mutex> lock(m_simulationMutex);
+                m_simulationCondition.wait(lock, [this]() { return m_stopSimulation || m_simulationStepPending; });
+                if (m_stopSimulation) {
+                    return;
+                }
+                predictedDisplayTime = m_simulationTime;
+            }
+
+            // FrameTimings is only written by the rendering thread, so the stages are timed here and added to the timings
+            // of the frame that draws the snapshot.
+            SceneSnapshot &scene = m_sceneSnapshots.GetWriteBuffer();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            PollActions(predictedDisplayTime);
+            std::chrono::steady_clock::time_point actionsPolled = std::chrono::steady_clock::now();
+            BlockInteraction();
+            std::chrono::steady_clock::time_point blocksUpdated = std::chrono::steady_clock::now();
+            CaptureScene(scene, predictedDisplayTime);
+            scene.pollActionsDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(actionsPolled - start).count();
+            scene.blockInteractionDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(blocksUpdated - actionsPolled).count();
+            m_sceneSnapshots.Publish();
+
+            {
+                std::lock_guard<std::mutex> lock(m_simulationMutex);
+                m_simulationStepPending = false;
+            }
+            m_simulationCondition.notify_all();
+        }
+    }
+
+    // Takes the latest scene snapshot, which stays valid until the next call. With pipelined frames, the time spent
+    // simulating it is added to this frame's timings. The first pipelined frame has nothing simulated yet, so it draws an
+    // empty scene.
+    const SceneSnapshot &ReadSceneSnapshot() {
+        bool newSnapshot = m_sceneSnapshots.HasNewValue();
+        const SceneSnapshot &scene = m_sceneSnapshots.Read();
+        if (m_pipelinedFrames && newSnapshot) {
+            m_frameTimings.AddStageDuration(FrameTimings::POLL_ACTIONS, scene.pollActionsDuration);
+            m_frameTimings.AddStageDuration(FrameTimings::BLOCK_INTERACTION, scene.blockInteractionDuration);
+        }
+        return scene;
     }
 
     void RenderFrame() {
 #if XR_DOCS_CHAPTER_VERSION >= XR_DOCS_CHAPTER_3_2
         // XR_DOCS_TAG_BEGIN_RenderFrame
+        m_frameTimings.BeginFrame();
+
         // Get the XrFrameState for timing and rendering info.
         XrFrameState frameState{XR_TYPE_FRAME_STATE};
         XrFrameWaitInfo frameWaitInfo{XR_TYPE_FRAME_WAIT_INFO};
+        FrameTimings::StageTimer waitFrameTimer(m_frameTimings, FrameTimings::WAIT_FRAME);
         OPENXR_CHECK(xrWaitFrame(m_session, &frameWaitInfo, &frameState), "Failed to wait for XR Frame.");
+        waitFrameTimer.End();
 
         // Tell the OpenXR compositor that the application is beginning the frame.
         XrFrameBeginInfo frameBeginInfo{XR_TYPE_FRAME_BEGIN_INFO};
+        FrameTimings::StageTimer beginFrameTimer(m_frameTimings, FrameTimings::BEGIN_FRAME);
         OPENXR_CHECK(xrBeginFrame(m_session, &frameBeginInfo), "Failed to begin the XR Frame.");
+        beginFrameTimer.End();
 
         // Variables for rendering and layer composition.
         bool rendered = false;
@@ -1162,16 +1590,33 @@ private:
         // Check that the session is active and that we should render.
         bool sessionActive = (m_sessionState == XR_SESSION_STATE_SYNCHRONIZED || m_sessionState == XR_SESSION_STATE_VISIBLE || m_sessionState == XR_SESSION_STATE_FOCUSED);
         if (sessionActive && frameState.shouldRender) {
+            const SceneSnapshot *scene = nullptr;
+            if (m_pipelinedFrames) {
+                // Take the snapshot simulated during the last frame before starting the next step, so that this frame
+                // draws it, however far the simulation thread gets. The next frame is then simulated while this one is
+                // drawn. xrWaitFrame() can't be called for it until this frame has ended, so its display time is
+                // extrapolated from this frame's by one display period.
+                scene = &ReadSceneSnapshot();
+                RequestSimulationStep(frameState.predictedDisplayTime + frameState.predictedDisplayPeriod);
+            } else {
 #if XR_DOCS_CHAPTER_VERSION >= XR_DOCS_CHAPTER_4_2
-            // XR_DOCS_TAG_BEGIN_CallPollActions
-            // poll actions here because they require a predicted display time, which we've only just obtained.
-            PollActions(frameState.predictedDisplayTime);
-            // Handle the interaction between the user and the 3D blocks.
-            BlockInteraction();
-            // XR_DOCS_TAG_END_CallPollActions
+                // XR_DOCS_TAG_BEGIN_CallPollActions
+                // poll actions here because they require a predicted display time, which we've only just obtained.
+                FrameTimings::StageTimer pollActionsTimer(m_frameTimings, FrameTimings::POLL_ACTIONS);
+                PollActions(frameState.predictedDisplayTime);
+                pollActionsTimer.End();
+                // Handle the interaction between the user and the 3D blocks.
+                FrameTimings::StageTimer blockInteractionTimer(m_frameTimings, FrameTimings::BLOCK_INTERACTION);
+                BlockInteraction();
+                blockInteractionTimer.End();
+                // XR_DOCS_TAG_END_CallPollActions
 #endif
+                CaptureScene(m_sceneSnapshots.GetWriteBuffer(), frameState.predictedDisplayTime);
+                m_sceneSnapshots.Publish();
+                scene = &ReadSceneSnapshot();
+            }
             // Render the stereo image and associate one of swapchain images with the XrCompositionLayerProjection structure.
-            rendered = RenderLayer(renderLayerInfo);
+            rendered = RenderLayer(renderLayerInfo, *scene);
             if (rendered) {
                 renderLayerInfo.layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader *>(&renderLayerInfo.layerProjection));
             }
@@ -1183,12 +1628,102 @@ private:
         frameEndInfo.environmentBlendMode = m_environmentBlendMode;
         frameEndInfo.layerCount = static_cast<uint32_t>(renderLayerInfo.layers.size());
         frameEndInfo.layers = renderLayerInfo.layers.data();
+        FrameTimings::StageTimer endFrameTimer(m_frameTimings, FrameTimings::END_FRAME);
         OPENXR_CHECK(xrEndFrame(m_session, &frameEndInfo), "Failed to end the XR Frame.");
+        endFrameTimer.End();
+
+        // The next PollEvents() may end the session, so the simulation step mustn't run past the end of the frame.
+        WaitForSimulationStep();
+
+        m_frameTimings.EndFrame(frameState);
+        AccumulateGpuTimings();
+        AccumulateStateStatistics();
         // XR_DOCS_TAG_END_RenderFrame
 #endif
     }
 
-    bool RenderLayer(RenderLayerInfo &renderLayerInfo) {
+    // Captures the cuboids to draw from the current state of the blocks, controllers and hands.
+    void CaptureScene(SceneSnapshot &scene, XrTime predictedDisplayTime) {
+        scene.predictedDisplayTime = predictedDisplayTime;
+        scene.cuboids.clear();
+        m_capturingScene = &scene;
+
+        // XR_DOCS_TAG_BEGIN_CallRenderCuboid
+        // Draw a floor. Scale it by 2 in the X and Z, and 0.1 in the Y,
+        RenderCuboid({{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, -m_viewHeightM, 0.0f}}, {2.0f, 0.1f, 2.0f}, {0.4f, 0.5f, 0.5f});
+        // Draw a "table".
+        RenderCuboid({{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, -m_viewHeightM + 0.9f, -0.7f}}, {1.0f, 0.2f, 1.0f}, {0.6f, 0.6f, 0.4f});
+        // XR_DOCS_TAG_END_CallRenderCuboid
+
+        // XR_DOCS_TAG_BEGIN_CallRenderCuboid2
+        // Draw some blocks at the controller positions:
+        for (int j = 0; j < 2; j++) {
+            if (m_handPoseState[j].isActive) {
+                RenderCuboid(m_handPose[j], {0.02f, 0.04f, 0.10f}, {1.f, 1.f, 1.f});
+            }
+        }
+        for (int j = 0; j < m_blocks.size(); j++) {
+            auto &thisBlock = m_blocks[j];
+            XrVector3f sc = thisBlock.scale;
+            if (j == m_nearBlock[0] || j == m_nearBlock[1])
+                sc = thisBlock.scale * 1.05f;
+            RenderCuboid(thisBlock.pose, sc, thisBlock.color);
+        }
+        // XR_DOCS_TAG_END_CallRenderCuboid2
+
+        // The hand joints are drawn separately, so their GPU time can be told apart from the rest of the scene.
+        scene.handJointCuboidsFirst = scene.cuboids.size();
+        // XR_DOCS_TAG_BEGIN_RenderHands
+        if (handTrackingSystemProperties.supportsHandTracking) {
+            for (int j = 0; j < 2; j++) {
+                const auto &hand = m_hands[j];
+                XrVector3f hand_color = {1.f, 1.f, 0.f};
+                for (int k = 0; k < XR_HAND_JOINT_COUNT_EXT; k++) {
+                    XrVector3f sc = {1.5f, 1.5f, 2.5f};
+                    sc = sc * hand.m_jointLocations[k].radius;
+                    RenderCuboid(hand.m_jointLocations[k].pose, sc, hand_color);
+                }
+            }
+        }
+        // XR_DOCS_TAG_END_RenderHands
+        m_capturingScene = nullptr;
+    }
+
+    // Builds the list of cuboids to draw this frame from a scene snapshot, once for all the views. The cuboids are culled
+    // against a frustum that contains every view, and their model matrices are created in one batch, so that each view only
+    // has to draw the list.
+    void PrepareScene(const SceneSnapshot &scene, const XrView *views, uint32_t viewCount, float nearZ, float farZ) {
+        m_cuboidInstances.clear();
+        m_cuboidTransforms.Clear();
+        m_culledCuboidCount = 0;
+        m_sceneCuboids = {};
+        m_handJointCuboids = {};
+        if (viewCount == 0) {
+            return;
+        }
+        XrMatrix4x4f_CreateCombinedViewProjection(&m_cullViewProj, m_apiType, views, viewCount, nearZ, farZ);
+
+        auto QueueCuboids = [&](size_t begin, size_t end, CullingStats &cullingStats) {
+            size_t first = m_cuboidInstances.size();
+            for (size_t i = begin; i < end; i++) {
+                const SceneCuboid &cuboid = scene.cuboids[i];
+                QueueCuboid(cuboid.pose, cuboid.scale, cuboid.color);
+            }
+            return EndCuboidRange(first, cullingStats);
+        };
+        m_sceneCuboids = QueueCuboids(0, scene.handJointCuboidsFirst, m_cuboidCullingStats);
+        m_handJointCuboids = QueueCuboids(scene.handJointCuboidsFirst, scene.cuboids.size(), m_handJointCullingStats);
+
+        // Create the model matrices of all the visible cuboids straight into the per-instance data. Large scenes are split
+        // into ranges across m_jobSystem.
+        const uint32_t cuboidsPerJob = 256;
+        m_jobSystem->ParallelFor(static_cast<uint32_t>(m_cuboidInstances.size()), cuboidsPerJob, [this](uint32_t begin, uint32_t end) {
+            XrTransformsSoA transforms = m_cuboidTransforms.Get(begin);
+            XrMatrix4x4f_CreateTranslationRotationScaleBatch(&m_cuboidInstances[begin].model, sizeof(CuboidInstance), &transforms, end - begin);
+        });
+    }
+
+    bool RenderLayer(RenderLayerInfo &renderLayerInfo, const SceneSnapshot &scene) {
         // XR_DOCS_TAG_BEGIN_RenderLayer1
         // Locate the views from the view configuration within the (reference) space at the display time.
         std::vector<XrView> views(m_viewConfigurationViews.size(), {XR_TYPE_VIEW});
@@ -1199,7 +1734,9 @@ private:
         viewLocateInfo.displayTime = renderLayerInfo.predictedDisplayTime;
         viewLocateInfo.space = m_localSpace;
         uint32_t viewCount = 0;
+        FrameTimings::StageTimer locateViewsTimer(m_frameTimings, FrameTimings::LOCATE_VIEWS);
         XrResult result = xrLocateViews(m_session, &viewLocateInfo, &viewState, static_cast<uint32_t>(views.size()), &viewCount, views.data());
+        locateViewsTimer.End();
         if (result != XR_SUCCESS) {
             XR_TUT_LOG("Failed to locate Views.");
             return false;
@@ -1213,10 +1750,23 @@ private:
         // XR_DOCS_TAG_END_ResizeLeyerDepthInfos
 #endif
 
-        // Per view in the view configuration:
-        for (uint32_t i = 0; i < viewCount; i++) {
-            SwapchainInfo &colorSwapchainInfo = m_colorSwapchainInfos[i];
-            SwapchainInfo &depthSwapchainInfo = m_depthSwapchainInfos[i];
+        float nearZ = 0.05f;
+        float farZ = 100.0f;
+
+        // Cull the scene and create its model matrices once, for all the views.
+        FrameTimings::StageTimer prepareSceneTimer(m_frameTimings, FrameTimings::PREPARE_SCENE);
+        PrepareScene(scene, views.data(), viewCount, nearZ, farZ);
+        prepareSceneTimer.End();
+
+        // Until the pipeline has been created, the views are only cleared.
+        const bool pipelineReady = IsPipelineReady();
+
+        // Per view in the view configuration, or once for all the views with multiview, draw a pass into the swapchains.
+        const uint32_t viewsPerPass = m_multiview ? viewCount : 1;
+        for (uint32_t pass = 0; pass * viewsPerPass < viewCount; pass++) {
+            SwapchainInfo &colorSwapchainInfo = m_colorSwapchainInfos[pass];
+            SwapchainInfo &depthSwapchainInfo = m_depthSwapchainInfos[pass];
+            const uint32_t firstView = pass * viewsPerPass;
 
             // Acquire and wait for an image from the swapchains.
             // Get the image index of an image in the swapchains.
@@ -1224,52 +1774,63 @@ private:
             uint32_t colorImageIndex = 0;
             uint32_t depthImageIndex = 0;
             XrSwapchainImageAcquireInfo acquireInfo{XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO};
+            FrameTimings::StageTimer acquireTimer(m_frameTimings, FrameTimings::SWAPCHAIN_ACQUIRE);
             OPENXR_CHECK(xrAcquireSwapchainImage(colorSwapchainInfo.swapchain, &acquireInfo, &colorImageIndex), "Failed to acquire Image from the Color Swapchian");
             OPENXR_CHECK(xrAcquireSwapchainImage(depthSwapchainInfo.swapchain, &acquireInfo, &depthImageIndex), "Failed to acquire Image from the Depth Swapchian");
+            acquireTimer.End();
 
             XrSwapchainImageWaitInfo waitInfo = {XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
             waitInfo.timeout = XR_INFINITE_DURATION;
+            FrameTimings::StageTimer waitTimer(m_frameTimings, FrameTimings::SWAPCHAIN_WAIT);
             OPENXR_CHECK(xrWaitSwapchainImage(colorSwapchainInfo.swapchain, &waitInfo), "Failed to wait for Image from the Color Swapchain");
             OPENXR_CHECK(xrWaitSwapchainImage(depthSwapchainInfo.swapchain, &waitInfo), "Failed to wait for Image from the Depth Swapchain");
+            waitTimer.End();
+
+            // Everything from here until the images are released is timed as rendering the view.
+            FrameTimings::StageTimer renderViewTimer(m_frameTimings, FrameTimings::RENDER_VIEW);
 
-            // Get the width and height and construct the viewport and scissors.
-            const uint32_t &width = m_viewConfigurationViews[i].recommendedImageRectWidth;
-            const uint32_t &height = m_viewConfigurationViews[i].recommendedImageRectHeight;
+            // Get the width and height and construct the viewport and scissors. With multiview, all the views are the same size.
+            const uint32_t &width = m_viewConfigurationViews[firstView].recommendedImageRectWidth;
+            const uint32_t &height = m_viewConfigurationViews[firstView].recommendedImageRectHeight;
             GraphicsAPI::Viewport viewport = {0.0f, 0.0f, (float)width, (float)height, 0.0f, 1.0f};
             GraphicsAPI::Rect2D scissor = {{(int32_t)0, (int32_t)0}, {width, height}};
-            float nearZ = 0.05f;
-            float farZ = 100.0f;
-
-            // Fill out the XrCompositionLayerProjectionView structure specifying the pose and fov from the view.
-            // This also associates the swapchain image with this layer projection view.
-            renderLayerInfo.layerProjectionViews[i] = {XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW};
-            renderLayerInfo.layerProjectionViews[i].pose = views[i].pose;
-            renderLayerInfo.layerProjectionViews[i].fov = views[i].fov;
-            renderLayerInfo.layerProjectionViews[i].subImage.swapchain = colorSwapchainInfo.swapchain;
-            renderLayerInfo.layerProjectionViews[i].subImage.imageRect.offset.x = 0;
-            renderLayerInfo.layerProjectionViews[i].subImage.imageRect.offset.y = 0;
-            renderLayerInfo.layerProjectionViews[i].subImage.imageRect.extent.width = static_cast<int32_t>(width);
-            renderLayerInfo.layerProjectionViews[i].subImage.imageRect.extent.height = static_cast<int32_t>(height);
-            renderLayerInfo.layerProjectionViews[i].subImage.imageArrayIndex = 0;  // Useful for multiview rendering.
+
+            for (uint32_t i = firstView; i < firstView + viewsPerPass; i++) {
+                // Fill out the XrCompositionLayerProjectionView structure specifying the pose and fov from the view.
+                // This also associates the swapchain image with this layer projection view. With multiview, each view
+                // is in the layer of the swapchain image with the same index.
+                renderLayerInfo.layerProjectionViews[i] = {XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW};
+                renderLayerInfo.layerProjectionViews[i].pose = views[i].pose;
+                renderLayerInfo.layerProjectionViews[i].fov = views[i].fov;
+                renderLayerInfo.layerProjectionViews[i].subImage.swapchain = colorSwapchainInfo.swapchain;
+                renderLayerInfo.layerProjectionViews[i].subImage.imageRect.offset.x = 0;
+                renderLayerInfo.layerProjectionViews[i].subImage.imageRect.offset.y = 0;
+                renderLayerInfo.layerProjectionViews[i].subImage.imageRect.extent.width = static_cast<int32_t>(width);
+                renderLayerInfo.layerProjectionViews[i].subImage.imageRect.extent.height = static_cast<int32_t>(height);
+                renderLayerInfo.layerProjectionViews[i].subImage.imageArrayIndex = m_multiview ? i : 0;
 #if XR_DOCS_CHAPTER_VERSION == XR_DOCS_CHAPTER_5_2
-            // XR_DOCS_TAG_BEGIN_SetupLeyerDepthInfos
-            renderLayerInfo.layerProjectionViews[i].next = &renderLayerInfo.layerDepthInfos[i];
-
-            renderLayerInfo.layerDepthInfos[i] = {XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR};
-            renderLayerInfo.layerDepthInfos[i].subImage.swapchain = depthSwapchainInfo.swapchain;
-            renderLayerInfo.layerDepthInfos[i].subImage.imageRect.offset.x = 0;
-            renderLayerInfo.layerDepthInfos[i].subImage.imageRect.offset.y = 0;
-            renderLayerInfo.layerDepthInfos[i].subImage.imageRect.extent.width = static_cast<int32_t>(width);
-            renderLayerInfo.layerDepthInfos[i].subImage.imageRect.extent.height = static_cast<int32_t>(height);
-            renderLayerInfo.layerDepthInfos[i].minDepth = viewport.minDepth;
-            renderLayerInfo.layerDepthInfos[i].maxDepth = viewport.maxDepth;
-            renderLayerInfo.layerDepthInfos[i].nearZ = nearZ;
-            renderLayerInfo.layerDepthInfos[i].farZ = farZ;
-            // XR_DOCS_TAG_END_SetupLeyerDepthInfos
+                // XR_DOCS_TAG_BEGIN_SetupLeyerDepthInfos
+                renderLayerInfo.layerProjectionViews[i].next = &renderLayerInfo.layerDepthInfos[i];
+
+                renderLayerInfo.layerDepthInfos[i] = {XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR};
+                renderLayerInfo.layerDepthInfos[i].subImage.swapchain = depthSwapchainInfo.swapchain;
+                renderLayerInfo.layerDepthInfos[i].subImage.imageRect.offset.x = 0;
+                renderLayerInfo.layerDepthInfos[i].subImage.imageRect.offset.y = 0;
+                renderLayerInfo.layerDepthInfos[i].subImage.imageRect.extent.width = static_cast<int32_t>(width);
+                renderLayerInfo.layerDepthInfos[i].subImage.imageRect.extent.height = static_cast<int32_t>(height);
+                renderLayerInfo.layerDepthInfos[i].minDepth = viewport.minDepth;
+                renderLayerInfo.layerDepthInfos[i].maxDepth = viewport.maxDepth;
+                renderLayerInfo.layerDepthInfos[i].nearZ = nearZ;
+                renderLayerInfo.layerDepthInfos[i].farZ = farZ;
+                // XR_DOCS_TAG_END_SetupLeyerDepthInfos
+                renderLayerInfo.layerDepthInfos[i].subImage.imageArrayIndex = m_multiview ? i : 0;
 #endif
+            }
 
             // Rendering code to clear the color and depth image views.
             m_graphicsAPI->BeginRendering();
+            m_graphicsAPI->BeginTimestampScope(m_multiview ? std::string("Views") : "View " + std::to_string(firstView));
+            m_graphicsAPI->BeginTimestampScope("Clear");
 
             if (m_environmentBlendMode == XR_ENVIRONMENT_BLEND_MODE_OPAQUE) {
                 // VR mode use a background color.
@@ -1279,70 +1840,55 @@ private:
                 m_graphicsAPI->ClearColor(colorSwapchainInfo.imageViews[colorImageIndex], 0.00f, 0.00f, 0.00f, 1.00f);
             }
             m_graphicsAPI->ClearDepth(depthSwapchainInfo.imageViews[depthImageIndex], 1.0f);
+            m_graphicsAPI->EndTimestampScope();
             // XR_DOCS_TAG_END_RenderLayer1
 
-            // XR_DOCS_TAG_BEGIN_SetupFrameRendering
-            m_graphicsAPI->SetRenderAttachments(&colorSwapchainInfo.imageViews[colorImageIndex], 1, depthSwapchainInfo.imageViews[depthImageIndex], width, height, m_pipeline);
-            m_graphicsAPI->SetViewports(&viewport, 1);
-            m_graphicsAPI->SetScissors(&scissor, 1);
-
-            // Compute the view-projection transform.
-            // All matrices (including OpenXR's) are column-major, right-handed.
-            XrMatrix4x4f proj;
-            XrMatrix4x4f_CreateProjectionFov(&proj, m_apiType, views[i].fov, nearZ, farZ);
-            XrMatrix4x4f toView;
-            XrVector3f scale1m{1.0f, 1.0f, 1.0f};
-            XrMatrix4x4f_CreateTranslationRotationScale(&toView, &views[i].pose.position, &views[i].pose.orientation, &scale1m);
-            XrMatrix4x4f view;
-            XrMatrix4x4f_InvertRigidBody(&view, &toView);
-            XrMatrix4x4f_Multiply(&cameraConstants.viewProj, &proj, &view);
-            // XR_DOCS_TAG_END_SetupFrameRendering
-
-            // XR_DOCS_TAG_BEGIN_CallRenderCuboid
-            renderCuboidIndex = 0;
-            // Draw a floor. Scale it by 2 in the X and Z, and 0.1 in the Y,
-            RenderCuboid({{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, -m_viewHeightM, 0.0f}}, {2.0f, 0.1f, 2.0f}, {0.4f, 0.5f, 0.5f});
-            // Draw a "table".
-            RenderCuboid({{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, -m_viewHeightM + 0.9f, -0.7f}}, {1.0f, 0.2f, 1.0f}, {0.6f, 0.6f, 0.4f});
-            // XR_DOCS_TAG_END_CallRenderCuboid
-
-            // XR_DOCS_TAG_BEGIN_CallRenderCuboid2
-            // Draw some blocks at the controller positions:
-            for (int j = 0; j < 2; j++) {
-                if (m_handPoseState[j].isActive) {
-                    RenderCuboid(m_handPose[j], {0.02f, 0.04f, 0.10f}, {1.f, 1.f, 1.f});
+            if (pipelineReady) {
+                // XR_DOCS_TAG_BEGIN_SetupFrameRendering
+                m_graphicsAPI->SetRenderAttachments(&colorSwapchainInfo.imageViews[colorImageIndex], 1, depthSwapchainInfo.imageViews[depthImageIndex], width, height, m_pipeline);
+                m_graphicsAPI->SetViewports(&viewport, 1);
+                m_graphicsAPI->SetScissors(&scissor, 1);
+
+                // Compute the view-projection transform of each view in the pass.
+                // All matrices (including OpenXR's) are column-major, right-handed.
+                for (uint32_t i = firstView; i < firstView + viewsPerPass; i++) {
+                    XrMatrix4x4f proj;
+                    XrMatrix4x4f_CreateProjectionFov(&proj, m_apiType, views[i].fov, nearZ, farZ);
+                    XrMatrix4x4f toView;
+                    XrVector3f scale1m{1.0f, 1.0f, 1.0f};
+                    XrMatrix4x4f_CreateTranslationRotationScale(&toView, &views[i].pose.position, &views[i].pose.orientation, &scale1m);
+                    XrMatrix4x4f view;
+                    XrMatrix4x4f_InvertRigidBody(&view, &toView);
+                    XrMatrix4x4f_Multiply(&cameraConstants.viewProj[i - firstView], &proj, &view);
                 }
-            }
-            for (int j = 0; j < m_blocks.size(); j++) {
-                auto &thisBlock = m_blocks[j];
-                XrVector3f sc = thisBlock.scale;
-                if (j == m_nearBlock[0] || j == m_nearBlock[1])
-                    sc = thisBlock.scale * 1.05f;
-                RenderCuboid(thisBlock.pose, sc, thisBlock.color);
-            }
-            // XR_DOCS_TAG_END_CallRenderCuboid2
-
-            // XR_DOCS_TAG_BEGIN_RenderHands
-            if (handTrackingSystemProperties.supportsHandTracking) {
-                for (int j = 0; j < 2; j++) {
-                    auto hand = m_hands[j];
-                    XrVector3f hand_color = {1.f, 1.f, 0.f};
-                    for (int k = 0; k < XR_HAND_JOINT_COUNT_EXT; k++) {
-                        XrVector3f sc = {1.5f, 1.5f, 2.5f};
-                        sc = sc * hand.m_jointLocations[k].radius;
-                        RenderCuboid(hand.m_jointLocations[k].pose, sc, hand_color);
-                    }
+                // XR_DOCS_TAG_END_SetupFrameRendering
+
+                if (m_parallelRecording) {
+                    RenderCuboidsInParallel(viewport, scissor);
+                } else {
+                    m_graphicsAPI->BeginTimestampScope("Cuboids");
+                    RenderCuboids(m_sceneCuboids);
+                    m_graphicsAPI->EndTimestampScope();
+
+                    // The hand joints are drawn separately, so their GPU time can be told apart from the rest of the scene.
+                    m_graphicsAPI->BeginTimestampScope("HandJoints");
+                    RenderCuboids(m_handJointCuboids);
+                    m_graphicsAPI->EndTimestampScope();
                 }
             }
-            // XR_DOCS_TAG_END_RenderHands
+
+            m_graphicsAPI->EndTimestampScope();
 
             // XR_DOCS_TAG_BEGIN_RenderLayer2
             m_graphicsAPI->EndRendering();
+            renderViewTimer.End();
 
             // Give the swapchain image back to OpenXR, allowing the compositor to use the image.
             XrSwapchainImageReleaseInfo releaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
+            FrameTimings::StageTimer releaseTimer(m_frameTimings, FrameTimings::SWAPCHAIN_RELEASE);
             OPENXR_CHECK(xrReleaseSwapchainImage(colorSwapchainInfo.swapchain, &releaseInfo), "Failed to release Image back to the Color Swapchain");
             OPENXR_CHECK(xrReleaseSwapchainImage(depthSwapchainInfo.swapchain, &releaseInfo), "Failed to release Image back to the Depth Swapchain");
+            releaseTimer.End();
         }
 
         // Fill out the XrCompositionLayerProjection structure for usage with xrEndFrame().
@@ -1457,6 +2003,17 @@ private:
     bool m_applicationRunning = true;
     bool m_sessionRunning = false;
 
+    FrameTimings m_frameTimings;
+    // GPU time per timestamp scope, keyed by the scope's path, e.g. "View 0/Cuboids".
+    struct GpuTiming {
+        double totalMilliseconds = 0.0;
+        uint64_t count = 0;
+    };
+    std::map<std::string, GpuTiming> m_gpuTimings;
+    // The number of state calls issued and elided by SetPipeline(), summed over the frames.
+    GraphicsAPI::StateStatistics m_stateStatistics;
+    uint64_t m_stateStatisticsFrameCount = 0;
+
     std::vector<XrViewConfigurationType> m_applicationViewConfigurations = {XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, XR_VIEW_CONFIGURATION_TYPE_PRIMARY_MONO};
     std::vector<XrViewConfigurationType> m_viewConfigurations;
     XrViewConfigurationType m_viewConfiguration = XR_VIEW_CONFIGURATION_TYPE_MAX_ENUM;
@@ -1493,8 +2050,6 @@ private:
     // Vertex and index buffers: geometry for our cuboids.
     void *m_vertexBuffer = nullptr;
     void *m_indexBuffer = nullptr;
-    // Camera values constant buffer for the shaders.
-    void *m_uniformBuffer_Camera = nullptr;
     // The normals are stored in a uniform buffer to simplify our vertex geometry.
     void *m_uniformBuffer_Normals = nullptr;
 
@@ -1503,6 +2058,31 @@ private:
 
     // The pipeline is a graphics-API specific state object.
     void *m_pipeline = nullptr;
+    // Set by CreateSwapchains() if all the views are drawn in one pass, into the layers of one color and one depth swapchain.
+    bool m_multiview = false;
+
+    // Created by CreateResources() if shaders and pipelines are to be created on other threads, and released once
+    // IsPipelineReady(). m_vertexShader, m_fragmentShader and m_pipeline are written by its tasks, and mustn't be read until
+    // m_pipelineCreation has completed.
+    std::unique_ptr<ThreadPool> m_resourceThreadPool;
+    // Set by StartSimulationThread(). m_simulationThread runs PollActions(), BlockInteraction() and CaptureScene() for one
+    // frame at a time, and is the only thread to touch the state they use while m_pipelinedFrames is set.
+    bool m_pipelinedFrames = false;
+    std::thread m_simulationThread;
+    std::mutex m_simulationMutex;
+    std::condition_variable m_simulationCondition;
+    // Guarded by m_simulationMutex.
+    XrTime m_simulationTime = 0;
+    bool m_simulationStepPending = false;
+    bool m_stopSimulation = false;
+
+    // Created by CreateResources().
+    std::unique_ptr<JobSystem> m_jobSystem;
+    // Whether the scene is recorded on m_jobSystem. See RenderCuboidsInParallel().
+    bool m_parallelRecording = false;
+    std::future<void> m_pipelineCreation;
+    bool m_pipelineReady = false;
+    std::chrono::steady_clock::time_point m_resourceCreationStart;
 
     // XR_DOCS_TAG_BEGIN_Objects
     // An instance of a 3d colored block.
@@ -1520,6 +2100,9 @@ private:
     // Which block, if any, is nearby to each hand or controller.
     int m_nearBlock[2] = {-1, -1};
     // XR_DOCS_TAG_END_Objects
+    // The positions of m_blocks, indexed by block, for finding the block nearest to a hand. The cells are as wide as
+    // the blocks.
+    SpatialGrid m_blockGrid{0.2f};
 
     // XR_DOCS_TAG_BEGIN_Actions
     XrActionSet m_actionSet;
@@ -0,0 +1,157 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+#include <FileView.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+FileView::FileView(const std::string &filepath) {
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cout << "Could not read file " << filepath.c_str() << ". File does not exist." << std::endl;
+        return;
+    }
+    fileHandle = file;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        std::cout << "Could not read file " << filepath.c_str() << ". Failed to get its size." << std::endl;
+        Close();
+        return;
+    }
+    valid = true;
+    contentsSize = static_cast<size_t>(fileSize.QuadPart);
+    // A file mapping can't be created for an empty file.
+    if (contentsSize > 0) {
+        mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        mapping = mappingHandle ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!mapping) {
+            std::cout << "Could not read file " << filepath.c_str() << ". Failed to map it." << std::endl;
+            Close();
+            return;
+        }
+        contents = static_cast<const char *>(mapping);
+    }
+#else
+    int file = open(filepath.c_str(), O_RDONLY);
+    if (file < 0) {
+        std::cout << "Could not read file " << filepath.c_str() << ". File does not exist." << std::endl;
+        return;
+    }
+    struct stat fileStatus;
+    if (fstat(file, &fileStatus) != 0) {
+        std::cout << "Could not read file " << filepath.c_str() << ". Failed to get its size." << std::endl;
+        close(file);
+        return;
+    }
+    valid = true;
+    contentsSize = static_cast<size_t>(fileStatus.st_size);
+    // mmap() fails for a length of 0.
+    if (contentsSize > 0) {
+        void *address = mmap(nullptr, contentsSize, PROT_READ, MAP_PRIVATE, file, 0);
+        if (address == MAP_FAILED) {
+            std::cout << "Could not read file " << filepath.c_str() << ". Failed to map it." << std::endl;
+            valid = false;
+            contentsSize = 0;
+        } else {
+            mapping = address;
+            contents = static_cast<const char *>(address);
+        }
+    }
+    // The mapping keeps its own reference to the file.
+    close(file);
+#endif
+}
+
+#if defined(__ANDROID__)
+FileView::FileView(const std::string &filepath, AAssetManager *assetManager) {
+    asset = AAssetManager_open(assetManager, filepath.c_str(), AASSET_MODE_BUFFER);
+    if (!asset) {
+        std::cout << "Could not read file " << filepath.c_str() << ". File does not exist." << std::endl;
+        return;
+    }
+    contentsSize = static_cast<size_t>(AAsset_getLength(asset));
+    contents = static_cast<const char *>(AAsset_getBuffer(asset));
+    if (!contents && contentsSize > 0) {
+        std::cout << "Could not read file " << filepath.c_str() << ". Failed to get its buffer." << std::endl;
+        Close();
+        return;
+    }
+    valid = true;
+}
+#endif
+
+FileView::~FileView() {
+    Close();
+}
+
+FileView::FileView(FileView &&other) noexcept {
+    *this = std::move(other);
+}
+
+FileView &FileView::operator=(FileView &&other) noexcept {
+    if (this != &other) {
+        Close();
+        contents = other.contents;
+        contentsSize = other.contentsSize;
+        valid = other.valid;
+        mapping = other.mapping;
+        other.contents = nullptr;
+        other.contentsSize = 0;
+        other.valid = false;
+        other.mapping = nullptr;
+#if defined(_WIN32)
+        fileHandle = other.fileHandle;
+        mappingHandle = other.mappingHandle;
+        other.fileHandle = nullptr;
+        other.mappingHandle = nullptr;
+#endif
+#if defined(__ANDROID__)
+        asset = other.asset;
+        other.asset = nullptr;
+#endif
+    }
+    return *this;
+}
+
+void FileView::Close() {
+#if defined(_WIN32)
+    if (mapping) {
+        UnmapViewOfFile(mapping);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+    }
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#else
+    if (mapping) {
+        munmap(mapping, contentsSize);
+    }
+#endif
+#if defined(__ANDROID__)
+    if (asset) {
+        AAsset_close(asset);
+    }
+    asset = nullptr;
+#endif
+    mapping = nullptr;
+    contents = nullptr;
+    contentsSize = 0;
+    valid = false;
+}
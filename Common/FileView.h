@@ -0,0 +1,57 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+#pragma once
+#include <HelperFunctions.h>
+
+#if defined(__ANDROID__)
+#include <android/asset_manager.h>
+#endif
+
+// A read-only view of the whole contents of a file, which can be passed straight to GraphicsAPI::CreateShader() or an asset
+// loader without copying it into a std::string or std::vector first. Files are memory mapped, so only the pages that are
+// touched are read. Android assets use the buffer of an AAsset opened with AASSET_MODE_BUFFER, which is mapped from the APK
+// when the asset is stored uncompressed. The contents aren't null terminated.
+class FileView {
+public:
+    FileView() = default;
+    FileView(const std::string &filepath);
+#if defined(__ANDROID__)
+    FileView(const std::string &filepath, AAssetManager *assetManager);
+#endif
+    ~FileView();
+
+    FileView(FileView &&other) noexcept;
+    FileView &operator=(FileView &&other) noexcept;
+    FileView(const FileView &) = delete;
+    FileView &operator=(const FileView &) = delete;
+
+    // False if the file couldn't be opened. An empty file is valid, with a size of 0.
+    bool IsValid() const { return valid; }
+
+    const char *data() const { return contents; }
+    size_t size() const { return contentsSize; }
+    const char *begin() const { return contents; }
+    const char *end() const { return contents + contentsSize; }
+
+private:
+    void Close();
+
+private:
+    const char *contents = nullptr;
+    size_t contentsSize = 0;
+    bool valid = false;
+
+    // The mapped address on Linux and Android, and the view on Windows.
+    void *mapping = nullptr;
+#if defined(_WIN32)
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+#if defined(__ANDROID__)
+    AAsset *asset = nullptr;
+#endif
+};
@@ -0,0 +1,226 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+#include <DebugOutput.h>
+#include <FrameTimings.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+const char *FrameTimings::GetStageName(Stage stage) {
+    switch (stage) {
+    case WAIT_FRAME:
+        return "WaitFrame";
+    case BEGIN_FRAME:
+        return "BeginFrame";
+    case POLL_ACTIONS:
+        return "PollActions";
+    case BLOCK_INTERACTION:
+        return "BlockInteraction";
+    case LOCATE_VIEWS:
+        return "LocateViews";
+    case PREPARE_SCENE:
+        return "PrepareScene";
+    case SWAPCHAIN_ACQUIRE:
+        return "SwapchainAcquire";
+    case SWAPCHAIN_WAIT:
+        return "SwapchainWait";
+    case RENDER_VIEW:
+        return "RenderView";
+    case SWAPCHAIN_RELEASE:
+        return "SwapchainRelease";
+    case END_FRAME:
+        return "EndFrame";
+    default:
+        return "Unknown";
+    }
+}
+
+FrameTimings::FrameTimings(size_t capacity)
+    : creationTime(Clock::now()), records(capacity > 0 ? capacity : 1) {
+}
+
+void FrameTimings::BeginFrame() {
+    currentFrame = {};
+    currentFrame.frameIndex = frameCount.load(std::memory_order_relaxed);
+    currentFrame.frameStart = Now();
+}
+
+void FrameTimings::AddStageDuration(Stage stage, int64_t nanoseconds) {
+    currentFrame.stageDurations[stage] += nanoseconds;
+}
+
+void FrameTimings::EndFrame(const XrFrameState &frameState) {
+    currentFrame.predictedDisplayTime = frameState.predictedDisplayTime;
+    currentFrame.predictedDisplayPeriod = frameState.predictedDisplayPeriod;
+    currentFrame.shouldRender = frameState.shouldRender;
+    currentFrame.frameDuration = Now() - currentFrame.frameStart;
+
+    // Write the record before publishing it, so that a reader never sees the new count with the old record.
+    uint64_t index = currentFrame.frameIndex;
+    records[index % records.size()] = currentFrame;
+    frameCount.store(index + 1, std::memory_order_release);
+}
+
+std::vector<FrameTimings::FrameRecord> FrameTimings::GetFrameRecords() const {
+    const uint64_t capacity = records.size();
+    uint64_t end = frameCount.load(std::memory_order_acquire);
+    uint64_t begin = end > capacity ? end - capacity : 0;
+
+    std::vector<FrameRecord> result;
+    result.reserve(static_cast<size_t>(end - begin));
+    for (uint64_t i = begin; i < end; i++) {
+        result.push_back(records[i % capacity]);
+    }
+
+    // The writer may have lapped the reader while copying. Drop the records that it could have overwritten, including the
+    // one it may be writing now: frame newEnd is written before frameCount is published.
+    uint64_t newEnd = frameCount.load(std::memory_order_acquire);
+    uint64_t overwritten = newEnd + 1 > capacity ? newEnd + 1 - capacity : 0;
+    if (overwritten > begin) {
+        result.erase(result.begin(), result.begin() + static_cast<size_t>(std::min(overwritten, end) - begin));
+    }
+    return result;
+}
+
+static FrameTimings::Percentiles CalculatePercentiles(std::vector<double> &values) {
+    FrameTimings::Percentiles percentiles;
+    if (values.empty()) {
+        return percentiles;
+    }
+    // Nearest rank: the smallest value that at least p of the values are less than or equal to.
+    std::sort(values.begin(), values.end());
+    auto Percentile = [&](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(values.size())));
+        return values[std::min(values.size(), std::max<size_t>(rank, 1)) - 1];
+    };
+    percentiles.p50 = Percentile(0.50);
+    percentiles.p95 = Percentile(0.95);
+    percentiles.p99 = Percentile(0.99);
+    return percentiles;
+}
+
+FrameTimings::Summary FrameTimings::GetSummary() const {
+    std::vector<FrameRecord> frames = GetFrameRecords();
+
+    Summary summary;
+    summary.frameCount = frames.size();
+
+    std::vector<double> values(frames.size());
+    auto Collect = [&](auto duration) -> Percentiles {
+        for (size_t i = 0; i < frames.size(); i++) {
+            values[i] = static_cast<double>(duration(frames[i])) * 1e-6;  // To milliseconds.
+        }
+        return CalculatePercentiles(values);
+    };
+    auto CpuDuration = [](const FrameRecord &frame) { return frame.frameDuration - frame.stageDurations[WAIT_FRAME]; };
+
+    summary.frameDuration = Collect([](const FrameRecord &frame) { return frame.frameDuration; });
+    summary.cpuDuration = Collect(CpuDuration);
+    for (uint32_t stage = 0; stage < STAGE_COUNT; stage++) {
+        summary.stageDurations[stage] = Collect([&](const FrameRecord &frame) { return frame.stageDurations[stage]; });
+    }
+
+    for (size_t i = 1; i < frames.size(); i++) {
+        const FrameRecord &previous = frames[i - 1];
+        const FrameRecord &frame = frames[i];
+        XrDuration period = previous.predictedDisplayPeriod;
+        if (period <= 0 || 2 * (frame.predictedDisplayTime - previous.predictedDisplayTime) <= 3 * period) {
+            continue;
+        }
+        if (CpuDuration(previous) > period) {
+            summary.missedFramesCpu++;
+        } else {
+            summary.missedFramesRuntime++;
+        }
+    }
+    return summary;
+}
+
+void FrameTimings::LogSummary() const {
+    Summary summary = GetSummary();
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(3);
+    stream << "Frame timings over " << summary.frameCount << " frames (ms, p50/p95/p99):\n";
+    auto Line = [&](const char *name, const Percentiles &percentiles) {
+        stream << "    " << std::left << std::setw(18) << name << std::right << percentiles.p50 << " / " << percentiles.p95 << " / " << percentiles.p99 << "\n";
+    };
+    Line("Frame", summary.frameDuration);
+    Line("CPU", summary.cpuDuration);
+    for (uint32_t stage = 0; stage < STAGE_COUNT; stage++) {
+        Line(GetStageName(static_cast<Stage>(stage)), summary.stageDurations[stage]);
+    }
+    stream << "    Missed frames: " << summary.missedFramesCpu << " CPU bound, " << summary.missedFramesRuntime << " runtime pacing";
+    XR_TUT_LOG(stream.str());
+}
+
+bool FrameTimings::WriteCSV(const std::string &filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        XR_TUT_LOG_ERROR("Failed to open file: " << filename);
+        return false;
+    }
+
+    file << "frameIndex,predictedDisplayTime,predictedDisplayPeriod,shouldRender,frameStart,frameDuration";
+    for (uint32_t stage = 0; stage < STAGE_COUNT; stage++) {
+        file << "," << GetStageName(static_cast<Stage>(stage));
+    }
+    file << "\n";
+    for (const FrameRecord &frame : GetFrameRecords()) {
+        file << frame.frameIndex << "," << frame.predictedDisplayTime << "," << frame.predictedDisplayPeriod << "," << (frame.shouldRender ? 1 : 0) << "," << frame.frameStart << "," << frame.frameDuration;
+        for (uint32_t stage = 0; stage < STAGE_COUNT; stage++) {
+            file << "," << frame.stageDurations[stage];
+        }
+        file << "\n";
+    }
+    return true;
+}
+
+bool FrameTimings::WriteJSON(const std::string &filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        XR_TUT_LOG_ERROR("Failed to open file: " << filename);
+        return false;
+    }
+
+    Summary summary = GetSummary();
+    auto WritePercentiles = [&](const Percentiles &percentiles) {
+        file << "{\"p50\": " << percentiles.p50 << ", \"p95\": " << percentiles.p95 << ", \"p99\": " << percentiles.p99 << "}";
+    };
+
+    // Durations in the summary are in milliseconds. Durations and times in the frames are in nanoseconds.
+    file << "{\n  \"summary\": {\n";
+    file << "    \"frameCount\": " << summary.frameCount << ",\n";
+    file << "    \"missedFramesCpu\": " << summary.missedFramesCpu << ",\n";
+    file << "    \"missedFramesRuntime\": " << summary.missedFramesRuntime << ",\n";
+    file << "    \"frameDuration\": ";
+    WritePercentiles(summary.frameDuration);
+    file << ",\n    \"cpuDuration\": ";
+    WritePercentiles(summary.cpuDuration);
+    file << ",\n    \"stageDurations\": {";
+    for (uint32_t stage = 0; stage < STAGE_COUNT; stage++) {
+        file << (stage ? ", " : "") << "\"" << GetStageName(static_cast<Stage>(stage)) << "\": ";
+        WritePercentiles(summary.stageDurations[stage]);
+    }
+    file << "}\n  },\n  \"frames\": [";
+
+    bool first = true;
+    for (const FrameRecord &frame : GetFrameRecords()) {
+        file << (first ? "\n" : ",\n");
+        first = false;
+        file << "    {\"frameIndex\": " << frame.frameIndex << ", \"predictedDisplayTime\": " << frame.predictedDisplayTime << ", \"predictedDisplayPeriod\": " << frame.predictedDisplayPeriod
+             << ", \"shouldRender\": " << (frame.shouldRender ? "true" : "false") << ", \"frameStart\": " << frame.frameStart << ", \"frameDuration\": " << frame.frameDuration << ", \"stageDurations\": [";
+        for (uint32_t stage = 0; stage < STAGE_COUNT; stage++) {
+            file << (stage ? ", " : "") << frame.stageDurations[stage];
+        }
+        file << "]}";
+    }
+    file << "\n  ]\n}\n";
+    return true;
+}
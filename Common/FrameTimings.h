@@ -0,0 +1,112 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+#pragma once
+#include <OpenXRHelper.h>
+
+#include <atomic>
+#include <chrono>
+
+// Records the CPU time spent in each stage of the OpenXR frame loop, one FrameRecord per frame, into a fixed size ring
+// buffer. The frame loop thread is the only writer. Other threads may read the recorded frames at any time without
+// locking. The records can be summarised into percentiles and written to CSV or JSON files.
+class FrameTimings {
+public:
+    enum Stage : uint32_t {
+        WAIT_FRAME,
+        BEGIN_FRAME,
+        POLL_ACTIONS,
+        BLOCK_INTERACTION,
+        LOCATE_VIEWS,
+        PREPARE_SCENE,
+        SWAPCHAIN_ACQUIRE,
+        SWAPCHAIN_WAIT,
+        RENDER_VIEW,
+        SWAPCHAIN_RELEASE,
+        END_FRAME,
+        STAGE_COUNT
+    };
+    static const char *GetStageName(Stage stage);
+
+    struct FrameRecord {
+        uint64_t frameIndex = 0;
+        XrTime predictedDisplayTime = 0;
+        XrDuration predictedDisplayPeriod = 0;
+        bool shouldRender = false;
+        int64_t frameStart = 0;                  // Nanoseconds since the FrameTimings was created.
+        int64_t frameDuration = 0;               // Nanoseconds from BeginFrame() to EndFrame().
+        int64_t stageDurations[STAGE_COUNT] = {};  // Nanoseconds. Stages that run per view are summed over the views.
+    };
+
+    struct Percentiles {
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+    };
+    struct Summary {
+        uint64_t frameCount = 0;
+        Percentiles frameDuration;  // Milliseconds.
+        Percentiles cpuDuration;    // Milliseconds. The frame duration less the time blocked in xrWaitFrame.
+        Percentiles stageDurations[STAGE_COUNT];  // Milliseconds.
+        // A frame is missed when the predicted display time advances by more than one and a half display periods.
+        // It's attributed to the CPU when the previous frame's CPU duration was longer than the display period,
+        // and to the runtime's frame pacing otherwise.
+        uint64_t missedFramesCpu = 0;
+        uint64_t missedFramesRuntime = 0;
+    };
+
+    // Measures the time from construction to End(), or to destruction if End() isn't called, and adds it to a stage of the
+    // current frame.
+    class StageTimer {
+    public:
+        StageTimer(FrameTimings &frameTimings, Stage stage)
+            : frameTimings(frameTimings), stage(stage), start(std::chrono::steady_clock::now()) {}
+        ~StageTimer() { End(); }
+
+        void End() {
+            if (!ended) {
+                frameTimings.AddStageDuration(stage, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+                ended = true;
+            }
+        }
+
+    private:
+        FrameTimings &frameTimings;
+        Stage stage;
+        std::chrono::steady_clock::time_point start;
+        bool ended = false;
+    };
+
+    FrameTimings(size_t capacity = 4096);
+
+    // Called by the frame loop thread around each frame.
+    void BeginFrame();
+    void AddStageDuration(Stage stage, int64_t nanoseconds);
+    void EndFrame(const XrFrameState &frameState);
+
+    // Returns the recorded frames, oldest first. At most capacity of the most recent frames are kept.
+    std::vector<FrameRecord> GetFrameRecords() const;
+    Summary GetSummary() const;
+
+    void LogSummary() const;
+    bool WriteCSV(const std::string &filename) const;
+    bool WriteJSON(const std::string &filename) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    int64_t Now() const { return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - creationTime).count(); }
+
+private:
+    Clock::time_point creationTime;
+
+    std::vector<FrameRecord> records;
+    // The number of frames ever published. Frame n is stored in records[n % records.size()].
+    std::atomic<uint64_t> frameCount{0};
+
+    // Only accessed by the frame loop thread.
+    FrameRecord currentFrame{};
+};
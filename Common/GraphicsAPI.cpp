@@ -7,6 +7,10 @@
 #include <GraphicsAPI.h>
 
 bool CheckGraphicsAPI_TypeIsValidForPlatform(GraphicsAPI_Type type) {
+    // GraphicsAPI_Null has no platform dependencies.
+    if (type == NULL_API) {
+        return true;
+    }
 #if defined(XR_USE_PLATFORM_WIN32)
     return (type == D3D11) || (type == D3D12) || (type == OPENGL) || (type == VULKAN);
 #elif defined(XR_USE_PLATFORM_XLIB) || defined(XR_USE_PLATFORM_XCB) || defined(XR_USE_PLATFORM_WAYLAND)
@@ -43,6 +47,9 @@ const char *GetGraphicsAPIInstanceExtensionString(GraphicsAPI_Type type) {
         return XR_KHR_VULKAN_ENABLE_EXTENSION_NAME;
     }
 #endif
+    if (type == NULL_API) {
+        return XR_MND_HEADLESS_EXTENSION_NAME;
+    }
     std::cerr << "ERROR: Unknown Graphics API." << std::endl;
     DEBUG_BREAK;
     return nullptr;
@@ -79,3 +86,101 @@ int64_t GraphicsAPI::SelectDepthSwapchainFormat(const std::vector<int64_t> &form
     return *swapchainFormatIt;
 }
 // XR_DOCS_TAG_END_GraphicsAPI_SelectSwapchainFormats
+
+GraphicsAPI::TransientAllocation GraphicsAPI::AllocateTransientData(TransientBuffer &transientBuffer, size_t size, const void *data) {
+    size_t alignedSize = Align<size_t>(size, transientAlignment);
+    if (alignedSize > transientBuffer.size) {
+        std::cout << "ERROR: Transient allocation of " << size << " bytes exceeds the buffer size of " << transientBuffer.size << " bytes." << std::endl;
+        DEBUG_BREAK;
+        return {nullptr, 0, 0};
+    }
+
+    if (!transientBuffer.buffer) {
+        transientBuffer.buffer = CreateBuffer({transientBuffer.type, 0, transientBuffer.size, nullptr, BufferCreateInfo::Usage::STREAM});
+        transientBuffer.offset = 0;
+    }
+
+    // Wrap around to the start of the ring. Overwriting older data is safe here: D3D11 maps offset 0 with
+    // D3D11_MAP_WRITE_DISCARD, which renames the buffer, and later offsets with D3D11_MAP_WRITE_NO_OVERWRITE, which
+    // keeps the earlier sub-allocations of the frame, or with another discard for constant buffers on drivers that can't
+    // map them without one. OpenGL orders buffer updates against in-flight draws, D3D12 waits
+    // for the GPU in EndRendering() and Vulkan resets the ring in BeginRendering() after waiting for its fence.
+    if (transientBuffer.offset + alignedSize > transientBuffer.size) {
+        transientBuffer.offset = 0;
+    }
+
+    TransientAllocation allocation = {transientBuffer.buffer, transientBuffer.offset, size};
+    SetBufferData(allocation.buffer, allocation.offset, size, const_cast<void *>(data));
+    transientBuffer.offset += alignedSize;
+    return allocation;
+}
+
+void GraphicsAPI::ReserveTransientData(TransientBuffer &transientBuffer, size_t size) {
+    size = Align<size_t>(size, transientAlignment);
+    if (size <= transientBuffer.size) {
+        return;
+    }
+    // Must be called outside of rendering, as the current buffer is destroyed and recreated before it is next used.
+    if (transientBuffer.buffer) {
+        DestroyBuffer(transientBuffer.buffer);
+        transientBuffer.buffer = nullptr;
+    }
+    transientBuffer.offset = 0;
+    transientBuffer.size = size;
+}
+
+void GraphicsAPI::DestroyTransientBuffers() {
+    for (TransientBuffer *transientBuffer : {&transientUniformBuffer, &transientVertexBuffer}) {
+        if (transientBuffer->buffer) {
+            DestroyBuffer(transientBuffer->buffer);
+            transientBuffer->buffer = nullptr;
+        }
+        transientBuffer->offset = 0;
+    }
+}
+
+void GraphicsAPI::ResetTimestampQuerySet(TimestampQuerySet &querySet) {
+    querySet.count = 0;
+    querySet.submission = timestampSubmission++;
+    querySet.pending = false;
+    querySet.scopes.clear();
+    querySet.openScopes.clear();
+    querySet.timestamps.resize(querySet.capacity);
+}
+
+bool GraphicsAPI::BeginTimestampQuery(TimestampQuerySet &querySet, const std::string &name, uint32_t &query) {
+    uint32_t depth = static_cast<uint32_t>(querySet.openScopes.size());
+    uint32_t stride = querySet.queriesPerTimestamp;
+    if (querySet.count + 2 * stride > querySet.capacity) {
+        // Still push the scope, so that the matching EndTimestampQuery() is also dropped.
+        querySet.openScopes.push_back(SIZE_MAX);
+        return false;
+    }
+    query = querySet.count;
+    querySet.count += 2 * stride;
+    querySet.openScopes.push_back(querySet.scopes.size());
+    querySet.scopes.push_back({name, depth, query, query + stride});
+    return true;
+}
+
+bool GraphicsAPI::EndTimestampQuery(TimestampQuerySet &querySet, uint32_t &query) {
+    if (querySet.openScopes.empty()) {
+        std::cout << "ERROR: EndTimestampScope() called without a matching BeginTimestampScope()." << std::endl;
+        return false;
+    }
+    size_t scope = querySet.openScopes.back();
+    querySet.openScopes.pop_back();
+    if (scope == SIZE_MAX) {
+        return false;
+    }
+    query = querySet.scopes[scope].endQuery;
+    return true;
+}
+
+void GraphicsAPI::ResolveTimestampQueries(TimestampQuerySet &querySet, double nanosecondsPerTick, uint64_t validMask) {
+    for (const TimestampQuerySet::Scope &scope : querySet.scopes) {
+        uint64_t ticks = (querySet.timestamps[scope.endQuery] - querySet.timestamps[scope.beginQuery]) & validMask;
+        timestampResults.push_back({scope.name, scope.depth, querySet.submission, static_cast<double>(ticks) * nanosecondsPerTick * 1e-6});
+    }
+    querySet.pending = false;
+}
@@ -110,7 +110,8 @@ enum GraphicsAPI_Type : uint8_t {
     D3D12,
     OPENGL,
     OPENGL_ES,
-    VULKAN
+    VULKAN,
+    NULL_API
 };
 
 bool CheckGraphicsAPI_TypeIsValidForPlatform(GraphicsAPI_Type type);
@@ -266,10 +267,15 @@ public:
         const char* semanticName;
     };
     typedef std::vector<VertexInputAttribute> VertexInputAttributes;
+    enum class VertexInputRate : uint8_t {
+        VERTEX,
+        INSTANCE
+    };
     struct VertexInputBinding {
         uint32_t bindingIndex;  // Which buffer to use when bound for draws.
         size_t offset;
         size_t stride;
+        VertexInputRate inputRate;  // Advance per vertex (default) or per instance.
     };
     typedef std::vector<VertexInputBinding> VertexInputBindings;
     struct VertexInputState {
@@ -349,6 +355,10 @@ public:
         std::vector<int64_t> colorFormats;
         int64_t depthFormat;
         std::vector<DescriptorInfo> layout;
+        // Non-zero to draw every view whose bit is set in one pass, to the array layer of the attachments with the same
+        // index. The attachments must be TYPE_2D_ARRAY views and the vertex shader must read the view index. Requires
+        // SupportsMultiview().
+        uint32_t viewMask = 0;
     };
 
     struct SwapchainCreateInfo {
@@ -369,6 +379,14 @@ public:
         size_t stride;
         size_t size;
         void* data;
+        // How often the contents are written. STATIC buffers are written when they are created and rarely afterwards, so
+        // they may be placed in memory that the CPU can't write directly. DYNAMIC buffers are rewritten every few frames,
+        // and STREAM buffers are rewritten every frame.
+        enum class Usage : uint8_t {
+            STATIC,
+            DYNAMIC,
+            STREAM,
+        } usage = Usage::DYNAMIC;
     };
 
     struct ImageCreateInfo {
@@ -463,6 +481,29 @@ public:
         Extent2D extent;
     };
 
+    struct TransientAllocation {
+        void* buffer;
+        size_t offset;
+        size_t size;
+    };
+
+    struct CacheStatistics {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    struct StateStatistics {
+        uint64_t issued = 0;
+        uint64_t elided = 0;
+    };
+
+    struct TimestampResult {
+        std::string name;
+        uint32_t depth;       // Number of scopes enclosing this one.
+        uint64_t submission;  // Counts BeginRendering() calls, so scopes from the same submission share a value.
+        double milliseconds;  // GPU time between the start and end of the scope.
+    };
+
 public:
     virtual ~GraphicsAPI() = default;
 
@@ -500,12 +541,46 @@ public:
 
     virtual void* CreatePipeline(const PipelineCreateInfo& pipelineCI) = 0;
     virtual void DestroyPipeline(void*& pipeline) = 0;
+    // Whether CreateShader() and CreatePipeline() may be called from other threads, concurrently with each other and with
+    // rendering. The pipeline mustn't be used until its creation has returned.
+    virtual bool SupportsThreadedPipelineCreation() const { return false; }
+    // Whether pipelines may set PipelineCreateInfo::viewMask. Otherwise, draw each view with its own render attachments.
+    virtual bool SupportsMultiview() const { return false; }
 
     virtual void BeginRendering() = 0;
     virtual void EndRendering() = 0;
 
     virtual void SetBufferData(void* buffer, size_t offset, size_t size, void* data) = 0;
 
+    // Sub-allocates per-frame data from a shared ring buffer and copies data into it. The returned buffer and offset are valid
+    // for the current frame only; use them in DescriptorInfo::bufferOffset/bufferSize or as SetVertexBuffers() offsets.
+    TransientAllocation AllocateTransientUniformData(size_t size, const void* data) { return AllocateTransientData(transientUniformBuffer, size, data); }
+    TransientAllocation AllocateTransientVertexData(size_t size, const void* data) { return AllocateTransientData(transientVertexBuffer, size, data); }
+    void ReserveTransientUniformData(size_t size) { ReserveTransientData(transientUniformBuffer, size); }
+    void ReserveTransientVertexData(size_t size) { ReserveTransientData(transientVertexBuffer, size); }
+    // Each transient allocation is rounded up to a multiple of this, which reservations for several allocations must allow for.
+    size_t GetTransientAlignment() const { return transientAlignment; }
+
+    // Named GPU timing scopes, which can be nested, recorded between BeginRendering() and EndRendering(). The timestamps
+    // are read back once the GPU has finished the submission, which is a few submissions later, so the CPU never waits
+    // for them. Backends without timestamp queries ignore the scopes.
+    virtual void BeginTimestampScope(const std::string& name) {}
+    virtual void EndTimestampScope() {}
+    // Returns the results that have been read back since the last call, oldest first.
+    std::vector<TimestampResult> GetTimestampResults() {
+        std::vector<TimestampResult> results;
+        results.swap(timestampResults);
+        return results;
+    }
+
+    // Returns the number of state calls that SetPipeline() issued and elided since the last call. Only the OpenGL backend
+    // skips redundant state calls, so the others return zeros.
+    StateStatistics GetStateStatistics() {
+        StateStatistics statistics = stateStatistics;
+        stateStatistics = {};
+        return statistics;
+    }
+
     virtual void ClearColor(void* imageView, float r, float g, float b, float a) = 0;
     virtual void ClearDepth(void* imageView, float d) = 0;
 
@@ -516,13 +591,84 @@ public:
     virtual void SetPipeline(void* pipeline) = 0;
     virtual void SetDescriptor(const DescriptorInfo& descriptorInfo) = 0;
     virtual void UpdateDescriptors() = 0;
-    virtual void SetVertexBuffers(void** vertexBuffers, size_t count) = 0;
+    virtual void SetVertexBuffers(void** vertexBuffers, size_t count, const size_t* offsets = nullptr) = 0;
     virtual void SetIndexBuffer(void* indexBuffer) = 0;
     virtual void DrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0) = 0;
     virtual void Draw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0) = 0;
 
+    // Whether draws into the attachments of the last SetRenderAttachments() may be recorded on other threads. A thread
+    // calls BeginParallelCommands(), after which its Set*(), UpdateDescriptors(), Draw*() and AllocateTransient*Data()
+    // calls are recorded into a command list of its own until EndParallelCommands(). Nothing else may be called between
+    // the two, and the viewports, scissors and pipeline aren't inherited so must be set again. Each index must only be
+    // used by one thread at a time. Once every thread has called EndParallelCommands(), ExecuteParallelCommands() on the
+    // rendering thread executes the command lists in index order. Without support, record everything on the rendering
+    // thread.
+    virtual bool SupportsParallelRecording() const { return false; }
+    virtual void BeginParallelCommands(uint32_t index) {}
+    virtual void EndParallelCommands() {}
+    virtual void ExecuteParallelCommands() {}
+
 protected:
     virtual const std::vector<int64_t> GetSupportedColorSwapchainFormats() = 0;
     virtual const std::vector<int64_t> GetSupportedDepthSwapchainFormats() = 0;
+
+    struct TransientBuffer {
+        BufferCreateInfo::Type type;
+        void* buffer = nullptr;
+        size_t size = 1024 * 1024;
+        size_t offset = 0;
+    };
+    virtual TransientAllocation AllocateTransientData(TransientBuffer& transientBuffer, size_t size, const void* data);
+    void ReserveTransientData(TransientBuffer& transientBuffer, size_t size);
+    void DestroyTransientBuffers();
+
+    // Tracks the scopes of one submission's timestamp queries. Each scope uses two consecutive blocks of
+    // queriesPerTimestamp queries, the first query of each block holding its timestamp. Blocks are wider than one query
+    // only for backends whose timestamps inside a multiview render pass use one query per view. Scopes that don't fit
+    // within capacity are dropped. Backends end any open scopes in EndRendering().
+    struct TimestampQuerySet {
+        struct Scope {
+            std::string name;
+            uint32_t depth;
+            uint32_t beginQuery;
+            uint32_t endQuery;
+        };
+        uint32_t capacity = 64;
+        uint32_t queriesPerTimestamp = 1;
+        uint32_t count = 0;
+        uint64_t submission = 0;
+        bool pending = false;  // Set once submitted and cleared when the results are read back.
+        std::vector<Scope> scopes;
+        std::vector<size_t> openScopes;
+        std::vector<uint64_t> timestamps;
+    };
+    void ResetTimestampQuerySet(TimestampQuerySet& querySet);
+    // Return false if the scope was dropped and so no timestamp should be written.
+    bool BeginTimestampQuery(TimestampQuerySet& querySet, const std::string& name, uint32_t& query);
+    bool EndTimestampQuery(TimestampQuerySet& querySet, uint32_t& query);
+    // Converts querySet.timestamps into TimestampResults. Differences are masked to the valid bits to handle wrap around.
+    void ResolveTimestampQueries(TimestampQuerySet& querySet, double nanosecondsPerTick, uint64_t validMask);
+
+    // Hashes the keys of caches that are looked up by a list of handles and values.
+    struct CacheKeyHash {
+        size_t operator()(const std::vector<uint64_t>& key) const {
+            size_t seed = key.size();
+            for (const uint64_t& value : key) {
+                HashCombine(seed, std::hash<uint64_t>()(value));
+            }
+            return seed;
+        }
+    };
+
     bool debugAPI = false;
+
+    TransientBuffer transientUniformBuffer = {BufferCreateInfo::Type::UNIFORM};
+    TransientBuffer transientVertexBuffer = {BufferCreateInfo::Type::VERTEX};
+    // 256 bytes satisfies D3D11/D3D12 constant buffer placement and the maximum Vulkan/OpenGL uniform buffer offset alignments.
+    size_t transientAlignment = 256;
+
+    std::vector<TimestampResult> timestampResults;
+    uint64_t timestampSubmission = 0;
+
+    StateStatistics stateStatistics;
 };
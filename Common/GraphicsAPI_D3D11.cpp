@@ -192,6 +192,7 @@ GraphicsAPI_D3D11::GraphicsAPI_D3D11() {
     }
     D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
     D3D11_CHECK(D3D11CreateDevice(adapter, D3D_DRIVER_TYPE_UNKNOWN, 0, D3D11_CREATE_DEVICE_DEBUG, &featureLevel, 1, D3D11_SDK_VERSION, &device, nullptr, &immediateContext), "Failed to create D3D11 Device.");
+    QueryFeatureSupport();
 }
 
 // XR_DOCS_TAG_BEGIN_GraphicsAPI_D3D11
@@ -215,6 +216,7 @@ GraphicsAPI_D3D11::GraphicsAPI_D3D11(XrInstance m_xrInstance, XrSystemId systemI
     OPENXR_CHECK(adapter != nullptr ? XR_SUCCESS : XR_ERROR_VALIDATION_FAILURE, "Failed to find matching graphics adapter from xrGetD3D11GraphicsRequirementsKHR.");
 
     D3D11_CHECK(D3D11CreateDevice(adapter, D3D_DRIVER_TYPE_UNKNOWN, 0, D3D11_CREATE_DEVICE_DEBUG, &graphicsRequirements.minFeatureLevel, 1, D3D11_SDK_VERSION, &device, nullptr, &immediateContext), "Failed to create D3D11 Device.");
+    QueryFeatureSupport();
 
 	device->QueryInterface( __uuidof(ID3D11Debug), (void**)&d3dDebug );
 	d3dDebug->QueryInterface( __uuidof(ID3D11InfoQueue), (void**)&infoQueue );
@@ -223,11 +225,20 @@ GraphicsAPI_D3D11::GraphicsAPI_D3D11(XrInstance m_xrInstance, XrSystemId systemI
 }
 
 GraphicsAPI_D3D11::~GraphicsAPI_D3D11() {
+    DestroyTransientBuffers();
+
     D3D11_SAFE_RELEASE(immediateContext);
     D3D11_SAFE_RELEASE(device);
     D3D11_SAFE_RELEASE(factory);
 }
 // XR_DOCS_TAG_END_GraphicsAPI_D3D11
+void GraphicsAPI_D3D11::QueryFeatureSupport() {
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+    if (SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options)))) {
+        mapNoOverwriteOnDynamicConstantBuffer = options.MapNoOverwriteOnDynamicConstantBuffer;
+    }
+}
+
 static bool DesktopSwapchainVsync = false;
 void *GraphicsAPI_D3D11::CreateDesktopSwapchain(const SwapchainCreateInfo &swapchainCI) {
     DesktopSwapchainVsync = swapchainCI.vsync;
@@ -565,8 +576,8 @@ void *GraphicsAPI_D3D11::CreateBuffer(const BufferCreateInfo &bufferCI) {
     initData.pSysMem = bufferCI.data;
     initData.SysMemPitch = (UINT)bufferCI.stride;
     initData.SysMemSlicePitch = 0;
-    bool cpu_access = true;
-    //(bufferCI.type == GraphicsAPI::BufferCreateInfo::Type::UNIFORM);
+    // STATIC buffers are only written by the GPU, so they can be placed in video memory. SetBufferData() updates them with UpdateSubresource().
+    bool cpu_access = bufferCI.usage != BufferCreateInfo::Usage::STATIC;
 
     D3D11_BUFFER_DESC desc{};
     desc.ByteWidth = (UINT)(bufferCI.size);
@@ -579,8 +590,10 @@ void *GraphicsAPI_D3D11::CreateBuffer(const BufferCreateInfo &bufferCI) {
     ID3D11Buffer *d3D11Buffer = nullptr;
     D3D11_CHECK(device->CreateBuffer(&desc, bufferCI.data ? &initData : nullptr, &d3D11Buffer), "Failed to create Buffer");
 
-    SetBufferData(d3D11Buffer, 0, bufferCI.size, bufferCI.data);
     buffers[d3D11Buffer] = bufferCI;
+    if (cpu_access) {
+        SetBufferData(d3D11Buffer, 0, bufferCI.size, bufferCI.data);
+    }
 
     return d3D11Buffer;
 }
@@ -664,8 +677,34 @@ void GraphicsAPI_D3D11::EndRendering() {
 
 void GraphicsAPI_D3D11::SetBufferData(void *buffer, size_t offset, size_t size, void *data) {
     ID3D11Buffer *d3d11Buffer = (ID3D11Buffer *)buffer;
+    const BufferCreateInfo &bufferCI = buffers[d3d11Buffer];
+    if (bufferCI.usage == BufferCreateInfo::Usage::STATIC) {
+        if (!data) {
+            return;
+        }
+        // Constant buffers can only be updated as a whole, as UpdateSubresource() doesn't take a box for them.
+        if (bufferCI.type == BufferCreateInfo::Type::UNIFORM) {
+            if (offset != 0 || size < bufferCI.size) {
+                std::cout << "ERROR: D3D11: Partial update of a STATIC uniform buffer: offset " << offset << ", size " << size << " of " << bufferCI.size << " bytes." << std::endl;
+                DEBUG_BREAK;
+                return;
+            }
+            immediateContext->UpdateSubresource(d3d11Buffer, 0, nullptr, data, 0, 0);
+            return;
+        }
+        D3D11_BOX box = {(UINT)offset, 0, 0, (UINT)(offset + size), 1, 1};
+        immediateContext->UpdateSubresource(d3d11Buffer, 0, &box, data, 0, 0);
+        return;
+    }
+
     D3D11_MAPPED_SUBRESOURCE mappedSubresource = {};
-    D3D11_CHECK(immediateContext->Map(d3d11Buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedSubresource), "Failed to map Resource.");
+    // Writing from the start of the buffer discards (renames) it. Writing further in keeps the earlier contents, so that the
+    // transient ring buffers can sub-allocate several ranges from one dynamic buffer per frame. Constant buffers can only
+    // be mapped without discarding when the driver supports it. Otherwise each allocation renames the buffer: draws already
+    // submitted keep the contents they were recorded with, and the new contents only need the range being written.
+    bool noOverwrite = offset != 0 && (bufferCI.type != BufferCreateInfo::Type::UNIFORM || mapNoOverwriteOnDynamicConstantBuffer);
+    D3D11_MAP mapType = noOverwrite ? D3D11_MAP_WRITE_NO_OVERWRITE : D3D11_MAP_WRITE_DISCARD;
+    D3D11_CHECK(immediateContext->Map(d3d11Buffer, 0, mapType, 0, &mappedSubresource), "Failed to map Resource.");
     if (mappedSubresource.pData && data)
         memcpy((char *)mappedSubresource.pData + offset, data, size);
     immediateContext->Unmap(d3d11Buffer, 0);
@@ -759,14 +798,21 @@ void GraphicsAPI_D3D11::SetPipeline(void *pipeline) {
 
         std::vector<D3D11_INPUT_ELEMENT_DESC> elements;
         for (const VertexInputAttribute &attribute : pipelineCI.vertexInputState.attributes) {
+            bool perInstance = false;
+            for (const VertexInputBinding &binding : pipelineCI.vertexInputState.bindings) {
+                if (binding.bindingIndex == attribute.bindingIndex) {
+                    perInstance = binding.inputRate == VertexInputRate::INSTANCE;
+                }
+            }
+
             D3D11_INPUT_ELEMENT_DESC element{};
             element.SemanticName = attribute.semanticName;
             element.SemanticIndex = attribute.attribIndex;
             element.Format = ToDXGI_FORMAT(attribute.vertexType);
             element.InputSlot = attribute.bindingIndex;
             element.AlignedByteOffset = (UINT)attribute.offset;
-            element.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-            element.InstanceDataStepRate = 0;
+            element.InputSlotClass = perInstance ? D3D11_INPUT_PER_INSTANCE_DATA : D3D11_INPUT_PER_VERTEX_DATA;
+            element.InstanceDataStepRate = perInstance ? 1 : 0;
             elements.push_back(element);
         }
 
@@ -966,19 +1012,19 @@ void GraphicsAPI_D3D11::SetDescriptor(const DescriptorInfo &descriptorInfo) {
 void GraphicsAPI_D3D11::UpdateDescriptors() {
 }
 
-void GraphicsAPI_D3D11::SetVertexBuffers(void **vertexBuffers, size_t count) {
+void GraphicsAPI_D3D11::SetVertexBuffers(void **vertexBuffers, size_t count, const size_t *offsets) {
     const VertexInputState &vertexInputState = pipelines[setPipeline].vertexInputState;
     std::vector<UINT> strides;
-    std::vector<UINT> offsets;
+    std::vector<UINT> d3d11Offsets;
     for (size_t i = 0; i < count; i++) {
         for (const VertexInputBinding &vertexBinding : vertexInputState.bindings) {
             if (vertexBinding.bindingIndex == (uint32_t)i) {
                 strides.push_back((UINT)vertexBinding.stride);
-                offsets.push_back(0);
+                d3d11Offsets.push_back(offsets ? (UINT)offsets[i] : 0);
             }
         }
     }
-    immediateContext->IASetVertexBuffers(0, (UINT)count, (ID3D11Buffer *const *)vertexBuffers, strides.data(), offsets.data());
+    immediateContext->IASetVertexBuffers(0, (UINT)count, (ID3D11Buffer *const *)vertexBuffers, strides.data(), d3d11Offsets.data());
 }
 
 void GraphicsAPI_D3D11::SetIndexBuffer(void *indexBuffer) {
@@ -68,7 +68,7 @@ public:
     virtual void SetPipeline(void* pipeline) override;
     virtual void SetDescriptor(const DescriptorInfo& descriptorInfo) override;
     virtual void UpdateDescriptors() override;
-    virtual void SetVertexBuffers(void** vertexBuffers, size_t count) override;
+    virtual void SetVertexBuffers(void** vertexBuffers, size_t count, const size_t* offsets = nullptr) override;
     virtual void SetIndexBuffer(void* indexBuffer) override;
     virtual void DrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0) override;
     virtual void Draw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0) override;
@@ -77,6 +77,8 @@ private:
     virtual const std::vector<int64_t> GetSupportedColorSwapchainFormats() override;
     virtual const std::vector<int64_t> GetSupportedDepthSwapchainFormats() override;
 
+    void QueryFeatureSupport();
+
 private:
     IDXGIFactory4* factory = nullptr;
     ID3D11Device* device = nullptr;
@@ -85,6 +87,10 @@ private:
 	ID3D11InfoQueue *infoQueue=nullptr;
     ID3D11DeviceContext* immediateContext = nullptr;
 
+    // D3D11_FEATURE_D3D11_OPTIONS::MapNoOverwriteOnDynamicConstantBuffer, without which dynamic constant buffers can only be
+    // mapped with D3D11_MAP_WRITE_DISCARD.
+    bool mapNoOverwriteOnDynamicConstantBuffer = false;
+
     PFN_xrGetD3D11GraphicsRequirementsKHR xrGetD3D11GraphicsRequirementsKHR = nullptr;
     XrGraphicsBindingD3D11KHR graphicsBinding{};
 
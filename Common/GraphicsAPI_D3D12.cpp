@@ -292,6 +292,8 @@ GraphicsAPI_D3D12::GraphicsAPI_D3D12(XrInstance m_xrInstance, XrSystemId systemI
 }
 
 GraphicsAPI_D3D12 ::~GraphicsAPI_D3D12() {
+    DestroyTransientBuffers();
+
     D3D12_SAFE_RELEASE(SAMPLER_DescriptorHeap);
     D3D12_SAFE_RELEASE(CBV_SRV_UAV_DescriptorHeap);
     D3D12_SAFE_RELEASE(queue);
@@ -810,14 +812,21 @@ void *GraphicsAPI_D3D12::CreatePipeline(const PipelineCreateInfo &pipelineCI) {
     // VertexInput
     std::vector<D3D12_INPUT_ELEMENT_DESC> inputLayout;
     for (auto &attrib : pipelineCI.vertexInputState.attributes) {
+        bool perInstance = false;
+        for (auto &binding : pipelineCI.vertexInputState.bindings) {
+            if (binding.bindingIndex == attrib.bindingIndex) {
+                perInstance = binding.inputRate == VertexInputRate::INSTANCE;
+            }
+        }
+
         D3D12_INPUT_ELEMENT_DESC il;
         il.SemanticName = attrib.semanticName;
         il.SemanticIndex = attrib.attribIndex;
         il.Format = ToDXGI_FORMAT(attrib.vertexType);
         il.InputSlot = attrib.bindingIndex;
         il.AlignedByteOffset = attrib.offset;
-        il.InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
-        il.InstanceDataStepRate = 0;
+        il.InputSlotClass = perInstance ? D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA : D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
+        il.InstanceDataStepRate = perInstance ? 1 : 0;
         inputLayout.push_back(il);
     }
     GPSD.InputLayout = {inputLayout.data(), (UINT)inputLayout.size()};
@@ -1233,7 +1242,7 @@ void GraphicsAPI_D3D12::UpdateDescriptors() {
     descriptorInfos.clear();
 }
 
-void GraphicsAPI_D3D12::SetVertexBuffers(void **vertexBuffers, size_t count) {
+void GraphicsAPI_D3D12::SetVertexBuffers(void **vertexBuffers, size_t count, const size_t *offsets) {
     std::vector<D3D12_VERTEX_BUFFER_VIEW> vertexBufferViews;
     vertexBufferViews.reserve(count);
     for (size_t i = 0; i < count; i++) {
@@ -1242,8 +1251,9 @@ void GraphicsAPI_D3D12::SetVertexBuffers(void **vertexBuffers, size_t count) {
             if (vertexBinding.bindingIndex == (uint32_t)i) {
                 D3D12_VERTEX_BUFFER_VIEW vertexBufferView;
                 ID3D12Resource *d3d12VertexBuffer = reinterpret_cast<ID3D12Resource *>(vertexBuffers[i]);
-                vertexBufferView.BufferLocation = d3d12VertexBuffer->GetGPUVirtualAddress();
-                vertexBufferView.SizeInBytes = d3d12VertexBuffer->GetDesc().Width;
+                UINT64 offset = offsets ? offsets[i] : 0;
+                vertexBufferView.BufferLocation = d3d12VertexBuffer->GetGPUVirtualAddress() + offset;
+                vertexBufferView.SizeInBytes = static_cast<UINT>(d3d12VertexBuffer->GetDesc().Width - offset);
                 vertexBufferView.StrideInBytes = vertexBinding.stride;
                 vertexBufferViews.push_back(vertexBufferView);
             }
@@ -0,0 +1,423 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+#include <GraphicsAPI_Null.h>
+
+GraphicsAPI_Null::GraphicsAPI_Null(bool validate)
+    : validate(validate) {
+}
+
+GraphicsAPI_Null::GraphicsAPI_Null(XrInstance m_xrInstance, XrSystemId systemId, bool validate)
+    : validate(validate) {
+    // There are no graphics requirements to query: the XrSession is created with XR_MND_headless.
+}
+
+GraphicsAPI_Null::~GraphicsAPI_Null() {
+    DestroyTransientBuffers();
+
+    if (validate) {
+        size_t leaked = images.size() + imageViews.size() + samplers.size() + buffers.size() + shaders.size() + pipelines.size();
+        if (leaked > 0) {
+            ValidationError("~GraphicsAPI_Null", std::to_string(leaked) + " resources were not destroyed.");
+        }
+    }
+}
+
+void *GraphicsAPI_Null::CreateDesktopSwapchain(const SwapchainCreateInfo &swapchainCI) {
+    DesktopSwapchain desktopSwapchain;
+    desktopSwapchain.swapchainCI = swapchainCI;
+    for (uint32_t i = 0; i < swapchainCI.count; i++) {
+        desktopSwapchain.images.push_back(CreateImage({2, swapchainCI.width, swapchainCI.height, 1, 1, 1, 1, swapchainCI.format, false, true, false, false}));
+    }
+
+    void *swapchain = CreateHandle();
+    desktopSwapchains[swapchain] = desktopSwapchain;
+    return swapchain;
+}
+
+void GraphicsAPI_Null::DestroyDesktopSwapchain(void *&swapchain) {
+    if (!Validate(desktopSwapchains, swapchain, "DestroyDesktopSwapchain", "swapchain")) {
+        return;
+    }
+    for (void *&image : desktopSwapchains[swapchain].images) {
+        DestroyImage(image);
+    }
+    desktopSwapchains.erase(swapchain);
+    swapchain = nullptr;
+}
+
+void *GraphicsAPI_Null::GetDesktopSwapchainImage(void *swapchain, uint32_t index) {
+    return desktopSwapchains[swapchain].images[index];
+}
+
+void GraphicsAPI_Null::AcquireDesktopSwapchanImage(void *swapchain, uint32_t &index) {
+    DesktopSwapchain &desktopSwapchain = desktopSwapchains[swapchain];
+    index = desktopSwapchain.index;
+    desktopSwapchain.index = (desktopSwapchain.index + 1) % desktopSwapchain.swapchainCI.count;
+}
+
+void GraphicsAPI_Null::PresentDesktopSwapchainImage(void *swapchain, uint32_t index) {
+}
+
+XrSwapchainImageBaseHeader *GraphicsAPI_Null::AllocateSwapchainImageData(XrSwapchain swapchain, SwapchainType type, uint32_t count) {
+    // The images are owned by this GraphicsAPI rather than the runtime, so that they can be used as render targets.
+    std::vector<SwapchainImage> swapchainImages(count, {XR_TYPE_UNKNOWN, nullptr, nullptr});
+    for (SwapchainImage &swapchainImage : swapchainImages) {
+        bool color = type == SwapchainType::COLOR;
+        swapchainImage.image = CreateImage({2, 0, 0, 1, 1, 1, 1, color ? COLOR_FORMAT_R8G8B8A8_SRGB : GetDepthFormat(), false, color, !color, false});
+    }
+    swapchainImagesMap[swapchain] = {type, swapchainImages};
+    return reinterpret_cast<XrSwapchainImageBaseHeader *>(swapchainImagesMap[swapchain].second.data());
+}
+
+void GraphicsAPI_Null::FreeSwapchainImageData(XrSwapchain swapchain) {
+    for (SwapchainImage &swapchainImage : swapchainImagesMap[swapchain].second) {
+        DestroyImage(swapchainImage.image);
+    }
+    swapchainImagesMap.erase(swapchain);
+}
+
+void *GraphicsAPI_Null::CreateImage(const ImageCreateInfo &imageCI) {
+    statistics.resourcesCreated++;
+    void *image = CreateHandle();
+    images[image] = imageCI;
+    return image;
+}
+
+void GraphicsAPI_Null::DestroyImage(void *&image) {
+    if (!Validate(images, image, "DestroyImage", "image")) {
+        return;
+    }
+    statistics.resourcesDestroyed++;
+    images.erase(image);
+    image = nullptr;
+}
+
+void *GraphicsAPI_Null::CreateImageView(const ImageViewCreateInfo &imageViewCI) {
+    Validate(images, imageViewCI.image, "CreateImageView", "image");
+    statistics.resourcesCreated++;
+    void *imageView = CreateHandle();
+    imageViews[imageView] = imageViewCI;
+    return imageView;
+}
+
+void GraphicsAPI_Null::DestroyImageView(void *&imageView) {
+    if (!Validate(imageViews, imageView, "DestroyImageView", "imageView")) {
+        return;
+    }
+    statistics.resourcesDestroyed++;
+    imageViews.erase(imageView);
+    imageView = nullptr;
+}
+
+void *GraphicsAPI_Null::CreateSampler(const SamplerCreateInfo &samplerCI) {
+    statistics.resourcesCreated++;
+    void *sampler = CreateHandle();
+    samplers[sampler] = samplerCI;
+    return sampler;
+}
+
+void GraphicsAPI_Null::DestroySampler(void *&sampler) {
+    if (!Validate(samplers, sampler, "DestroySampler", "sampler")) {
+        return;
+    }
+    statistics.resourcesDestroyed++;
+    samplers.erase(sampler);
+    sampler = nullptr;
+}
+
+void *GraphicsAPI_Null::CreateBuffer(const BufferCreateInfo &bufferCI) {
+    statistics.resourcesCreated++;
+    void *buffer = CreateHandle();
+    std::vector<uint8_t> &bufferData = buffers[buffer].second;
+    buffers[buffer].first = bufferCI;
+    bufferData.resize(bufferCI.size);
+    if (bufferCI.data) {
+        memcpy(bufferData.data(), bufferCI.data, bufferCI.size);
+        statistics.bytesUploaded += bufferCI.size;
+    }
+    return buffer;
+}
+
+void GraphicsAPI_Null::DestroyBuffer(void *&buffer) {
+    if (!Validate(buffers, buffer, "DestroyBuffer", "buffer")) {
+        return;
+    }
+    statistics.resourcesDestroyed++;
+    buffers.erase(buffer);
+    buffer = nullptr;
+}
+
+void *GraphicsAPI_Null::CreateShader(const ShaderCreateInfo &shaderCI) {
+    // There is nothing to compile, so the source isn't needed.
+    statistics.resourcesCreated++;
+    void *shader = CreateHandle();
+    shaders[shader] = {shaderCI.type, nullptr, 0};
+    return shader;
+}
+
+void GraphicsAPI_Null::DestroyShader(void *&shader) {
+    if (!Validate(shaders, shader, "DestroyShader", "shader")) {
+        return;
+    }
+    statistics.resourcesDestroyed++;
+    shaders.erase(shader);
+    shader = nullptr;
+}
+
+void *GraphicsAPI_Null::CreatePipeline(const PipelineCreateInfo &pipelineCI) {
+    for (void *shader : pipelineCI.shaders) {
+        Validate(shaders, shader, "CreatePipeline", "shader");
+    }
+    statistics.resourcesCreated++;
+    void *pipeline = CreateHandle();
+    pipelines[pipeline] = pipelineCI;
+    return pipeline;
+}
+
+void GraphicsAPI_Null::DestroyPipeline(void *&pipeline) {
+    if (!Validate(pipelines, pipeline, "DestroyPipeline", "pipeline")) {
+        return;
+    }
+    statistics.resourcesDestroyed++;
+    pipelines.erase(pipeline);
+    if (setPipeline == pipeline) {
+        setPipeline = nullptr;
+    }
+    pipeline = nullptr;
+}
+
+void GraphicsAPI_Null::BeginRendering() {
+    if (validate && inRendering) {
+        ValidationError("BeginRendering", "EndRendering() was not called for the previous BeginRendering().");
+    }
+    inRendering = true;
+    renderAttachmentsSet = false;
+    setPipeline = nullptr;
+    setIndexBuffer = nullptr;
+    setVertexBuffers.clear();
+
+    commandStream.clear();
+    RecordCommand(CommandType::BEGIN_RENDERING, nullptr, 0);
+}
+
+void GraphicsAPI_Null::EndRendering() {
+    if (validate && !inRendering) {
+        ValidationError("EndRendering", "BeginRendering() was not called.");
+    }
+    inRendering = false;
+    RecordCommand(CommandType::END_RENDERING, nullptr, 0);
+}
+
+void GraphicsAPI_Null::SetBufferData(void *buffer, size_t offset, size_t size, void *data) {
+    if (!Validate(buffers, buffer, "SetBufferData", "buffer")) {
+        return;
+    }
+    std::vector<uint8_t> &bufferData = buffers[buffer].second;
+    if (offset + size > bufferData.size()) {
+        if (validate) {
+            ValidationError("SetBufferData", "offset + size exceeds the size of the buffer.");
+        }
+        return;
+    }
+    if (data) {
+        memcpy(bufferData.data() + offset, data, size);
+        statistics.bytesUploaded += size;
+    }
+
+    struct {
+        void *buffer;
+        size_t offset;
+        size_t size;
+    } args = {buffer, offset, size};
+    RecordCommand(CommandType::SET_BUFFER_DATA, args);
+}
+
+void GraphicsAPI_Null::ClearColor(void *imageView, float r, float g, float b, float a) {
+    Validate(imageViews, imageView, "ClearColor", "imageView");
+    struct {
+        void *imageView;
+        float color[4];
+    } args = {imageView, {r, g, b, a}};
+    RecordCommand(CommandType::CLEAR_COLOR, args);
+}
+
+void GraphicsAPI_Null::ClearDepth(void *imageView, float d) {
+    Validate(imageViews, imageView, "ClearDepth", "imageView");
+    struct {
+        void *imageView;
+        float depth;
+    } args = {imageView, d};
+    RecordCommand(CommandType::CLEAR_DEPTH, args);
+}
+
+void GraphicsAPI_Null::SetRenderAttachments(void **colorViews, size_t colorViewCount, void *depthStencilView, uint32_t width, uint32_t height, void *pipeline) {
+    std::vector<void *> args = {depthStencilView, (void *)(uint64_t)width, (void *)(uint64_t)height, pipeline};
+    for (size_t i = 0; i < colorViewCount; i++) {
+        Validate(imageViews, colorViews[i], "SetRenderAttachments", "colorView");
+        args.push_back(colorViews[i]);
+    }
+    if (depthStencilView) {
+        Validate(imageViews, depthStencilView, "SetRenderAttachments", "depthStencilView");
+    }
+    renderAttachmentsSet = true;
+    RecordCommand(CommandType::SET_RENDER_ATTACHMENTS, args.data(), args.size() * sizeof(void *));
+}
+
+void GraphicsAPI_Null::SetViewports(Viewport *viewports, size_t count) {
+    RecordCommand(CommandType::SET_VIEWPORTS, viewports, count * sizeof(Viewport));
+}
+
+void GraphicsAPI_Null::SetScissors(Rect2D *scissors, size_t count) {
+    RecordCommand(CommandType::SET_SCISSORS, scissors, count * sizeof(Rect2D));
+}
+
+void GraphicsAPI_Null::SetPipeline(void *pipeline) {
+    Validate(pipelines, pipeline, "SetPipeline", "pipeline");
+    setPipeline = pipeline;
+    RecordCommand(CommandType::SET_PIPELINE, pipeline);
+}
+
+void GraphicsAPI_Null::SetDescriptor(const DescriptorInfo &descriptorInfo) {
+    if (validate) {
+        if (descriptorInfo.type == DescriptorInfo::Type::BUFFER) {
+            if (Validate(buffers, descriptorInfo.resource, "SetDescriptor", "buffer")) {
+                const std::vector<uint8_t> &bufferData = buffers[descriptorInfo.resource].second;
+                size_t bufferSize = descriptorInfo.bufferSize ? descriptorInfo.bufferSize : bufferData.size();
+                if (descriptorInfo.bufferOffset + bufferSize > bufferData.size()) {
+                    ValidationError("SetDescriptor", "bufferOffset + bufferSize exceeds the size of the buffer.");
+                }
+            }
+        } else if (descriptorInfo.type == DescriptorInfo::Type::IMAGE) {
+            Validate(imageViews, descriptorInfo.resource, "SetDescriptor", "imageView");
+        } else if (descriptorInfo.type == DescriptorInfo::Type::SAMPLER) {
+            Validate(samplers, descriptorInfo.resource, "SetDescriptor", "sampler");
+        }
+
+        if (!setPipeline) {
+            ValidationError("SetDescriptor", "No pipeline is set.");
+        } else {
+            const std::vector<DescriptorInfo> &layout = pipelines[setPipeline].layout;
+            bool found = std::any_of(layout.begin(), layout.end(), [&](const DescriptorInfo &descriptor) {
+                return descriptor.bindingIndex == descriptorInfo.bindingIndex && descriptor.type == descriptorInfo.type && descriptor.stage == descriptorInfo.stage;
+            });
+            if (!found) {
+                ValidationError("SetDescriptor", "bindingIndex " + std::to_string(descriptorInfo.bindingIndex) + " is not in the pipeline's layout.");
+            }
+        }
+    }
+    RecordCommand(CommandType::SET_DESCRIPTOR, descriptorInfo);
+}
+
+void GraphicsAPI_Null::UpdateDescriptors() {
+    RecordCommand(CommandType::UPDATE_DESCRIPTORS, nullptr, 0);
+}
+
+void GraphicsAPI_Null::SetVertexBuffers(void **vertexBuffers, size_t count, const size_t *offsets) {
+    std::vector<size_t> args;
+    setVertexBuffers.assign(vertexBuffers, vertexBuffers + count);
+    for (size_t i = 0; i < count; i++) {
+        if (Validate(buffers, vertexBuffers[i], "SetVertexBuffers", "vertexBuffer") && validate) {
+            if (buffers[vertexBuffers[i]].first.type != BufferCreateInfo::Type::VERTEX) {
+                ValidationError("SetVertexBuffers", "Provided buffer is not type: VERTEX.");
+            }
+        }
+        args.push_back((size_t)vertexBuffers[i]);
+        args.push_back(offsets ? offsets[i] : 0);
+    }
+    RecordCommand(CommandType::SET_VERTEX_BUFFERS, args.data(), args.size() * sizeof(size_t));
+}
+
+void GraphicsAPI_Null::SetIndexBuffer(void *indexBuffer) {
+    if (Validate(buffers, indexBuffer, "SetIndexBuffer", "indexBuffer") && validate) {
+        if (buffers[indexBuffer].first.type != BufferCreateInfo::Type::INDEX) {
+            ValidationError("SetIndexBuffer", "Provided buffer is not type: INDEX.");
+        }
+    }
+    setIndexBuffer = indexBuffer;
+    RecordCommand(CommandType::SET_INDEX_BUFFER, indexBuffer);
+}
+
+void GraphicsAPI_Null::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {
+    if (validate) {
+        if (!inRendering || !renderAttachmentsSet || !setPipeline) {
+            ValidationError("DrawIndexed", "Draws must be between BeginRendering() and EndRendering(), after SetRenderAttachments() and SetPipeline().");
+        }
+        if (!setIndexBuffer) {
+            ValidationError("DrawIndexed", "No index buffer is set.");
+        } else {
+            const BufferCreateInfo &bufferCI = buffers[setIndexBuffer].first;
+            if ((uint64_t)(firstIndex + indexCount) * bufferCI.stride > bufferCI.size) {
+                ValidationError("DrawIndexed", "firstIndex + indexCount exceeds the size of the index buffer.");
+            }
+        }
+    }
+    statistics.verticesDrawn += (uint64_t)indexCount * instanceCount;
+
+    struct {
+        uint32_t indexCount;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t vertexOffset;
+        uint32_t firstInstance;
+    } args = {indexCount, instanceCount, firstIndex, vertexOffset, firstInstance};
+    RecordCommand(CommandType::DRAW_INDEXED, args);
+}
+
+void GraphicsAPI_Null::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) {
+    if (validate) {
+        if (!inRendering || !renderAttachmentsSet || !setPipeline) {
+            ValidationError("Draw", "Draws must be between BeginRendering() and EndRendering(), after SetRenderAttachments() and SetPipeline().");
+        }
+    }
+    statistics.verticesDrawn += (uint64_t)vertexCount * instanceCount;
+
+    struct {
+        uint32_t vertexCount;
+        uint32_t instanceCount;
+        uint32_t firstVertex;
+        uint32_t firstInstance;
+    } args = {vertexCount, instanceCount, firstVertex, firstInstance};
+    RecordCommand(CommandType::DRAW, args);
+}
+
+const std::vector<int64_t> GraphicsAPI_Null::GetSupportedColorSwapchainFormats() {
+    return {COLOR_FORMAT_R8G8B8A8_SRGB, COLOR_FORMAT_B8G8R8A8_SRGB};
+}
+
+const std::vector<int64_t> GraphicsAPI_Null::GetSupportedDepthSwapchainFormats() {
+    return {DEPTH_FORMAT_D32_SFLOAT, DEPTH_FORMAT_D16_UNORM};
+}
+
+void GraphicsAPI_Null::RecordCommand(CommandType type, const void *args, size_t size) {
+    CommandHeader header = {type, (uint32_t)size};
+    const uint8_t *headerBytes = reinterpret_cast<const uint8_t *>(&header);
+    commandStream.insert(commandStream.end(), headerBytes, headerBytes + sizeof(CommandHeader));
+    if (size > 0) {
+        const uint8_t *argsBytes = reinterpret_cast<const uint8_t *>(args);
+        commandStream.insert(commandStream.end(), argsBytes, argsBytes + size);
+    }
+
+    statistics.commandCounts[(size_t)type]++;
+    statistics.bytesRecorded += sizeof(CommandHeader) + size;
+}
+
+template <typename T>
+bool GraphicsAPI_Null::Validate(const std::unordered_map<void *, T> &resources, void *resource, const char *function, const char *name) {
+    if (!validate) {
+        return true;
+    }
+    if (resources.find(resource) == resources.end()) {
+        ValidationError(function, std::string("Unknown ") + name + ".");
+        return false;
+    }
+    return true;
+}
+
+void GraphicsAPI_Null::ValidationError(const char *function, const std::string &message) {
+    statistics.validationErrors++;
+    std::cout << "ERROR: NULL: " << function << ": " << message << std::endl;
+}
@@ -0,0 +1,166 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+#pragma once
+#include <GraphicsAPI.h>
+
+// A GraphicsAPI that has no GPU behind it. Resources are kept in host memory and the rendering calls are recorded
+// into an in-memory command stream, so the CPU cost of the application's rendering code can be measured on machines
+// without a GPU. With validation enabled, it also reports API misuse that the real backends might silently accept.
+class GraphicsAPI_Null : public GraphicsAPI {
+public:
+    GraphicsAPI_Null(bool validate = false);
+    GraphicsAPI_Null(XrInstance m_xrInstance, XrSystemId systemId, bool validate = false);
+    ~GraphicsAPI_Null();
+
+    virtual void* CreateDesktopSwapchain(const SwapchainCreateInfo& swapchainCI) override;
+    virtual void DestroyDesktopSwapchain(void*& swapchain) override;
+    virtual void* GetDesktopSwapchainImage(void* swapchain, uint32_t index) override;
+    virtual void AcquireDesktopSwapchanImage(void* swapchain, uint32_t& index) override;
+    virtual void PresentDesktopSwapchainImage(void* swapchain, uint32_t index) override;
+
+    virtual int64_t GetDepthFormat() override { return DEPTH_FORMAT_D32_SFLOAT; }
+
+    // There is no graphics binding, so an XrSession can only be created with XR_MND_headless.
+    virtual void* GetGraphicsBinding() override { return nullptr; }
+    virtual XrSwapchainImageBaseHeader* AllocateSwapchainImageData(XrSwapchain swapchain, SwapchainType type, uint32_t count) override;
+    virtual void FreeSwapchainImageData(XrSwapchain swapchain) override;
+    virtual XrSwapchainImageBaseHeader* GetSwapchainImageData(XrSwapchain swapchain, uint32_t index) override { return (XrSwapchainImageBaseHeader*)&swapchainImagesMap[swapchain].second[index]; }
+    virtual void* GetSwapchainImage(XrSwapchain swapchain, uint32_t index) override { return swapchainImagesMap[swapchain].second[index].image; }
+
+    virtual void* CreateImage(const ImageCreateInfo& imageCI) override;
+    virtual void DestroyImage(void*& image) override;
+
+    virtual void* CreateImageView(const ImageViewCreateInfo& imageViewCI) override;
+    virtual void DestroyImageView(void*& imageView) override;
+
+    virtual void* CreateSampler(const SamplerCreateInfo& samplerCI) override;
+    virtual void DestroySampler(void*& sampler) override;
+
+    virtual void* CreateBuffer(const BufferCreateInfo& bufferCI) override;
+    virtual void DestroyBuffer(void*& buffer) override;
+
+    virtual void* CreateShader(const ShaderCreateInfo& shaderCI) override;
+    virtual void DestroyShader(void*& shader) override;
+
+    virtual void* CreatePipeline(const PipelineCreateInfo& pipelineCI) override;
+    virtual void DestroyPipeline(void*& pipeline) override;
+
+    virtual void BeginRendering() override;
+    virtual void EndRendering() override;
+
+    virtual void SetBufferData(void* buffer, size_t offset, size_t size, void* data) override;
+
+    virtual void ClearColor(void* imageView, float r, float g, float b, float a) override;
+    virtual void ClearDepth(void* imageView, float d) override;
+
+    virtual void SetRenderAttachments(void** colorViews, size_t colorViewCount, void* depthStencilView, uint32_t width, uint32_t height, void* pipeline) override;
+    virtual void SetViewports(Viewport* viewports, size_t count) override;
+    virtual void SetScissors(Rect2D* scissors, size_t count) override;
+
+    virtual void SetPipeline(void* pipeline) override;
+    virtual void SetDescriptor(const DescriptorInfo& descriptorInfo) override;
+    virtual void UpdateDescriptors() override;
+    virtual void SetVertexBuffers(void** vertexBuffers, size_t count, const size_t* offsets = nullptr) override;
+    virtual void SetIndexBuffer(void* indexBuffer) override;
+    virtual void DrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0) override;
+    virtual void Draw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0) override;
+
+    // Formats have no meaning without a GPU. These values are only matched against the formats offered by the runtime.
+    enum Format : int64_t {
+        COLOR_FORMAT_R8G8B8A8_SRGB = 1,
+        COLOR_FORMAT_B8G8R8A8_SRGB,
+        DEPTH_FORMAT_D32_SFLOAT,
+        DEPTH_FORMAT_D16_UNORM
+    };
+
+    enum class CommandType : uint8_t {
+        BEGIN_RENDERING,
+        END_RENDERING,
+        SET_BUFFER_DATA,
+        CLEAR_COLOR,
+        CLEAR_DEPTH,
+        SET_RENDER_ATTACHMENTS,
+        SET_VIEWPORTS,
+        SET_SCISSORS,
+        SET_PIPELINE,
+        SET_DESCRIPTOR,
+        UPDATE_DESCRIPTORS,
+        SET_VERTEX_BUFFERS,
+        SET_INDEX_BUFFER,
+        DRAW_INDEXED,
+        DRAW,
+        COUNT
+    };
+    // Each command in the stream is a CommandHeader followed by size bytes of arguments.
+    struct CommandHeader {
+        CommandType type;
+        uint32_t size;
+    };
+
+    struct Statistics {
+        uint64_t commandCounts[(size_t)CommandType::COUNT] = {};
+        uint64_t resourcesCreated = 0;
+        uint64_t resourcesDestroyed = 0;
+        uint64_t bytesUploaded = 0;  // Through CreateBuffer() and SetBufferData().
+        uint64_t bytesRecorded = 0;  // Into the command stream.
+        uint64_t verticesDrawn = 0;  // Vertex or index count multiplied by the instance count.
+        uint64_t validationErrors = 0;
+    };
+    // Statistics are accumulated since construction or the last ResetStatistics().
+    const Statistics& GetStatistics() const { return statistics; }
+    void ResetStatistics() { statistics = {}; }
+    // Commands recorded since the last BeginRendering().
+    const std::vector<uint8_t>& GetCommandStream() const { return commandStream; }
+
+private:
+    virtual const std::vector<int64_t> GetSupportedColorSwapchainFormats() override;
+    virtual const std::vector<int64_t> GetSupportedDepthSwapchainFormats() override;
+
+    void* CreateHandle() { return (void*)(uint64_t)(++nextHandle); }
+    template <typename T>
+    void RecordCommand(CommandType type, const T& args) { RecordCommand(type, &args, sizeof(T)); }
+    void RecordCommand(CommandType type, const void* args, size_t size);
+    template <typename T>
+    bool Validate(const std::unordered_map<void*, T>& resources, void* resource, const char* function, const char* name);
+    void ValidationError(const char* function, const std::string& message);
+
+private:
+    bool validate = false;
+    uint64_t nextHandle = 0;
+
+    // Stands in for the runtime specific XrSwapchainImage*KHR structures.
+    struct SwapchainImage {
+        XrStructureType type;
+        void* next;
+        void* image;
+    };
+    std::unordered_map<XrSwapchain, std::pair<SwapchainType, std::vector<SwapchainImage>>> swapchainImagesMap{};
+
+    struct DesktopSwapchain {
+        SwapchainCreateInfo swapchainCI;
+        std::vector<void*> images;
+        uint32_t index = 0;
+    };
+    std::unordered_map<void*, DesktopSwapchain> desktopSwapchains{};
+
+    std::unordered_map<void*, ImageCreateInfo> images{};
+    std::unordered_map<void*, ImageViewCreateInfo> imageViews{};
+    std::unordered_map<void*, SamplerCreateInfo> samplers{};
+    std::unordered_map<void*, std::pair<BufferCreateInfo, std::vector<uint8_t>>> buffers{};
+    std::unordered_map<void*, ShaderCreateInfo> shaders{};
+    std::unordered_map<void*, PipelineCreateInfo> pipelines{};
+
+    std::vector<uint8_t> commandStream{};
+    Statistics statistics{};
+
+    // State used for validation.
+    bool inRendering = false;
+    bool renderAttachmentsSet = false;
+    void* setPipeline = nullptr;
+    void* setIndexBuffer = nullptr;
+    std::vector<void*> setVertexBuffers{};
+};
@@ -416,6 +416,22 @@ GraphicsAPI_OpenGL::GraphicsAPI_OpenGL(XrInstance m_xrInstance, XrSystemId syste
 }
 
 GraphicsAPI_OpenGL::~GraphicsAPI_OpenGL() {
+    DestroyTransientBuffers();
+
+    std::cout << "OPENGL: Framebuffer cache: " << framebufferCache.size() << " framebuffers, " << framebufferCacheStatistics.hits << " hits, "
+              << framebufferCacheStatistics.misses << " misses." << std::endl;
+    std::cout << "OPENGL: VertexArray cache: " << vertexArrayCache.size() << " vertex arrays, " << vertexArrayCacheStatistics.hits << " hits, "
+              << vertexArrayCacheStatistics.misses << " misses." << std::endl;
+    for (auto &framebuffer : framebufferCache) {
+        glDeleteFramebuffers(1, &framebuffer.second);
+    }
+    for (auto &vertexArray : vertexArrayCache) {
+        glDeleteVertexArrays(1, &vertexArray.second.vertexArray);
+    }
+    for (TimestampFrame &timestampFrame : timestampFrames) {
+        glDeleteQueries(static_cast<GLsizei>(timestampFrame.queries.size()), timestampFrame.queries.data());
+    }
+
     ksGpuWindow_Destroy(&window);
 }
 // XR_DOCS_TAG_END_GraphicsAPI_OpenGL
@@ -545,6 +561,7 @@ void *GraphicsAPI_OpenGL::CreateImageView(const ImageViewCreateInfo &imageViewCI
 
 void GraphicsAPI_OpenGL::DestroyImageView(void *&imageView) {
     GLuint framebuffer = (GLuint)(uint64_t)imageView;
+    DestroyCachedFramebuffers(framebuffer);
     imageViews.erase(framebuffer);
     glDeleteFramebuffers(1, &framebuffer);
     imageView = nullptr;
@@ -609,8 +626,20 @@ void *GraphicsAPI_OpenGL::CreateBuffer(const BufferCreateInfo &bufferCI) {
         std::cout << "ERROR: OPENGL: Unknown Buffer Type." << std::endl;
     }
 
+    if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        // The GL_ELEMENT_ARRAY_BUFFER binding is part of the bound VertexArray's state.
+        glBindVertexArray(0);
+        setVertexArray = 0;
+    }
     glBindBuffer(target, buffer);
-    glBufferData(target, (GLsizeiptr)bufferCI.size, bufferCI.data, GL_STATIC_DRAW);
+    // The usage is a hint to the driver about where to place the buffer's storage.
+    GLenum usage = GL_DYNAMIC_DRAW;
+    if (bufferCI.usage == BufferCreateInfo::Usage::STATIC) {
+        usage = GL_STATIC_DRAW;
+    } else if (bufferCI.usage == BufferCreateInfo::Usage::STREAM) {
+        usage = GL_STREAM_DRAW;
+    }
+    glBufferData(target, (GLsizeiptr)bufferCI.size, bufferCI.data, usage);
     glBindBuffer(target, 0);
 
     buffers[buffer] = bufferCI;
@@ -619,6 +648,7 @@ void *GraphicsAPI_OpenGL::CreateBuffer(const BufferCreateInfo &bufferCI) {
 
 void GraphicsAPI_OpenGL::DestroyBuffer(void *&buffer) {
     GLuint glBuffer = (GLuint)(uint64_t)buffer;
+    DestroyCachedVertexArrays(glBuffer);
     buffers.erase(glBuffer);
     glDeleteBuffers(1, &glBuffer);
     buffer = nullptr;
@@ -656,7 +686,9 @@ void *GraphicsAPI_OpenGL::CreateShader(const ShaderCreateInfo &shaderCI) {
     }
     GLuint shader = glCreateShader(type);
 
-    glShaderSource(shader, 1, &shaderCI.sourceData, nullptr);
+    // The source may be a view of a file, which isn't null terminated.
+    GLint sourceLength = static_cast<GLint>(shaderCI.sourceSize);
+    glShaderSource(shader, 1, &shaderCI.sourceData, &sourceLength);
     glCompileShader(shader);
 
     GLint isCompiled = 0;
@@ -722,22 +754,71 @@ void GraphicsAPI_OpenGL::DestroyPipeline(void *&pipeline) {
     pipeline = nullptr;
 }
 
+// GL_OVR_multiview2 lets the vertex shader use gl_ViewID_OVR for more than the position. Multiview framebuffers are made
+// from TYPE_2D_ARRAY image views, and the shaders declare the view count, so PipelineCreateInfo::viewMask isn't needed.
+bool GraphicsAPI_OpenGL::SupportsMultiview() const {
+    PFNGLGETSTRINGIPROC glGetStringi = (PFNGLGETSTRINGIPROC)GetExtension("glGetStringi");  // 3.0+
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; i++) {
+        if (strcmp((const char *)glGetStringi(GL_EXTENSIONS, i), "GL_OVR_multiview2") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void GraphicsAPI_OpenGL::BeginRendering() {
-    glGenVertexArrays(1, &vertexArray);
-    glBindVertexArray(vertexArray);
+    stateCache.clear();
 
-    glGenFramebuffers(1, &setFramebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, setFramebuffer);
+    if (timestampFrames.empty()) {
+        timestampFrames.resize(4);
+        for (TimestampFrame &timestampFrame : timestampFrames) {
+            timestampFrame.queries.resize(timestampFrame.querySet.capacity);
+            glGenQueries(static_cast<GLsizei>(timestampFrame.queries.size()), timestampFrame.queries.data());
+        }
+    }
+
+    // Read back the submissions that the GPU has finished, oldest first. Timestamps complete in order, so the last
+    // query being available means that the others are too.
+    for (size_t i = 1; i <= timestampFrames.size(); i++) {
+        TimestampFrame &timestampFrame = timestampFrames[(timestampFrameIndex + i) % timestampFrames.size()];
+        TimestampQuerySet &querySet = timestampFrame.querySet;
+        if (!querySet.pending) {
+            continue;
+        }
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(timestampFrame.queries[querySet.count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            for (uint32_t query = 0; query < querySet.count; query++) {
+                glGetQueryObjectui64v(timestampFrame.queries[query], GL_QUERY_RESULT, &querySet.timestamps[query]);
+            }
+            // GL_TIMESTAMP is in nanoseconds.
+            ResolveTimestampQueries(querySet, 1.0, UINT64_MAX);
+        }
+    }
+    timestampFrameIndex = (timestampFrameIndex + 1) % timestampFrames.size();
+    ResetTimestampQuerySet(timestampFrames[timestampFrameIndex].querySet);
 }
 
 void GraphicsAPI_OpenGL::EndRendering() {
+    // Close any scopes left open, so every query in the submission is written.
+    if (!timestampFrames.empty()) {
+        TimestampQuerySet &querySet = timestampFrames[timestampFrameIndex].querySet;
+        while (!querySet.openScopes.empty()) {
+            EndTimestampScope();
+        }
+        querySet.pending = querySet.count > 0;
+    }
+
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glDeleteFramebuffers(1, &setFramebuffer);
     setFramebuffer = 0;
 
     glBindVertexArray(0);
-    glDeleteVertexArrays(1, &vertexArray);
-    vertexArray = 0;
+    setVertexArray = 0;
+    setVertexBuffers.clear();
+    setVertexBufferOffsets.clear();
+    setIndexBuffer = 0;
 }
 
 void GraphicsAPI_OpenGL::SetBufferData(void *buffer, size_t offset, size_t size, void *data) {
@@ -757,12 +838,39 @@ void GraphicsAPI_OpenGL::SetBufferData(void *buffer, size_t offset, size_t size,
     }
 
     if (data) {
+        if (target == GL_ELEMENT_ARRAY_BUFFER) {
+            // The GL_ELEMENT_ARRAY_BUFFER binding is part of the bound VertexArray's state.
+            glBindVertexArray(0);
+            setVertexArray = 0;
+        }
         glBindBuffer(target, glBuffer);
         glBufferSubData(target, (GLintptr)offset, (GLsizeiptr)size, data);
         glBindBuffer(target, 0);
     }
 }
 
+void GraphicsAPI_OpenGL::BeginTimestampScope(const std::string &name) {
+    if (timestampFrames.empty()) {
+        return;
+    }
+    TimestampFrame &timestampFrame = timestampFrames[timestampFrameIndex];
+    uint32_t query = 0;
+    if (BeginTimestampQuery(timestampFrame.querySet, name, query)) {
+        glQueryCounter(timestampFrame.queries[query], GL_TIMESTAMP);
+    }
+}
+
+void GraphicsAPI_OpenGL::EndTimestampScope() {
+    if (timestampFrames.empty()) {
+        return;
+    }
+    TimestampFrame &timestampFrame = timestampFrames[timestampFrameIndex];
+    uint32_t query = 0;
+    if (EndTimestampQuery(timestampFrame.querySet, query)) {
+        glQueryCounter(timestampFrame.queries[query], GL_TIMESTAMP);
+    }
+}
+
 void GraphicsAPI_OpenGL::ClearColor(void *imageView, float r, float g, float b, float a) {
     glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)(uint64_t)imageView);
     glClearColor(r, g, b, a);
@@ -778,10 +886,21 @@ void GraphicsAPI_OpenGL::ClearDepth(void *imageView, float d) {
 }
 
 void GraphicsAPI_OpenGL::SetRenderAttachments(void **colorViews, size_t colorViewCount, void *depthStencilView, uint32_t width, uint32_t height, void *pipeline) {
-    // Reset Framebuffer
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glDeleteFramebuffers(1, &setFramebuffer);
-    setFramebuffer = 0;
+    // Find or create a Framebuffer for this set of attachments.
+    std::vector<uint64_t> key = {(uint64_t)colorViewCount};
+    for (size_t i = 0; i < colorViewCount; i++) {
+        key.push_back((uint64_t)colorViews[i]);
+    }
+    key.push_back((uint64_t)depthStencilView);
+
+    auto it = framebufferCache.find(key);
+    if (it != framebufferCache.end()) {
+        framebufferCacheStatistics.hits++;
+        setFramebuffer = it->second;
+        glBindFramebuffer(GL_FRAMEBUFFER, setFramebuffer);
+        return;
+    }
+    framebufferCacheStatistics.misses++;
 
     glGenFramebuffers(1, &setFramebuffer);
     glBindFramebuffer(GL_FRAMEBUFFER, setFramebuffer);
@@ -822,6 +941,25 @@ void GraphicsAPI_OpenGL::SetRenderAttachments(void **colorViews, size_t colorVie
         DEBUG_BREAK;
         std::cout << "ERROR: OPENGL: Framebuffer is not complete." << std::endl;
     }
+
+    framebufferCache[key] = setFramebuffer;
+}
+
+void GraphicsAPI_OpenGL::DestroyCachedFramebuffers(GLuint imageView) {
+    // Key layout is {colorViewCount, colorViews..., depthStencilView}.
+    for (auto it = framebufferCache.begin(); it != framebufferCache.end();) {
+        const std::vector<uint64_t> &key = it->first;
+        if (std::find(key.begin() + 1, key.end(), (uint64_t)imageView) != key.end()) {
+            if (setFramebuffer == it->second) {
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                setFramebuffer = 0;
+            }
+            glDeleteFramebuffers(1, &it->second);
+            it = framebufferCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
 }
 
 void GraphicsAPI_OpenGL::SetViewports(Viewport *viewports, size_t count) {
@@ -846,46 +984,40 @@ void GraphicsAPI_OpenGL::SetScissors(Rect2D *scissors, size_t count) {
 
 void GraphicsAPI_OpenGL::SetPipeline(void *pipeline) {
     GLuint program = (GLuint)(uint64_t)pipeline;
-    glUseProgram(program);
+    if (StateChanged(GL_CURRENT_PROGRAM, {(double)program})) {
+        glUseProgram(program);
+    }
     setPipeline = program;
 
     const PipelineCreateInfo &pipelineCI = pipelines[program];
 
     // InputAssemblyState
     const InputAssemblyState &IAS = pipelineCI.inputAssemblyState;
-    if (IAS.primitiveRestartEnable) {
-        glEnable(GL_PRIMITIVE_RESTART);
-    } else {
-        glDisable(GL_PRIMITIVE_RESTART);
-    }
+    SetCapability(GL_PRIMITIVE_RESTART, IAS.primitiveRestartEnable);
 
     // RasterisationState
     const RasterisationState &RS = pipelineCI.rasterisationState;
 
-    if (RS.depthClampEnable) {
-        glEnable(GL_DEPTH_CLAMP);
-    } else {
-        glDisable(GL_DEPTH_CLAMP);
-    }
-
-    if (RS.rasteriserDiscardEnable) {
-        glEnable(GL_RASTERIZER_DISCARD);
-    } else {
-        glDisable(GL_RASTERIZER_DISCARD);
-    }
+    SetCapability(GL_DEPTH_CLAMP, RS.depthClampEnable);
+    SetCapability(GL_RASTERIZER_DISCARD, RS.rasteriserDiscardEnable);
 
     if (RS.cullMode == CullMode::FRONT_AND_BACK) {
-        glPolygonMode(GL_FRONT_AND_BACK, ToGLPolygonMode(RS.polygonMode));
+        if (StateChanged(GL_POLYGON_MODE, {(double)ToGLPolygonMode(RS.polygonMode)})) {
+            glPolygonMode(GL_FRONT_AND_BACK, ToGLPolygonMode(RS.polygonMode));
+        }
     }
 
+    SetCapability(GL_CULL_FACE, RS.cullMode > CullMode::NONE);
     if (RS.cullMode > CullMode::NONE) {
-        glEnable(GL_CULL_FACE);
-        glCullFace(ToGLCullMode(RS.cullMode));
-    } else {
-        glDisable(GL_CULL_FACE);
+        if (StateChanged(GL_CULL_FACE_MODE, {(double)ToGLCullMode(RS.cullMode)})) {
+            glCullFace(ToGLCullMode(RS.cullMode));
+        }
     }
 
-    glFrontFace(RS.frontFace == FrontFace::COUNTER_CLOCKWISE ? GL_CCW : GL_CW);
+    GLenum frontFace = RS.frontFace == FrontFace::COUNTER_CLOCKWISE ? GL_CCW : GL_CW;
+    if (StateChanged(GL_FRONT_FACE, {(double)frontFace})) {
+        glFrontFace(frontFace);
+    }
 
     GLenum polygonOffsetMode = 0;
     switch (RS.polygonMode) {
@@ -903,146 +1035,168 @@ void GraphicsAPI_OpenGL::SetPipeline(void *pipeline) {
         break;
     }
     }
+    SetCapability(polygonOffsetMode, RS.depthBiasEnable);
     if (RS.depthBiasEnable) {
-        glEnable(polygonOffsetMode);
         // glPolygonOffsetClamp
-        glPolygonOffset(RS.depthBiasSlopeFactor, RS.depthBiasConstantFactor);
-    } else {
-        glDisable(polygonOffsetMode);
+        if (StateChanged(GL_POLYGON_OFFSET_FACTOR, {RS.depthBiasSlopeFactor, RS.depthBiasConstantFactor})) {
+            glPolygonOffset(RS.depthBiasSlopeFactor, RS.depthBiasConstantFactor);
+        }
     }
 
-    glLineWidth(RS.lineWidth);
+    if (StateChanged(GL_LINE_WIDTH, {RS.lineWidth})) {
+        glLineWidth(RS.lineWidth);
+    }
 
     // MultisampleState
     const MultisampleState &MS = pipelineCI.multisampleState;
 
-    if (MS.rasterisationSamples > 1) {
-        glEnable(GL_MULTISAMPLE);
-    } else {
-        glDisable(GL_MULTISAMPLE);
-    }
+    SetCapability(GL_MULTISAMPLE, MS.rasterisationSamples > 1);
 
+    SetCapability(GL_SAMPLE_SHADING, MS.sampleShadingEnable);
     if (MS.sampleShadingEnable) {
-        glEnable(GL_SAMPLE_SHADING);
-        PFNGLMINSAMPLESHADINGPROC glMinSampleShading = (PFNGLMINSAMPLESHADINGPROC)GetExtension("glMinSampleShading");  // 4.0+
-        glMinSampleShading(MS.minSampleShading);
-    } else {
-        glDisable(GL_SAMPLE_SHADING);
+        if (StateChanged(GL_MIN_SAMPLE_SHADING_VALUE, {MS.minSampleShading})) {
+            PFNGLMINSAMPLESHADINGPROC glMinSampleShading = (PFNGLMINSAMPLESHADINGPROC)GetExtension("glMinSampleShading");  // 4.0+
+            glMinSampleShading(MS.minSampleShading);
+        }
     }
 
+    SetCapability(GL_SAMPLE_MASK, MS.sampleMask > 0);
     if (MS.sampleMask > 0) {
-        glEnable(GL_SAMPLE_MASK);
-        PFNGLSAMPLEMASKIPROC glSampleMaski = (PFNGLSAMPLEMASKIPROC)GetExtension("glSampleMaski");  // 3.2+
-        glSampleMaski(0, MS.sampleMask);
-    } else {
-        glDisable(GL_SAMPLE_MASK);
-    }
-
-    if (MS.alphaToCoverageEnable) {
-        glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE);
-    } else {
-        glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+        if (StateChanged(GL_SAMPLE_MASK_VALUE, {(double)MS.sampleMask})) {
+            PFNGLSAMPLEMASKIPROC glSampleMaski = (PFNGLSAMPLEMASKIPROC)GetExtension("glSampleMaski");  // 3.2+
+            glSampleMaski(0, MS.sampleMask);
+        }
     }
 
-    if (MS.alphaToOneEnable) {
-        glEnable(GL_SAMPLE_ALPHA_TO_ONE);
-    } else {
-        glDisable(GL_SAMPLE_ALPHA_TO_ONE);
-    }
+    SetCapability(GL_SAMPLE_ALPHA_TO_COVERAGE, MS.alphaToCoverageEnable);
+    SetCapability(GL_SAMPLE_ALPHA_TO_ONE, MS.alphaToOneEnable);
 
     // DepthStencilState
     const DepthStencilState &DSS = pipelineCI.depthStencilState;
 
-    if (DSS.depthTestEnable) {
-        glEnable(GL_DEPTH_TEST);
-    } else {
-        glDisable(GL_DEPTH_TEST);
-    }
+    SetCapability(GL_DEPTH_TEST, DSS.depthTestEnable);
 
-    glDepthMask(DSS.depthWriteEnable ? GL_TRUE : GL_FALSE);
+    if (StateChanged(GL_DEPTH_WRITEMASK, {(double)DSS.depthWriteEnable})) {
+        glDepthMask(DSS.depthWriteEnable ? GL_TRUE : GL_FALSE);
+    }
 
-    glDepthFunc(ToGLCompareOp(DSS.depthCompareOp));
+    if (StateChanged(GL_DEPTH_FUNC, {(double)ToGLCompareOp(DSS.depthCompareOp)})) {
+        glDepthFunc(ToGLCompareOp(DSS.depthCompareOp));
+    }
 
     PFNGLDEPTHBOUNDSEXTPROC glDepthBoundsEXT = (PFNGLDEPTHBOUNDSEXTPROC)GetExtension("glDepthBoundsEXT");  // EXT
     if (glDepthBoundsEXT) {
+        SetCapability(GL_DEPTH_BOUNDS_TEST_EXT, DSS.depthBoundsTestEnable);
         if (DSS.depthBoundsTestEnable) {
-            glEnable(GL_DEPTH_BOUNDS_TEST_EXT);
-            glDepthBoundsEXT(DSS.minDepthBounds, DSS.maxDepthBounds);
-        } else {
-            glDisable(GL_DEPTH_BOUNDS_TEST_EXT);
+            if (StateChanged(GL_DEPTH_BOUNDS_EXT, {DSS.minDepthBounds, DSS.maxDepthBounds})) {
+                glDepthBoundsEXT(DSS.minDepthBounds, DSS.maxDepthBounds);
+            }
         }
     }
 
-    if (DSS.stencilTestEnable) {
-        glEnable(GL_STENCIL_TEST);
-    } else {
-        glDisable(GL_STENCIL_TEST);
-    }
+    SetCapability(GL_STENCIL_TEST, DSS.stencilTestEnable);
 
     PFNGLSTENCILOPSEPARATEPROC glStencilOpSeparate = (PFNGLSTENCILOPSEPARATEPROC)GetExtension("glStencilOpSeparate");          // 2.0+
     PFNGLSTENCILFUNCSEPARATEPROC glStencilFuncSeparate = (PFNGLSTENCILFUNCSEPARATEPROC)GetExtension("glStencilFuncSeparate");  // 2.0+
     PFNGLSTENCILMASKSEPARATEPROC glStencilMaskSeparate = (PFNGLSTENCILMASKSEPARATEPROC)GetExtension("glStencilMaskSeparate");  // 2.0+
 
-    glStencilOpSeparate(GL_FRONT,
-                        ToGLStencilCompareOp(DSS.front.failOp),
-                        ToGLStencilCompareOp(DSS.front.depthFailOp),
-                        ToGLStencilCompareOp(DSS.front.passOp));
-    glStencilFuncSeparate(GL_FRONT,
-                          ToGLCompareOp(DSS.front.compareOp),
-                          DSS.front.reference,
-                          DSS.front.compareMask);
-    glStencilMaskSeparate(GL_FRONT, DSS.front.writeMask);
-
-    glStencilOpSeparate(GL_BACK,
-                        ToGLStencilCompareOp(DSS.back.failOp),
-                        ToGLStencilCompareOp(DSS.back.depthFailOp),
-                        ToGLStencilCompareOp(DSS.back.passOp));
-    glStencilFuncSeparate(GL_BACK,
-                          ToGLCompareOp(DSS.back.compareOp),
-                          DSS.back.reference,
-                          DSS.back.compareMask);
-    glStencilMaskSeparate(GL_BACK, DSS.back.writeMask);
+    auto SetStencilOpState = [&](GLenum face, const StencilOpState &stencil) {
+        bool front = face == GL_FRONT;
+        if (StateChanged(front ? GL_STENCIL_FAIL : GL_STENCIL_BACK_FAIL, {(double)ToGLStencilCompareOp(stencil.failOp), (double)ToGLStencilCompareOp(stencil.depthFailOp), (double)ToGLStencilCompareOp(stencil.passOp)})) {
+            glStencilOpSeparate(face,
+                                ToGLStencilCompareOp(stencil.failOp),
+                                ToGLStencilCompareOp(stencil.depthFailOp),
+                                ToGLStencilCompareOp(stencil.passOp));
+        }
+        if (StateChanged(front ? GL_STENCIL_FUNC : GL_STENCIL_BACK_FUNC, {(double)ToGLCompareOp(stencil.compareOp), (double)stencil.reference, (double)stencil.compareMask})) {
+            glStencilFuncSeparate(face,
+                                  ToGLCompareOp(stencil.compareOp),
+                                  stencil.reference,
+                                  stencil.compareMask);
+        }
+        if (StateChanged(front ? GL_STENCIL_WRITEMASK : GL_STENCIL_BACK_WRITEMASK, {(double)stencil.writeMask})) {
+            glStencilMaskSeparate(face, stencil.writeMask);
+        }
+    };
+    SetStencilOpState(GL_FRONT, DSS.front);
+    SetStencilOpState(GL_BACK, DSS.back);
 
     // ColorBlendState
     const ColorBlendState &CBS = pipelineCI.colorBlendState;
 
+    SetCapability(GL_COLOR_LOGIC_OP, CBS.logicOpEnable);
     if (CBS.logicOpEnable) {
-        glEnable(GL_COLOR_LOGIC_OP);
-        glLogicOp(ToGLLogicOp(CBS.logicOp));
-    } else {
-        glDisable(GL_COLOR_LOGIC_OP);
+        if (StateChanged(GL_LOGIC_OP_MODE, {(double)ToGLLogicOp(CBS.logicOp)})) {
+            glLogicOp(ToGLLogicOp(CBS.logicOp));
+        }
     }
 
     for (int i = 0; i < (int)CBS.attachments.size(); i++) {
         const ColorBlendAttachmentState &CBA = CBS.attachments[i];
 
-        PFNGLENABLEIPROC glEnablei = (PFNGLENABLEIPROC)GetExtension("glEnablei");                                                              // 3.0+
-        PFNGLDISABLEIPROC glDisablei = (PFNGLDISABLEIPROC)GetExtension("glDisablei");                                                          // 3.0+
         PFNGLBLENDEQUATIONSEPARATEIPROC glBlendEquationSeparatei = (PFNGLBLENDEQUATIONSEPARATEIPROC)GetExtension("glBlendEquationSeparatei");  // 4.0+
         PFNGLBLENDFUNCSEPARATEIPROC glBlendFuncSeparatei = (PFNGLBLENDFUNCSEPARATEIPROC)GetExtension("glBlendFuncSeparatei");                  // 4.0+
         PFNGLCOLORMASKIPROC glColorMaski = (PFNGLCOLORMASKIPROC)GetExtension("glColorMaski");                                                  // 3.0+
 
-        if (CBA.blendEnable) {
-            glEnablei(GL_BLEND, i);
-        } else {
-            glDisablei(GL_BLEND, i);
+        SetCapabilityIndexed(GL_BLEND, (GLuint)i, CBA.blendEnable);
+
+        if (StateChanged(GL_BLEND_EQUATION_RGB, {(double)ToGLBlendOp(CBA.colorBlendOp), (double)ToGLBlendOp(CBA.alphaBlendOp)}, (GLuint)i)) {
+            glBlendEquationSeparatei(i, ToGLBlendOp(CBA.colorBlendOp), ToGLBlendOp(CBA.alphaBlendOp));
+        }
+
+        if (StateChanged(GL_BLEND_SRC_RGB, {(double)ToGLBlendFactor(CBA.srcColorBlendFactor), (double)ToGLBlendFactor(CBA.dstColorBlendFactor), (double)ToGLBlendFactor(CBA.srcAlphaBlendFactor), (double)ToGLBlendFactor(CBA.dstAlphaBlendFactor)}, (GLuint)i)) {
+            glBlendFuncSeparatei(i,
+                                 ToGLBlendFactor(CBA.srcColorBlendFactor),
+                                 ToGLBlendFactor(CBA.dstColorBlendFactor),
+                                 ToGLBlendFactor(CBA.srcAlphaBlendFactor),
+                                 ToGLBlendFactor(CBA.dstAlphaBlendFactor));
+        }
+
+        if (StateChanged(GL_COLOR_WRITEMASK, {(double)(uint32_t)CBA.colorWriteMask}, (GLuint)i)) {
+            glColorMaski(i,
+                         (((uint32_t)CBA.colorWriteMask & (uint32_t)ColorComponentBit::R_BIT) == (uint32_t)ColorComponentBit::R_BIT),
+                         (((uint32_t)CBA.colorWriteMask & (uint32_t)ColorComponentBit::G_BIT) == (uint32_t)ColorComponentBit::G_BIT),
+                         (((uint32_t)CBA.colorWriteMask & (uint32_t)ColorComponentBit::B_BIT) == (uint32_t)ColorComponentBit::B_BIT),
+                         (((uint32_t)CBA.colorWriteMask & (uint32_t)ColorComponentBit::A_BIT) == (uint32_t)ColorComponentBit::A_BIT));
         }
+    }
+    if (StateChanged(GL_BLEND_COLOR, {CBS.blendConstants[0], CBS.blendConstants[1], CBS.blendConstants[2], CBS.blendConstants[3]})) {
+        glBlendColor(CBS.blendConstants[0], CBS.blendConstants[1], CBS.blendConstants[2], CBS.blendConstants[3]);
+    }
+}
 
-        glBlendEquationSeparatei(i, ToGLBlendOp(CBA.colorBlendOp), ToGLBlendOp(CBA.alphaBlendOp));
+bool GraphicsAPI_OpenGL::StateChanged(GLenum state, std::initializer_list<double> values, GLuint index) {
+    std::vector<double> &cachedValues = stateCache[((uint64_t)index << 32) | (uint64_t)state];
+    if (cachedValues.size() == values.size() && std::equal(values.begin(), values.end(), cachedValues.begin())) {
+        stateStatistics.elided++;
+        return false;
+    }
+    cachedValues.assign(values);
+    stateStatistics.issued++;
+    return true;
+}
+
+void GraphicsAPI_OpenGL::SetCapability(GLenum capability, bool enable) {
+    if (StateChanged(capability, {(double)enable})) {
+        if (enable) {
+            glEnable(capability);
+        } else {
+            glDisable(capability);
+        }
+    }
+}
 
-        glBlendFuncSeparatei(i,
-                             ToGLBlendFactor(CBA.srcColorBlendFactor),
-                             ToGLBlendFactor(CBA.dstColorBlendFactor),
-                             ToGLBlendFactor(CBA.srcAlphaBlendFactor),
-                             ToGLBlendFactor(CBA.dstAlphaBlendFactor));
+void GraphicsAPI_OpenGL::SetCapabilityIndexed(GLenum capability, GLuint index, bool enable) {
+    PFNGLENABLEIPROC glEnablei = (PFNGLENABLEIPROC)GetExtension("glEnablei");     // 3.0+
+    PFNGLDISABLEIPROC glDisablei = (PFNGLDISABLEIPROC)GetExtension("glDisablei");  // 3.0+
 
-        glColorMaski(i,
-                     (((uint32_t)CBA.colorWriteMask & (uint32_t)ColorComponentBit::R_BIT) == (uint32_t)ColorComponentBit::R_BIT),
-                     (((uint32_t)CBA.colorWriteMask & (uint32_t)ColorComponentBit::G_BIT) == (uint32_t)ColorComponentBit::G_BIT),
-                     (((uint32_t)CBA.colorWriteMask & (uint32_t)ColorComponentBit::B_BIT) == (uint32_t)ColorComponentBit::B_BIT),
-                     (((uint32_t)CBA.colorWriteMask & (uint32_t)ColorComponentBit::A_BIT) == (uint32_t)ColorComponentBit::A_BIT));
+    if (StateChanged(capability, {(double)enable}, index)) {
+        if (enable) {
+            glEnablei(capability, index);
+        } else {
+            glDisablei(capability, index);
+        }
     }
-    glBlendColor(CBS.blendConstants[0], CBS.blendConstants[1], CBS.blendConstants[2], CBS.blendConstants[3]);
 }
 
 void GraphicsAPI_OpenGL::SetDescriptor(const DescriptorInfo &descriptorInfo) {
@@ -1065,32 +1219,102 @@ void GraphicsAPI_OpenGL::SetDescriptor(const DescriptorInfo &descriptorInfo) {
 void GraphicsAPI_OpenGL::UpdateDescriptors() {
 }
 
-void GraphicsAPI_OpenGL::SetVertexBuffers(void **vertexBuffers, size_t count) {
-    const VertexInputState &vertexInputState = pipelines[setPipeline].vertexInputState;
+void GraphicsAPI_OpenGL::SetVertexBuffers(void **vertexBuffers, size_t count, const size_t *offsets) {
+    // The VertexArray also depends on the pipeline and index buffer, so it is bound in BindVertexArray() at draw time.
+    setVertexBuffers.resize(count);
+    setVertexBufferOffsets.resize(count);
     for (size_t i = 0; i < count; i++) {
         GLuint glVertexBufferID = (GLuint)(uint64_t)vertexBuffers[i];
         if (buffers[glVertexBufferID].type != BufferCreateInfo::Type::VERTEX) {
             std::cout << "ERROR: OpenGL: Provided buffer is not type: VERTEX." << std::endl;
         }
+        setVertexBuffers[i] = glVertexBufferID;
+        setVertexBufferOffsets[i] = offsets ? offsets[i] : 0;
+    }
+}
+
+void GraphicsAPI_OpenGL::BindVertexArray() {
+    PFNGLVERTEXATTRIBFORMATPROC glVertexAttribFormat = (PFNGLVERTEXATTRIBFORMATPROC)GetExtension("glVertexAttribFormat");        // 4.3+
+    PFNGLVERTEXATTRIBBINDINGPROC glVertexAttribBinding = (PFNGLVERTEXATTRIBBINDINGPROC)GetExtension("glVertexAttribBinding");     // 4.3+
+    PFNGLVERTEXBINDINGDIVISORPROC glVertexBindingDivisor = (PFNGLVERTEXBINDINGDIVISORPROC)GetExtension("glVertexBindingDivisor");  // 4.3+
+    PFNGLBINDVERTEXBUFFERPROC glBindVertexBuffer = (PFNGLBINDVERTEXBUFFERPROC)GetExtension("glBindVertexBuffer");                  // 4.3+
+
+    const VertexInputState &vertexInputState = pipelines[setPipeline].vertexInputState;
+
+    // Find or create a VertexArray for the bound buffers and the pipeline's vertex layout.
+    std::vector<uint64_t> key = {(uint64_t)setIndexBuffer, (uint64_t)setVertexBuffers.size()};
+    key.insert(key.end(), setVertexBuffers.begin(), setVertexBuffers.end());
+    for (const VertexInputBinding &vertexBinding : vertexInputState.bindings) {
+        key.insert(key.end(), {(uint64_t)vertexBinding.bindingIndex, (uint64_t)vertexBinding.stride, (uint64_t)vertexBinding.inputRate});
+    }
+    for (const VertexInputAttribute &vertexAttribute : vertexInputState.attributes) {
+        key.insert(key.end(), {(uint64_t)vertexAttribute.attribIndex, (uint64_t)vertexAttribute.bindingIndex, (uint64_t)vertexAttribute.vertexType, (uint64_t)vertexAttribute.offset});
+    }
+
+    auto it = vertexArrayCache.find(key);
+    if (it != vertexArrayCache.end()) {
+        vertexArrayCacheStatistics.hits++;
+    } else {
+        vertexArrayCacheStatistics.misses++;
 
-        glBindBuffer(GL_ARRAY_BUFFER, (GLuint)(uint64_t)vertexBuffers[i]);
+        VertexArray vertexArray;
+        glGenVertexArrays(1, &vertexArray.vertexArray);
+        glBindVertexArray(vertexArray.vertexArray);
 
         // https://i.redd.it/fyxp5ah06a661.png
+        for (const VertexInputAttribute &vertexAttribute : vertexInputState.attributes) {
+            GLuint attribIndex = vertexAttribute.attribIndex;
+            GLint size = ((GLint)vertexAttribute.vertexType % 4) + 1;
+            GLenum type = (GLenum)vertexAttribute.vertexType >= (GLenum)VertexType::UINT ? GL_UNSIGNED_INT : (GLenum)vertexAttribute.vertexType >= (GLenum)VertexType::INT ? GL_INT
+                                                                                                                                                                           : GL_FLOAT;
+            glEnableVertexAttribArray(attribIndex);
+            glVertexAttribFormat(attribIndex, size, type, false, vertexAttribute.offset);
+            glVertexAttribBinding(attribIndex, vertexAttribute.bindingIndex);
+        }
+        for (const VertexInputBinding &vertexBinding : vertexInputState.bindings) {
+            glVertexBindingDivisor(vertexBinding.bindingIndex, vertexBinding.inputRate == VertexInputRate::INSTANCE ? 1 : 0);
+        }
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, setIndexBuffer);
+
+        // No offsets have been bound yet, so every vertex buffer is bound below.
+        vertexArray.offsets.assign(setVertexBuffers.size(), SIZE_MAX);
+        it = vertexArrayCache.emplace(key, vertexArray).first;
+        setVertexArray = vertexArray.vertexArray;
+    }
+
+    VertexArray &vertexArray = it->second;
+    if (setVertexArray != vertexArray.vertexArray) {
+        glBindVertexArray(vertexArray.vertexArray);
+        setVertexArray = vertexArray.vertexArray;
+    }
+
+    for (size_t i = 0; i < setVertexBuffers.size(); i++) {
+        if (vertexArray.offsets[i] == setVertexBufferOffsets[i]) {
+            continue;
+        }
         for (const VertexInputBinding &vertexBinding : vertexInputState.bindings) {
             if (vertexBinding.bindingIndex == (uint32_t)i) {
-                for (const VertexInputAttribute &vertexAttribute : vertexInputState.attributes) {
-                    if (vertexAttribute.bindingIndex == (uint32_t)i) {
-                        GLuint attribIndex = vertexAttribute.attribIndex;
-                        GLint size = ((GLint)vertexAttribute.vertexType % 4) + 1;
-                        GLenum type = (GLenum)vertexAttribute.vertexType >= (GLenum)VertexType::UINT ? GL_UNSIGNED_INT : (GLenum)vertexAttribute.vertexType >= (GLenum)VertexType::INT ? GL_INT
-                                                                                                                                                                                       : GL_FLOAT;
-                        GLsizei stride = vertexBinding.stride;
-                        const void *offset = (const void *)vertexAttribute.offset;
-                        glEnableVertexAttribArray(attribIndex);
-                        glVertexAttribPointer(attribIndex, size, type, false, stride, offset);
-                    }
-                }
+                glBindVertexBuffer(vertexBinding.bindingIndex, setVertexBuffers[i], (GLintptr)setVertexBufferOffsets[i], (GLsizei)vertexBinding.stride);
+                vertexArray.offsets[i] = setVertexBufferOffsets[i];
+            }
+        }
+    }
+}
+
+void GraphicsAPI_OpenGL::DestroyCachedVertexArrays(GLuint buffer) {
+    // Key layout is {indexBuffer, vertexBufferCount, vertexBuffers..., vertex layout...}.
+    for (auto it = vertexArrayCache.begin(); it != vertexArrayCache.end();) {
+        const std::vector<uint64_t> &key = it->first;
+        auto vertexBuffersEnd = key.begin() + 2 + key[1];
+        if (key[0] == buffer || std::find(key.begin() + 2, vertexBuffersEnd, (uint64_t)buffer) != vertexBuffersEnd) {
+            if (setVertexArray == it->second.vertexArray) {
+                glBindVertexArray(0);
+                setVertexArray = 0;
             }
+            glDeleteVertexArrays(1, &it->second.vertexArray);
+            it = vertexArrayCache.erase(it);
+        } else {
+            ++it;
         }
     }
 }
@@ -1100,18 +1324,19 @@ void GraphicsAPI_OpenGL::SetIndexBuffer(void *indexBuffer) {
     if (buffers[glIndexBufferID].type != BufferCreateInfo::Type::INDEX) {
         std::cout << "ERROR: OpenGL: Provided buffer is not type: INDEX." << std::endl;
     }
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, glIndexBufferID);
     setIndexBuffer = glIndexBufferID;
 }
 
 void GraphicsAPI_OpenGL::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {
     PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC glDrawElementsInstancedBaseVertexBaseInstance = (PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC)GetExtension("glDrawElementsInstancedBaseVertexBaseInstance");  // 4.2+
+    BindVertexArray();
     GLenum indexType = buffers[setIndexBuffer].stride == 4 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
     glDrawElementsInstancedBaseVertexBaseInstance(ToGLTopology(pipelines[setPipeline].inputAssemblyState.topology), indexCount, indexType, nullptr, instanceCount, vertexOffset, firstInstance);
 }
 
 void GraphicsAPI_OpenGL::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) {
     PFNGLDRAWARRAYSINSTANCEDBASEINSTANCEPROC glDrawArraysInstancedBaseInstance = (PFNGLDRAWARRAYSINSTANCEDBASEINSTANCEPROC)GetExtension("glDrawArraysInstancedBaseInstance");  // 4.2+
+    BindVertexArray();
     glDrawArraysInstancedBaseInstance(ToGLTopology(pipelines[setPipeline].inputAssemblyState.topology), firstVertex, vertexCount, instanceCount, firstInstance);
 }
 
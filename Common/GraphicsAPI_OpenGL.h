@@ -52,12 +52,16 @@ public:
 
     virtual void* CreatePipeline(const PipelineCreateInfo& pipelineCI) override;
     virtual void DestroyPipeline(void*& pipeline) override;
+    virtual bool SupportsMultiview() const override;
 
     virtual void BeginRendering() override;
     virtual void EndRendering() override;
 
     virtual void SetBufferData(void* buffer, size_t offset, size_t size, void* data) override;
 
+    virtual void BeginTimestampScope(const std::string& name) override;
+    virtual void EndTimestampScope() override;
+
     virtual void ClearColor(void* imageView, float r, float g, float b, float a) override;
     virtual void ClearDepth(void* imageView, float d) override;
 
@@ -68,15 +72,26 @@ public:
     virtual void SetPipeline(void* pipeline) override;
     virtual void SetDescriptor(const DescriptorInfo& descriptorInfo) override;
     virtual void UpdateDescriptors() override;
-    virtual void SetVertexBuffers(void** vertexBuffers, size_t count) override;
+    virtual void SetVertexBuffers(void** vertexBuffers, size_t count, const size_t* offsets = nullptr) override;
     virtual void SetIndexBuffer(void* indexBuffer) override;
     virtual void DrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0) override;
     virtual void Draw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0) override;
 
+    const CacheStatistics& GetFramebufferCacheStatistics() const { return framebufferCacheStatistics; }
+    const CacheStatistics& GetVertexArrayCacheStatistics() const { return vertexArrayCacheStatistics; }
+
 private:
     virtual const std::vector<int64_t> GetSupportedColorSwapchainFormats() override;
     virtual const std::vector<int64_t> GetSupportedDepthSwapchainFormats() override;
 
+    bool StateChanged(GLenum state, std::initializer_list<double> values, GLuint index = 0);
+    void SetCapability(GLenum capability, bool enable);
+    void SetCapabilityIndexed(GLenum capability, GLuint index, bool enable);
+
+    void BindVertexArray();
+    void DestroyCachedFramebuffers(GLuint imageView);
+    void DestroyCachedVertexArrays(GLuint buffer);
+
 private:
     ksGpuWindow window{};
 
@@ -97,10 +112,41 @@ private:
     std::unordered_map<GLuint, ImageCreateInfo> images{};
     std::unordered_map<GLuint, ImageViewCreateInfo> imageViews{};
 
+    // Framebuffers keyed by the imageViews attached to them. They live until one of those imageViews is destroyed.
+    std::unordered_map<std::vector<uint64_t>, GLuint, CacheKeyHash> framebufferCache{};
+    CacheStatistics framebufferCacheStatistics{};
     GLuint setFramebuffer = 0;
+
     std::unordered_map<GLuint, PipelineCreateInfo> pipelines{};
     GLuint setPipeline = 0;
-    GLuint vertexArray = 0;
+
+    // VertexArrays keyed by {indexBuffer, vertexBufferCount, vertexBuffers..., vertex layout...}. The attribute formats
+    // are specified once on creation; the per-binding offsets are tracked so glBindVertexBuffer() is only called when
+    // they change. They live until one of their buffers is destroyed.
+    struct VertexArray {
+        GLuint vertexArray = 0;
+        std::vector<size_t> offsets;
+    };
+    std::unordered_map<std::vector<uint64_t>, VertexArray, CacheKeyHash> vertexArrayCache{};
+    CacheStatistics vertexArrayCacheStatistics{};
+    GLuint setVertexArray = 0;
+    std::vector<GLuint> setVertexBuffers{};
+    std::vector<size_t> setVertexBufferOffsets{};
     GLuint setIndexBuffer = 0;
+
+    // Shadow copy of the state last set through SetPipeline(), keyed by the state's glGet enum and, for indexed
+    // state, the index in the upper 32 bits. It is cleared in BeginRendering() as the runtime may use the context
+    // between frames.
+    std::unordered_map<uint64_t, std::vector<double>> stateCache{};
+
+    // GL_TIMESTAMP queries for the last few submissions, created on the first BeginRendering(). Each BeginRendering()
+    // reads back the submissions whose results are available and reuses the oldest, dropping its results if they still
+    // aren't available rather than waiting for them.
+    struct TimestampFrame {
+        std::vector<GLuint> queries;
+        TimestampQuerySet querySet;
+    };
+    std::vector<TimestampFrame> timestampFrames{};
+    size_t timestampFrameIndex = 0;
 };
 #endif
@@ -416,6 +416,8 @@ GraphicsAPI_OpenGL_ES::GraphicsAPI_OpenGL_ES(XrInstance m_xrInstance, XrSystemId
 }
 
 GraphicsAPI_OpenGL_ES::~GraphicsAPI_OpenGL_ES() {
+    DestroyTransientBuffers();
+
     ksGpuWindow_Destroy(&window);
 }
 // XR_DOCS_TAG_END_GraphicsAPI_OpenGL_ES
@@ -574,7 +576,14 @@ void *GraphicsAPI_OpenGL_ES::CreateBuffer(const BufferCreateInfo &bufferCI) {
     }
 
     glBindBuffer(target, buffer);
-    glBufferData(target, (GLsizeiptr)bufferCI.size, bufferCI.data, GL_STATIC_DRAW);
+    // The usage is a hint to the driver about where to place the buffer's storage.
+    GLenum usage = GL_DYNAMIC_DRAW;
+    if (bufferCI.usage == BufferCreateInfo::Usage::STATIC) {
+        usage = GL_STATIC_DRAW;
+    } else if (bufferCI.usage == BufferCreateInfo::Usage::STREAM) {
+        usage = GL_STREAM_DRAW;
+    }
+    glBufferData(target, (GLsizeiptr)bufferCI.size, bufferCI.data, usage);
     glBindBuffer(target, 0);
 
     buffers[buffer] = bufferCI;
@@ -620,7 +629,9 @@ void *GraphicsAPI_OpenGL_ES::CreateShader(const ShaderCreateInfo &shaderCI) {
     }
     GLuint shader = glCreateShader(type);
 
-    glShaderSource(shader, 1, &shaderCI.sourceData, nullptr);
+    // The source may be a view of a file, which isn't null terminated.
+    GLint sourceLength = static_cast<GLint>(shaderCI.sourceSize);
+    glShaderSource(shader, 1, &shaderCI.sourceData, &sourceLength);
     glCompileShader(shader);
 
     GLint isCompiled = 0;
@@ -682,6 +693,19 @@ void GraphicsAPI_OpenGL_ES::DestroyPipeline(void *&pipeline) {
     pipeline = nullptr;
 }
 
+// GL_OVR_multiview2 lets the vertex shader use gl_ViewID_OVR for more than the position. Multiview framebuffers are made
+// from TYPE_2D_ARRAY image views, and the shaders declare the view count, so PipelineCreateInfo::viewMask isn't needed.
+bool GraphicsAPI_OpenGL_ES::SupportsMultiview() const {
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; i++) {
+        if (strcmp((const char *)glGetStringi(GL_EXTENSIONS, i), "GL_OVR_multiview2") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void GraphicsAPI_OpenGL_ES::BeginRendering() {
     glGenVertexArrays(1, &vertexArray);
     glBindVertexArray(vertexArray);
@@ -1002,7 +1026,7 @@ void GraphicsAPI_OpenGL_ES::SetDescriptor(const DescriptorInfo &descriptorInfo)
 void GraphicsAPI_OpenGL_ES::UpdateDescriptors() {
 }
 
-void GraphicsAPI_OpenGL_ES::SetVertexBuffers(void **vertexBuffers, size_t count) {
+void GraphicsAPI_OpenGL_ES::SetVertexBuffers(void **vertexBuffers, size_t count, const size_t *offsets) {
     const VertexInputState &vertexInputState = pipelines[setPipeline].vertexInputState;
     for (size_t i = 0; i < count; i++) {
         GLuint glVertexBufferID = (GLuint)(uint64_t)vertexBuffers[i];
@@ -1022,9 +1046,10 @@ void GraphicsAPI_OpenGL_ES::SetVertexBuffers(void **vertexBuffers, size_t count)
                         GLenum type = (GLenum)vertexAttribute.vertexType >= (GLenum)VertexType::UINT ? GL_UNSIGNED_INT : (GLenum)vertexAttribute.vertexType >= (GLenum)VertexType::INT ? GL_INT
                                                                                                                                                                                        : GL_FLOAT;
                         GLsizei stride = vertexBinding.stride;
-                        const void *offset = (const void *)vertexAttribute.offset;
+                        const void *offset = (const void *)(vertexAttribute.offset + (offsets ? offsets[i] : 0));
                         glEnableVertexAttribArray(attribIndex);
                         glVertexAttribPointer(attribIndex, size, type, false, stride, offset);
+                        glVertexAttribDivisor(attribIndex, vertexBinding.inputRate == VertexInputRate::INSTANCE ? 1 : 0);
                     }
                 }
             }
@@ -52,6 +52,7 @@ public:
 
     virtual void* CreatePipeline(const PipelineCreateInfo& pipelineCI) override;
     virtual void DestroyPipeline(void*& pipeline) override;
+    virtual bool SupportsMultiview() const override;
 
     virtual void BeginRendering() override;
     virtual void EndRendering() override;
@@ -68,7 +69,7 @@ public:
     virtual void SetPipeline(void* pipeline) override;
     virtual void SetDescriptor(const DescriptorInfo& descriptorInfo) override;
     virtual void UpdateDescriptors() override;
-    virtual void SetVertexBuffers(void** vertexBuffers, size_t count) override;
+    virtual void SetVertexBuffers(void** vertexBuffers, size_t count, const size_t* offsets = nullptr) override;
     virtual void SetIndexBuffer(void* indexBuffer) override;
     virtual void DrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0) override;
     virtual void Draw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0) override;
@@ -10,6 +10,10 @@
 #include <GraphicsAPI_Vulkan.h>
 
 #if defined(XR_USE_GRAPHICS_API_VULKAN)
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 
 #define VULKAN_CHECK(x, y)                                                                         \
     {                                                                                              \
@@ -40,6 +44,113 @@ static bool MemoryTypeFromProperties(VkPhysicalDeviceMemoryProperties memoryProp
     return false;
 };
 
+// Adds extensionName to activeExtensions if the instance or device supports it and it isn't already there.
+static bool EnableExtension(const std::vector<VkExtensionProperties> &extensionProperties, std::vector<const char *> &activeExtensions, const char *extensionName) {
+    for (const VkExtensionProperties &extensionProperty : extensionProperties) {
+        if (strcmp(extensionProperty.extensionName, extensionName) == 0) {
+            for (const char *activeExtension : activeExtensions) {
+                if (strcmp(activeExtension, extensionName) == 0) {
+                    return true;
+                }
+            }
+            activeExtensions.push_back(extensionName);
+            return true;
+        }
+    }
+    return false;
+}
+
+// VK_KHR_multiview and VK_EXT_pipeline_creation_feedback require VK_KHR_get_physical_device_properties2, which is
+// either enabled on the instance or part of Vulkan 1.1, when both the instance and the device are 1.1.
+static bool SupportsPhysicalDeviceProperties2(const VkApplicationInfo &ai, VkPhysicalDevice physicalDevice, const std::vector<const char *> &activeInstanceExtensions) {
+    for (const char *activeInstanceExtension : activeInstanceExtensions) {
+        if (strcmp(activeInstanceExtension, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0) {
+            return true;
+        }
+    }
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+    return ai.apiVersion >= VK_MAKE_API_VERSION(0, 1, 1, 0) && physicalDeviceProperties.apiVersion >= VK_MAKE_API_VERSION(0, 1, 1, 0);
+}
+
+// Enables VK_EXT_pipeline_creation_feedback if the device supports it, so that pipeline cache hits can be counted.
+static bool EnablePipelineCreationFeedback(const std::vector<VkExtensionProperties> &deviceExtensionProperties, std::vector<const char *> &activeDeviceExtensions, bool physicalDeviceProperties2) {
+#if defined(VK_EXT_pipeline_creation_feedback)
+    return physicalDeviceProperties2 && EnableExtension(deviceExtensionProperties, activeDeviceExtensions, VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+#else
+    return false;
+#endif
+}
+
+// Enables VK_KHR_multiview if the device supports it, so that both views can be drawn in one render pass. Devices with
+// the extension always support its multiview feature, which still has to be enabled in VkDeviceCreateInfo::pNext.
+static bool EnableMultiview(const std::vector<VkExtensionProperties> &deviceExtensionProperties, std::vector<const char *> &activeDeviceExtensions, bool physicalDeviceProperties2) {
+#if defined(VK_KHR_multiview)
+    return physicalDeviceProperties2 && EnableExtension(deviceExtensionProperties, activeDeviceExtensions, VK_KHR_MULTIVIEW_EXTENSION_NAME);
+#else
+    return false;
+#endif
+}
+
+// Number of views drawn by a render pass with viewMask.
+static uint32_t ViewCount(uint32_t viewMask) {
+    uint32_t viewCount = 0;
+    for (; viewMask != 0; viewMask &= viewMask - 1) {
+        viewCount++;
+    }
+    return viewCount;
+}
+
+thread_local GraphicsAPI_Vulkan::CommandContext *GraphicsAPI_Vulkan::threadCommandContext = nullptr;
+
+// Written in front of the VkPipelineCache data in the pipeline cache file. Drivers check the header at the start of
+// their own data too, but some have been known to crash on data from another driver version rather than ignore it, so
+// a mismatched file is rejected before its data reaches the driver.
+struct PipelineCacheFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint32_t driverVersion;
+    uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+    uint64_t dataSize;
+};
+
+static PipelineCacheFileHeader MakePipelineCacheFileHeader(const VkPhysicalDeviceProperties &properties, uint64_t dataSize) {
+    PipelineCacheFileHeader header{};
+    header.magic = 0x43505258;  // "XRPC"
+    header.version = 1;
+    header.vendorID = properties.vendorID;
+    header.deviceID = properties.deviceID;
+    header.driverVersion = properties.driverVersion;
+    memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+    header.dataSize = dataSize;
+    return header;
+}
+
+// Returns nullptr if the file's VkPipelineCache data can be used by this device, or the reason that it can't.
+static const char *ValidatePipelineCacheData(const PipelineCacheFileHeader &expected, const PipelineCacheFileHeader &header, const std::vector<char> &data) {
+    if (header.magic != expected.magic || header.version != expected.version) {
+        return "unrecognized file";
+    }
+    if (header.vendorID != expected.vendorID || header.deviceID != expected.deviceID || memcmp(header.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        return "written by a different device";
+    }
+    if (header.driverVersion != expected.driverVersion) {
+        return "written by a different driver version";
+    }
+    // VkPipelineCacheHeaderVersionOne: headerSize, headerVersion, vendorID and deviceID, followed by pipelineCacheUUID.
+    uint32_t dataHeader[4];
+    if (data.size() != header.dataSize || data.size() < sizeof(dataHeader) + VK_UUID_SIZE) {
+        return "truncated file";
+    }
+    memcpy(dataHeader, data.data(), sizeof(dataHeader));
+    if (dataHeader[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE || dataHeader[2] != expected.vendorID || dataHeader[3] != expected.deviceID || memcmp(data.data() + sizeof(dataHeader), expected.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        return "data doesn't match the device";
+    }
+    return nullptr;
+}
+
 static VkFormat ToVkFormat(GraphicsAPI::VertexType type) {
     switch (type) {
     case GraphicsAPI::VertexType::FLOAT:
@@ -75,7 +186,8 @@ VkDescriptorType ToVkDescrtiptorType(const GraphicsAPI::DescriptorInfo &descInfo
     switch (descInfo.type) {
     default:
     case GraphicsAPI::DescriptorInfo::Type::BUFFER: {
-        vkType = descInfo.readWrite ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        // Uniform buffers are always dynamic, so that a DescriptorSet can be reused with a different bufferOffset.
+        vkType = descInfo.readWrite ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         break;
     }
     case GraphicsAPI::DescriptorInfo::Type::IMAGE: {
@@ -90,7 +202,286 @@ VkDescriptorType ToVkDescrtiptorType(const GraphicsAPI::DescriptorInfo &descInfo
     return vkType;
 }
 
-GraphicsAPI_Vulkan::GraphicsAPI_Vulkan() {
+void VulkanMemoryAllocator::Init(VkPhysicalDevice physicalDevice, VkDevice vkDevice) {
+    device = vkDevice;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+    maxDeviceMemoryCount = physicalDeviceProperties.limits.maxMemoryAllocationCount;
+
+    pools.resize(memoryProperties.memoryTypeCount * 4);
+    for (uint32_t memoryTypeIndex = 0; memoryTypeIndex < memoryProperties.memoryTypeCount; memoryTypeIndex++) {
+        // Blocks of 64 MiB, or an eighth of a smaller heap.
+        VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+        VkDeviceSize blockSize = std::min<VkDeviceSize>(64 * 1024 * 1024, heapSize / 8);
+        for (uint32_t i = 0; i < 4; i++) {
+            Pool &pool = pools[memoryTypeIndex * 4 + i];
+            pool.memoryTypeIndex = memoryTypeIndex;
+            pool.image = (i & 2) != 0;
+            pool.lifetime = (i & 1) ? Lifetime::TRANSIENT : Lifetime::PERSISTENT;
+            pool.blockSize = blockSize;
+        }
+    }
+}
+
+void VulkanMemoryAllocator::Destroy() {
+    for (Pool &pool : pools) {
+        for (Block &block : pool.blocks) {
+            if (block.memory) {
+                if (block.allocationCount > 0) {
+                    std::cout << "ERROR: VULKAN: " << block.allocationCount << " allocations weren't freed before the memory allocator was destroyed." << std::endl;
+                }
+                FreeDeviceMemory(pool.memoryTypeIndex, block.size, block.memory, block.mappedData);
+            }
+        }
+        pool.blocks.clear();
+    }
+}
+
+bool VulkanMemoryAllocator::Allocate(const VkMemoryRequirements &memoryRequirements, VkMemoryPropertyFlags properties, bool image, Lifetime lifetime, Allocation &allocation) {
+    allocation = {};
+    uint32_t memoryTypeIndex = 0;
+    if (!MemoryTypeFromProperties(memoryProperties, memoryRequirements.memoryTypeBits, properties, &memoryTypeIndex)) {
+        std::cout << "ERROR: VULKAN: No memory type with properties 0x" << std::hex << properties << std::dec << " is suitable." << std::endl;
+        return false;
+    }
+    uint32_t poolIndex = memoryTypeIndex * 4 + (image ? 2 : 0) + (lifetime == Lifetime::TRANSIENT ? 1 : 0);
+    Pool &pool = pools[poolIndex];
+    allocation.poolIndex = poolIndex;
+    allocation.size = memoryRequirements.size;
+
+    if (memoryRequirements.size > pool.blockSize / 2) {
+        if (!AllocateDeviceMemory(memoryTypeIndex, memoryRequirements.size, allocation.memory, allocation.mappedData)) {
+            return false;
+        }
+        allocation.blockIndex = dedicatedBlockIndex;
+        dedicatedAllocationCount++;
+        dedicatedBytes += memoryRequirements.size;
+        return true;
+    }
+
+    // Try the existing blocks first, then a new block in the first free slot.
+    uint32_t freeSlot = static_cast<uint32_t>(pool.blocks.size());
+    for (uint32_t blockIndex = 0; blockIndex < pool.blocks.size(); blockIndex++) {
+        Block &block = pool.blocks[blockIndex];
+        if (!block.memory) {
+            freeSlot = std::min(freeSlot, blockIndex);
+            continue;
+        }
+        if (AllocateFromBlock(pool, block, memoryRequirements.size, memoryRequirements.alignment, allocation.offset)) {
+            allocation.blockIndex = blockIndex;
+            allocation.memory = block.memory;
+            allocation.mappedData = block.mappedData ? static_cast<char *>(block.mappedData) + allocation.offset : nullptr;
+            return true;
+        }
+    }
+
+    Block block;
+    block.size = pool.blockSize;
+    if (!AllocateDeviceMemory(memoryTypeIndex, block.size, block.memory, block.mappedData)) {
+        return false;
+    }
+    if (pool.lifetime == Lifetime::PERSISTENT) {
+        block.freeRanges[0] = block.size;
+    }
+    if (freeSlot == pool.blocks.size()) {
+        pool.blocks.push_back(std::move(block));
+    } else {
+        pool.blocks[freeSlot] = std::move(block);
+    }
+    Block &newBlock = pool.blocks[freeSlot];
+    AllocateFromBlock(pool, newBlock, memoryRequirements.size, memoryRequirements.alignment, allocation.offset);
+    allocation.blockIndex = freeSlot;
+    allocation.memory = newBlock.memory;
+    allocation.mappedData = newBlock.mappedData ? static_cast<char *>(newBlock.mappedData) + allocation.offset : nullptr;
+    return true;
+}
+
+bool VulkanMemoryAllocator::AllocateFromBlock(Pool &pool, Block &block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset) {
+    if (pool.lifetime == Lifetime::TRANSIENT) {
+        VkDeviceSize alignedOffset = Align<VkDeviceSize>(block.linearOffset, alignment);
+        if (alignedOffset + size > block.size) {
+            return false;
+        }
+        offset = alignedOffset;
+        block.linearOffset = alignedOffset + size;
+        block.allocationCount++;
+        return true;
+    }
+
+    // Best fit: the smallest free range that the aligned allocation fits in.
+    auto best = block.freeRanges.end();
+    VkDeviceSize bestLeftover = 0;
+    for (auto it = block.freeRanges.begin(); it != block.freeRanges.end(); ++it) {
+        VkDeviceSize alignedOffset = Align<VkDeviceSize>(it->first, alignment);
+        VkDeviceSize rangeEnd = it->first + it->second;
+        if (alignedOffset + size > rangeEnd) {
+            continue;
+        }
+        VkDeviceSize leftover = it->second - size;
+        if (best == block.freeRanges.end() || leftover < bestLeftover) {
+            best = it;
+            bestLeftover = leftover;
+        }
+    }
+    if (best == block.freeRanges.end()) {
+        return false;
+    }
+
+    // Split the range into the padding before the allocation, the allocation and what remains after it.
+    VkDeviceSize rangeOffset = best->first;
+    VkDeviceSize rangeEnd = best->first + best->second;
+    offset = Align<VkDeviceSize>(rangeOffset, alignment);
+    block.freeRanges.erase(best);
+    if (offset > rangeOffset) {
+        block.freeRanges[rangeOffset] = offset - rangeOffset;
+    }
+    if (offset + size < rangeEnd) {
+        block.freeRanges[offset + size] = rangeEnd - (offset + size);
+    }
+    block.allocationCount++;
+    return true;
+}
+
+void VulkanMemoryAllocator::Free(Allocation &allocation) {
+    if (!allocation.memory) {
+        return;
+    }
+    Pool &pool = pools[allocation.poolIndex];
+    if (allocation.blockIndex == dedicatedBlockIndex) {
+        void *mappedData = allocation.mappedData;
+        FreeDeviceMemory(pool.memoryTypeIndex, allocation.size, allocation.memory, mappedData);
+        dedicatedAllocationCount--;
+        dedicatedBytes -= allocation.size;
+        allocation = {};
+        return;
+    }
+
+    Block &block = pool.blocks[allocation.blockIndex];
+    block.allocationCount--;
+    if (pool.lifetime == Lifetime::TRANSIENT) {
+        // Everything in a transient block is freed together, after which it can be reused from the start.
+        if (block.allocationCount == 0) {
+            block.linearOffset = 0;
+        }
+    } else {
+        // Return the range, merging it with the free ranges on either side.
+        VkDeviceSize offset = allocation.offset;
+        VkDeviceSize size = allocation.size;
+        auto next = block.freeRanges.lower_bound(offset);
+        if (next != block.freeRanges.begin()) {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == offset) {
+                offset = previous->first;
+                size += previous->second;
+                block.freeRanges.erase(previous);
+            }
+        }
+        if (next != block.freeRanges.end() && offset + size == next->first) {
+            size += next->second;
+            block.freeRanges.erase(next);
+        }
+        block.freeRanges[offset] = size;
+    }
+
+    // Keep one empty block per pool, so that a resource that is repeatedly created and destroyed doesn't reallocate it.
+    if (block.allocationCount == 0) {
+        uint32_t blockCount = 0;
+        for (const Block &poolBlock : pool.blocks) {
+            blockCount += poolBlock.memory ? 1 : 0;
+        }
+        if (blockCount > 1) {
+            FreeDeviceMemory(pool.memoryTypeIndex, block.size, block.memory, block.mappedData);
+            block = Block();
+        }
+    }
+    allocation = {};
+}
+
+bool VulkanMemoryAllocator::AllocateDeviceMemory(uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory &memory, void *&mappedData) {
+    if (deviceMemoryCount >= maxDeviceMemoryCount) {
+        std::cout << "ERROR: VULKAN: The device's limit of " << maxDeviceMemoryCount << " memory allocations has been reached." << std::endl;
+        return false;
+    }
+    VkMemoryAllocateInfo allocateInfo;
+    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.pNext = nullptr;
+    allocateInfo.allocationSize = size;
+    allocateInfo.memoryTypeIndex = memoryTypeIndex;
+    VkResult result = vkAllocateMemory(device, &allocateInfo, nullptr, &memory);
+    if (result != VK_SUCCESS) {
+        std::cout << "ERROR: VULKAN: Failed to allocate " << size << " bytes of Memory: 0x" << std::hex << result << std::dec << std::endl;
+        memory = VK_NULL_HANDLE;
+        return false;
+    }
+
+    // Memory can only be mapped once, so host visible memory is mapped as a whole and kept mapped.
+    mappedData = nullptr;
+    if (BitwiseCheck<VkMemoryPropertyFlags>(memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
+        VULKAN_CHECK(vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &mappedData), "Can not map Memory.");
+    }
+    deviceMemoryCount++;
+    heapBytes[memoryProperties.memoryTypes[memoryTypeIndex].heapIndex] += size;
+    return true;
+}
+
+void VulkanMemoryAllocator::FreeDeviceMemory(uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory memory, void *mappedData) {
+    if (mappedData) {
+        vkUnmapMemory(device, memory);
+    }
+    vkFreeMemory(device, memory, nullptr);
+    deviceMemoryCount--;
+    heapBytes[memoryProperties.memoryTypes[memoryTypeIndex].heapIndex] -= size;
+}
+
+VulkanMemoryAllocator::Statistics VulkanMemoryAllocator::GetStatistics() const {
+    Statistics statistics;
+    for (const Pool &pool : pools) {
+        PoolStatistics poolStatistics;
+        poolStatistics.memoryTypeIndex = pool.memoryTypeIndex;
+        poolStatistics.heapIndex = memoryProperties.memoryTypes[pool.memoryTypeIndex].heapIndex;
+        poolStatistics.image = pool.image;
+        poolStatistics.lifetime = pool.lifetime;
+        VkDeviceSize freeBytes = 0;
+        for (const Block &block : pool.blocks) {
+            if (!block.memory) {
+                continue;
+            }
+            poolStatistics.blockCount++;
+            poolStatistics.blockBytes += block.size;
+            poolStatistics.allocationCount += block.allocationCount;
+            if (pool.lifetime == Lifetime::TRANSIENT) {
+                VkDeviceSize remaining = block.size - block.linearOffset;
+                poolStatistics.allocatedBytes += block.linearOffset;
+                poolStatistics.freeRangeCount += remaining > 0 ? 1 : 0;
+                poolStatistics.largestFreeRange = std::max(poolStatistics.largestFreeRange, remaining);
+                freeBytes += remaining;
+            } else {
+                VkDeviceSize blockFreeBytes = 0;
+                for (const auto &freeRange : block.freeRanges) {
+                    blockFreeBytes += freeRange.second;
+                    poolStatistics.largestFreeRange = std::max(poolStatistics.largestFreeRange, freeRange.second);
+                }
+                poolStatistics.allocatedBytes += block.size - blockFreeBytes;
+                poolStatistics.freeRangeCount += static_cast<uint32_t>(block.freeRanges.size());
+                freeBytes += blockFreeBytes;
+            }
+        }
+        if (poolStatistics.blockCount == 0) {
+            continue;
+        }
+        poolStatistics.fragmentation = freeBytes > 0 ? 1.0f - static_cast<float>(poolStatistics.largestFreeRange) / static_cast<float>(freeBytes) : 0.0f;
+        statistics.pools.push_back(poolStatistics);
+    }
+    statistics.dedicatedAllocationCount = dedicatedAllocationCount;
+    statistics.dedicatedBytes = dedicatedBytes;
+    statistics.deviceMemoryCount = deviceMemoryCount;
+    statistics.maxDeviceMemoryCount = maxDeviceMemoryCount;
+    statistics.heapBytes.assign(heapBytes, heapBytes + memoryProperties.memoryHeapCount);
+    return statistics;
+}
+
+GraphicsAPI_Vulkan::GraphicsAPI_Vulkan(uint32_t frameContextCount, const std::string &pipelineCachePath) {
     // Instance
     VkApplicationInfo ai;
     ai.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
@@ -123,6 +514,8 @@ GraphicsAPI_Vulkan::GraphicsAPI_Vulkan() {
             break;
         }
     }
+    // Needed by the optional device extensions, as the instance is Vulkan 1.0.
+    EnableExtension(instanceExtensionProperties, activeInstanceExtensions, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
 
     activeInstanceLayers = {"VK_LAYER_KHRONOS_validation"};
 
@@ -190,6 +583,9 @@ GraphicsAPI_Vulkan::GraphicsAPI_Vulkan() {
             break;
         }
     }
+    const bool physicalDeviceProperties2 = SupportsPhysicalDeviceProperties2(ai, physicalDevice, activeInstanceExtensions);
+    pipelineCacheStatistics.feedbackEnabled = EnablePipelineCreationFeedback(deviceExtensionProperties, activeDeviceExtensions, physicalDeviceProperties2);
+    multiviewSupported = EnableMultiview(deviceExtensionProperties, activeDeviceExtensions, physicalDeviceProperties2);
 
     VkPhysicalDeviceFeatures features;
     vkGetPhysicalDeviceFeatures(physicalDevice, &features);
@@ -197,6 +593,17 @@ GraphicsAPI_Vulkan::GraphicsAPI_Vulkan() {
     VkDeviceCreateInfo deviceCI;
     deviceCI.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     deviceCI.pNext = nullptr;
+#if defined(VK_KHR_multiview)
+    VkPhysicalDeviceMultiviewFeaturesKHR multiviewFeatures;
+    multiviewFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES_KHR;
+    multiviewFeatures.pNext = nullptr;
+    multiviewFeatures.multiview = VK_TRUE;
+    multiviewFeatures.multiviewGeometryShader = VK_FALSE;
+    multiviewFeatures.multiviewTessellationShader = VK_FALSE;
+    if (multiviewSupported) {
+        deviceCI.pNext = &multiviewFeatures;
+    }
+#endif
     deviceCI.flags = 0;
     deviceCI.queueCreateInfoCount = static_cast<uint32_t>(deviceQueueCIs.size());
     deviceCI.pQueueCreateInfos = deviceQueueCIs.data();
@@ -206,6 +613,7 @@ GraphicsAPI_Vulkan::GraphicsAPI_Vulkan() {
     deviceCI.ppEnabledExtensionNames = activeDeviceExtensions.data();
     deviceCI.pEnabledFeatures = &features;
     VULKAN_CHECK(vkCreateDevice(physicalDevice, &deviceCI, nullptr, &device), "Failed to create Device.");
+    memoryAllocator.Init(physicalDevice, device);
 
     VkCommandPoolCreateInfo cmdPoolCI;
     cmdPoolCI.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
@@ -214,42 +622,15 @@ GraphicsAPI_Vulkan::GraphicsAPI_Vulkan() {
     cmdPoolCI.queueFamilyIndex = queueFamilyIndex;
     VULKAN_CHECK(vkCreateCommandPool(device, &cmdPoolCI, nullptr, &cmdPool), "Failed to create CommandPool.");
 
-    VkCommandBufferAllocateInfo allocateInfo;
-    allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocateInfo.pNext = nullptr;
-    allocateInfo.commandPool = cmdPool;
-    allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocateInfo.commandBufferCount = 1;
-    VULKAN_CHECK(vkAllocateCommandBuffers(device, &allocateInfo, &cmdBuffer), "Failed to allocate CommandBuffers.");
-
     vkGetDeviceQueue(device, queueFamilyIndex, queueIndex, &queue);
 
-    VkFenceCreateInfo fenceCI{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
-    fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceCI.pNext = nullptr;
-    fenceCI.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-    VULKAN_CHECK(vkCreateFence(device, &fenceCI, nullptr, &fence), "Failed to create Fence.")
-
-    uint32_t maxSets = 1024;
-    std::vector<VkDescriptorPoolSize> poolSizes{
-        {VK_DESCRIPTOR_TYPE_SAMPLER, 16 * maxSets},
-        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 16 * maxSets},
-        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 16 * maxSets},
-        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 16 * maxSets},
-        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 16 * maxSets}};
-
-    VkDescriptorPoolCreateInfo descPoolCI;
-    descPoolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    descPoolCI.pNext = nullptr;
-    descPoolCI.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-    descPoolCI.maxSets = maxSets;
-    descPoolCI.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-    descPoolCI.pPoolSizes = poolSizes.data();
-    VULKAN_CHECK(vkCreateDescriptorPool(device, &descPoolCI, nullptr, &descriptorPool), "Failed to create DescriptorPool");
+    CreateFrameContexts(frameContextCount);
+    CreateUploadQueue();
+    CreatePipelineCache(pipelineCachePath);
 }
 
 // XR_DOCS_TAG_BEGIN_GraphicsAPI_Vulkan
-GraphicsAPI_Vulkan::GraphicsAPI_Vulkan(XrInstance m_xrInstance, XrSystemId systemId) {
+GraphicsAPI_Vulkan::GraphicsAPI_Vulkan(XrInstance m_xrInstance, XrSystemId systemId, uint32_t frameContextCount, const std::string &pipelineCachePath) {
     // Instance
     LoadPFN_XrFunctions(m_xrInstance);
 
@@ -281,6 +662,8 @@ GraphicsAPI_Vulkan::GraphicsAPI_Vulkan(XrInstance m_xrInstance, XrSystemId syste
             break;
         }
     }
+    // Needed by the optional device extensions when the runtime only requires Vulkan 1.0.
+    EnableExtension(instanceExtensionProperties, activeInstanceExtensions, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
 
     VkInstanceCreateInfo instanceCI;
     instanceCI.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -355,6 +738,9 @@ GraphicsAPI_Vulkan::GraphicsAPI_Vulkan(XrInstance m_xrInstance, XrSystemId syste
             break;
         }
     }
+    const bool physicalDeviceProperties2 = SupportsPhysicalDeviceProperties2(ai, physicalDevice, activeInstanceExtensions);
+    pipelineCacheStatistics.feedbackEnabled = EnablePipelineCreationFeedback(deviceExtensionProperties, activeDeviceExtensions, physicalDeviceProperties2);
+    multiviewSupported = EnableMultiview(deviceExtensionProperties, activeDeviceExtensions, physicalDeviceProperties2);
 
     VkPhysicalDeviceFeatures features;
     vkGetPhysicalDeviceFeatures(physicalDevice, &features);
@@ -362,6 +748,17 @@ GraphicsAPI_Vulkan::GraphicsAPI_Vulkan(XrInstance m_xrInstance, XrSystemId syste
     VkDeviceCreateInfo deviceCI;
     deviceCI.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     deviceCI.pNext = nullptr;
+#if defined(VK_KHR_multiview)
+    VkPhysicalDeviceMultiviewFeaturesKHR multiviewFeatures;
+    multiviewFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES_KHR;
+    multiviewFeatures.pNext = nullptr;
+    multiviewFeatures.multiview = VK_TRUE;
+    multiviewFeatures.multiviewGeometryShader = VK_FALSE;
+    multiviewFeatures.multiviewTessellationShader = VK_FALSE;
+    if (multiviewSupported) {
+        deviceCI.pNext = &multiviewFeatures;
+    }
+#endif
     deviceCI.flags = 0;
     deviceCI.queueCreateInfoCount = static_cast<uint32_t>(deviceQueueCIs.size());
     deviceCI.pQueueCreateInfos = deviceQueueCIs.data();
@@ -371,6 +768,7 @@ GraphicsAPI_Vulkan::GraphicsAPI_Vulkan(XrInstance m_xrInstance, XrSystemId syste
     deviceCI.ppEnabledExtensionNames = activeDeviceExtensions.data();
     deviceCI.pEnabledFeatures = &features;
     VULKAN_CHECK(vkCreateDevice(physicalDevice, &deviceCI, nullptr, &device), "Failed to create Device.");
+    memoryAllocator.Init(physicalDevice, device);
 
     VkCommandPoolCreateInfo cmdPoolCI;
     cmdPoolCI.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
@@ -379,52 +777,456 @@ GraphicsAPI_Vulkan::GraphicsAPI_Vulkan(XrInstance m_xrInstance, XrSystemId syste
     cmdPoolCI.queueFamilyIndex = queueFamilyIndex;
     VULKAN_CHECK(vkCreateCommandPool(device, &cmdPoolCI, nullptr, &cmdPool), "Failed to create CommandPool.");
 
-    VkCommandBufferAllocateInfo allocateInfo;
-    allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocateInfo.pNext = nullptr;
-    allocateInfo.commandPool = cmdPool;
-    allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocateInfo.commandBufferCount = 1;
-    VULKAN_CHECK(vkAllocateCommandBuffers(device, &allocateInfo, &cmdBuffer), "Failed to allocate CommandBuffers.");
-
     vkGetDeviceQueue(device, queueFamilyIndex, queueIndex, &queue);
 
-    VkFenceCreateInfo fenceCI{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
-    fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceCI.pNext = nullptr;
-    fenceCI.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-    VULKAN_CHECK(vkCreateFence(device, &fenceCI, nullptr, &fence), "Failed to create Fence.")
+    CreateFrameContexts(frameContextCount);
+    CreateUploadQueue();
+    CreatePipelineCache(pipelineCachePath);
+}
+
+GraphicsAPI_Vulkan::~GraphicsAPI_Vulkan() {
+    VULKAN_CHECK(vkDeviceWaitIdle(device), "Failed to wait for Device.");
+    DestroyTransientBuffers();
+
+    std::cout << "VULKAN: Framebuffer cache: " << framebufferCache.size() << " framebuffers, " << framebufferCacheStatistics.hits << " hits, "
+              << framebufferCacheStatistics.misses << " misses." << std::endl;
+    for (const auto &framebuffer : framebufferCache) {
+        vkDestroyFramebuffer(device, framebuffer.second, nullptr);
+    }
+    framebufferCache.clear();
+
+    DestroyUploadQueue();
+    DestroyFrameContexts();
+    vkDestroyCommandPool(device, cmdPool, nullptr);
+    DestroyPipelineCache();
+
+    const VulkanMemoryAllocator::Statistics memoryStatistics = memoryAllocator.GetStatistics();
+    std::cout << "VULKAN: Memory: " << memoryStatistics.deviceMemoryCount << " of " << memoryStatistics.maxDeviceMemoryCount << " device memory allocations in use, "
+              << memoryStatistics.pools.size() << " pools, " << memoryStatistics.dedicatedAllocationCount << " dedicated allocations." << std::endl;
+    memoryAllocator.Destroy();
+
+    vkDestroyDevice(device, nullptr);
+    vkDestroyInstance(instance, nullptr);
+}
+// XR_DOCS_TAG_END_GraphicsAPI_Vulkan
+
+void GraphicsAPI_Vulkan::CreateFrameContexts(uint32_t count) {
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+    uint32_t queueFamilyPropertiesCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyPropertiesCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyPropertiesCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyPropertiesCount, queueFamilyProperties.data());
+    uint32_t timestampValidBits = queueFamilyProperties[queueFamilyIndex].timestampValidBits;
+    timestampPeriod = static_cast<double>(physicalDeviceProperties.limits.timestampPeriod);
+    timestampValidMask = timestampValidBits >= 64 ? UINT64_MAX : (uint64_t(1) << timestampValidBits) - 1;
+
+    frameContexts.resize(count > 0 ? count : 1);
+    for (FrameContext &frameContext : frameContexts) {
+        VkCommandBufferAllocateInfo allocateInfo;
+        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.pNext = nullptr;
+        allocateInfo.commandPool = cmdPool;
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocateInfo.commandBufferCount = 1;
+        VULKAN_CHECK(vkAllocateCommandBuffers(device, &allocateInfo, &frameContext.cmdBuffer), "Failed to allocate CommandBuffers.");
+
+        VkFenceCreateInfo fenceCI{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+        fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fenceCI.pNext = nullptr;
+        fenceCI.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+        VULKAN_CHECK(vkCreateFence(device, &fenceCI, nullptr, &frameContext.fence), "Failed to create Fence.")
+
+        frameContext.descriptorPool = CreateDescriptorPool();
+
+        if (timestampValidBits > 0) {
+            VkQueryPoolCreateInfo queryPoolCI;
+            queryPoolCI.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryPoolCI.pNext = nullptr;
+            queryPoolCI.flags = 0;
+            queryPoolCI.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryPoolCI.queryCount = frameContext.timestampQuerySet.capacity;
+            queryPoolCI.pipelineStatistics = 0;
+            VULKAN_CHECK(vkCreateQueryPool(device, &queryPoolCI, nullptr, &frameContext.timestampQueryPool), "Failed to create QueryPool.");
+        }
+    }
+    frameContextIndex = 0;
+    cmdBuffer = frameContexts[frameContextIndex].cmdBuffer;
+}
 
+VkDescriptorPool GraphicsAPI_Vulkan::CreateDescriptorPool() {
     uint32_t maxSets = 1024;
     std::vector<VkDescriptorPoolSize> poolSizes{
         {VK_DESCRIPTOR_TYPE_SAMPLER, 16 * maxSets},
         {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 16 * maxSets},
         {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 16 * maxSets},
         {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 16 * maxSets},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 16 * maxSets},
         {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 16 * maxSets}};
 
+    // DescriptorSets are never freed individually. The whole pool is reset when the FrameContext is reused in BeginRendering().
+    VkDescriptorPool descriptorPool{};
     VkDescriptorPoolCreateInfo descPoolCI;
     descPoolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     descPoolCI.pNext = nullptr;
-    descPoolCI.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    descPoolCI.flags = 0;
     descPoolCI.maxSets = maxSets;
     descPoolCI.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
     descPoolCI.pPoolSizes = poolSizes.data();
     VULKAN_CHECK(vkCreateDescriptorPool(device, &descPoolCI, nullptr, &descriptorPool), "Failed to create DescriptorPool");
+    return descriptorPool;
 }
 
-GraphicsAPI_Vulkan::~GraphicsAPI_Vulkan() {
-    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+void GraphicsAPI_Vulkan::DestroyFrameContexts() {
+    // Called after vkDeviceWaitIdle(), so the destroyed buffers and images are no longer in use.
+    for (size_t i = 0; i < frameContexts.size(); i++) {
+        ReleaseDestroyedResources(i);
+    }
+    for (FrameContext &frameContext : frameContexts) {
+        for (std::unique_ptr<ParallelCommandPool> &parallelCommandPool : frameContext.parallelCommandPools) {
+            if (parallelCommandPool) {
+                vkDestroyDescriptorPool(device, parallelCommandPool->descriptorPool, nullptr);
+                vkDestroyCommandPool(device, parallelCommandPool->cmdPool, nullptr);
+            }
+        }
+        vkDestroyQueryPool(device, frameContext.timestampQueryPool, nullptr);
+        vkDestroyDescriptorPool(device, frameContext.descriptorPool, nullptr);
+        vkDestroyFence(device, frameContext.fence, nullptr);
+        vkFreeCommandBuffers(device, cmdPool, 1, &frameContext.cmdBuffer);
+    }
+    frameContexts.clear();
+    cmdBuffer = VK_NULL_HANDLE;
+}
 
-    vkDestroyFence(device, fence, nullptr);
+void GraphicsAPI_Vulkan::CreateUploadQueue() {
+    uint32_t queueFamilyPropertiesCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyPropertiesCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyPropertiesCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyPropertiesCount, queueFamilyProperties.data());
 
-    vkFreeCommandBuffers(device, cmdPool, 1, &cmdBuffer);
-    vkDestroyCommandPool(device, cmdPool, nullptr);
+    // A transfer only queue family is usually backed by a DMA engine, which copies alongside rendering. Otherwise,
+    // upload on the graphics queue. The constructors create every queue of every family.
+    uploadQueueFamilyIndex = queueFamilyIndex;
+    for (uint32_t i = 0; i < queueFamilyPropertiesCount; i++) {
+        VkQueueFlags queueFlags = queueFamilyProperties[i].queueFlags;
+        if (BitwiseCheck(queueFlags, VkQueueFlags(VK_QUEUE_TRANSFER_BIT)) && !(queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) && queueFamilyProperties[i].queueCount > 0) {
+            uploadQueueFamilyIndex = i;
+            break;
+        }
+    }
+    vkGetDeviceQueue(device, uploadQueueFamilyIndex, uploadQueueFamilyIndex == queueFamilyIndex ? queueIndex : 0, &uploadQueue);
 
-    vkDestroyDevice(device, nullptr);
-    vkDestroyInstance(instance, nullptr);
+    VkCommandPoolCreateInfo cmdPoolCI;
+    cmdPoolCI.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    cmdPoolCI.pNext = nullptr;
+    cmdPoolCI.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    cmdPoolCI.queueFamilyIndex = uploadQueueFamilyIndex;
+    VULKAN_CHECK(vkCreateCommandPool(device, &cmdPoolCI, nullptr, &uploadCmdPool), "Failed to create CommandPool.");
+
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+    unifiedMemory = false;
+    if (physicalDeviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU) {
+        const VkMemoryPropertyFlags unifiedProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+            unifiedMemory |= BitwiseCheck(memoryProperties.memoryTypes[i].propertyFlags, unifiedProperties);
+        }
+    }
+
+    if (unifiedMemory) {
+        std::cout << "VULKAN: STATIC buffers are written directly to DEVICE_LOCAL memory." << std::endl;
+    } else {
+        std::cout << "VULKAN: STATIC buffers are uploaded on queue family " << uploadQueueFamilyIndex << (uploadQueueFamilyIndex != queueFamilyIndex ? " (transfer only)." : " (graphics).") << std::endl;
+    }
+}
+
+void GraphicsAPI_Vulkan::DestroyUploadQueue() {
+    // Called after vkDeviceWaitIdle(), so every submitted batch has finished.
+    for (size_t i = 0; i < frameContexts.size(); i++) {
+        ReleaseUploadBatches(i);
+    }
+    for (UploadBatch &uploadBatch : submittedUploadBatches) {
+        for (StagingBuffer &stagingBuffer : uploadBatch.stagingBuffers) {
+            vkDestroyBuffer(device, stagingBuffer.buffer, nullptr);
+            memoryAllocator.Free(stagingBuffer.allocation);
+        }
+        uploadBatch.stagingBuffers.clear();
+        freeUploadBatches.push_back(std::move(uploadBatch));
+    }
+    submittedUploadBatches.clear();
+    for (StagingBuffer &stagingBuffer : pendingStagingBuffers) {
+        vkDestroyBuffer(device, stagingBuffer.buffer, nullptr);
+        memoryAllocator.Free(stagingBuffer.allocation);
+    }
+    pendingStagingBuffers.clear();
+    pendingUploads.clear();
+    pendingBufferUpdates = false;
+
+    for (UploadBatch &uploadBatch : freeUploadBatches) {
+        vkDestroySemaphore(device, uploadBatch.graphicsSemaphore, nullptr);
+        vkDestroySemaphore(device, uploadBatch.semaphore, nullptr);
+        vkDestroyFence(device, uploadBatch.fence, nullptr);
+        vkFreeCommandBuffers(device, uploadCmdPool, 1, &uploadBatch.cmdBuffer);
+    }
+    freeUploadBatches.clear();
+    vkDestroyCommandPool(device, uploadCmdPool, nullptr);
+    uploadCmdPool = VK_NULL_HANDLE;
+}
+
+bool GraphicsAPI_Vulkan::QueueUpload(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, const void *data) {
+    // Copies within one submission aren't ordered against each other, so submit the earlier copies if they overlap this one.
+    for (auto it = pendingUploads.lower_bound({buffer, VkBuffer(VK_NULL_HANDLE)}); it != pendingUploads.end() && it->first.first == buffer; ++it) {
+        for (const VkBufferCopy &region : it->second) {
+            if (region.dstOffset < offset + size && offset < region.dstOffset + region.size) {
+                SubmitUploads();
+                break;
+            }
+        }
+        if (pendingUploads.empty()) {
+            break;
+        }
+    }
+
+    // Staging buffers are filled linearly and are freed together once their batch has finished, so they use the
+    // allocator's TRANSIENT blocks.
+    if (pendingStagingBuffers.empty() || pendingStagingBuffers.back().offset + size > pendingStagingBuffers.back().size) {
+        StagingBuffer stagingBuffer;
+        stagingBuffer.size = std::max<VkDeviceSize>(1024 * 1024, size);
+
+        VkBufferCreateInfo vkBufferCI;
+        vkBufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        vkBufferCI.pNext = nullptr;
+        vkBufferCI.flags = 0;
+        vkBufferCI.size = stagingBuffer.size;
+        vkBufferCI.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        vkBufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        vkBufferCI.queueFamilyIndexCount = 0;
+        vkBufferCI.pQueueFamilyIndices = nullptr;
+        VULKAN_CHECK(vkCreateBuffer(device, &vkBufferCI, nullptr, &stagingBuffer.buffer), "Failed to create staging Buffer.");
+
+        VkMemoryRequirements memoryRequirements{};
+        vkGetBufferMemoryRequirements(device, stagingBuffer.buffer, &memoryRequirements);
+        if (!memoryAllocator.Allocate(memoryRequirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, false, VulkanMemoryAllocator::Lifetime::TRANSIENT, stagingBuffer.allocation)) {
+            std::cout << "ERROR: VULKAN: Failed to allocate Memory for staging Buffer." << std::endl;
+            vkDestroyBuffer(device, stagingBuffer.buffer, nullptr);
+            return false;
+        }
+        VULKAN_CHECK(vkBindBufferMemory(device, stagingBuffer.buffer, stagingBuffer.allocation.memory, stagingBuffer.allocation.offset), "Failed to bind Memory to Buffer.");
+        pendingStagingBuffers.push_back(stagingBuffer);
+    }
+
+    StagingBuffer &stagingBuffer = pendingStagingBuffers.back();
+    memcpy(static_cast<char *>(stagingBuffer.allocation.mappedData) + stagingBuffer.offset, data, static_cast<size_t>(size));
+
+    // Coalesce with the previous copy when both the staging and destination ranges follow on from it.
+    std::vector<VkBufferCopy> &regions = pendingUploads[{buffer, stagingBuffer.buffer}];
+    if (!regions.empty() && regions.back().srcOffset + regions.back().size == stagingBuffer.offset && regions.back().dstOffset + regions.back().size == offset) {
+        regions.back().size += size;
+    } else {
+        regions.push_back({stagingBuffer.offset, offset, size});
+    }
+    stagingBuffer.offset += size;
+    return true;
+}
+
+void GraphicsAPI_Vulkan::SubmitUploads() {
+    if (pendingUploads.empty()) {
+        return;
+    }
+
+    UploadBatch uploadBatch;
+    if (!freeUploadBatches.empty()) {
+        uploadBatch = std::move(freeUploadBatches.back());
+        freeUploadBatches.pop_back();
+    } else {
+        VkCommandBufferAllocateInfo allocateInfo;
+        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.pNext = nullptr;
+        allocateInfo.commandPool = uploadCmdPool;
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocateInfo.commandBufferCount = 1;
+        VULKAN_CHECK(vkAllocateCommandBuffers(device, &allocateInfo, &uploadBatch.cmdBuffer), "Failed to allocate CommandBuffers.");
+
+        VkFenceCreateInfo fenceCI;
+        fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fenceCI.pNext = nullptr;
+        fenceCI.flags = 0;
+        VULKAN_CHECK(vkCreateFence(device, &fenceCI, nullptr, &uploadBatch.fence), "Failed to create Fence.");
+
+        VkSemaphoreCreateInfo semaphoreCI;
+        semaphoreCI.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreCI.pNext = nullptr;
+        semaphoreCI.flags = 0;
+        VULKAN_CHECK(vkCreateSemaphore(device, &semaphoreCI, nullptr, &uploadBatch.semaphore), "Failed to create Semaphore.");
+        VULKAN_CHECK(vkCreateSemaphore(device, &semaphoreCI, nullptr, &uploadBatch.graphicsSemaphore), "Failed to create Semaphore.");
+    }
+
+    VkCommandBufferBeginInfo beginInfo;
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.pNext = nullptr;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = nullptr;
+    VULKAN_CHECK(vkBeginCommandBuffer(uploadBatch.cmdBuffer, &beginInfo), "Failed to begin CommandBuffer.");
+    // Order the copies after those of earlier batches on the queue, which may have written the same ranges.
+    VkMemoryBarrier barrier;
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.pNext = nullptr;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(uploadBatch.cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VkDependencyFlags(0), 1, &barrier, 0, nullptr, 0, nullptr);
+    for (const auto &upload : pendingUploads) {
+        vkCmdCopyBuffer(uploadBatch.cmdBuffer, upload.first.second, upload.first.first, static_cast<uint32_t>(upload.second.size()), upload.second.data());
+    }
+    VULKAN_CHECK(vkEndCommandBuffer(uploadBatch.cmdBuffer), "Failed to end CommandBuffer.");
+
+    // Copies that overwrite existing contents wait for everything submitted to the graphics queue, which may still read
+    // the old contents. An empty submission's semaphore signals once all the earlier submissions have finished, without
+    // stalling the CPU.
+    VkPipelineStageFlags graphicsWaitDstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    if (pendingBufferUpdates) {
+        VkSubmitInfo graphicsSubmitInfo;
+        graphicsSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        graphicsSubmitInfo.pNext = nullptr;
+        graphicsSubmitInfo.waitSemaphoreCount = 0;
+        graphicsSubmitInfo.pWaitSemaphores = nullptr;
+        graphicsSubmitInfo.pWaitDstStageMask = nullptr;
+        graphicsSubmitInfo.commandBufferCount = 0;
+        graphicsSubmitInfo.pCommandBuffers = nullptr;
+        graphicsSubmitInfo.signalSemaphoreCount = 1;
+        graphicsSubmitInfo.pSignalSemaphores = &uploadBatch.graphicsSemaphore;
+        VULKAN_CHECK(vkQueueSubmit(queue, 1, &graphicsSubmitInfo, VK_NULL_HANDLE), "Failed to submit to Queue.");
+    }
+
+    VkSubmitInfo submitInfo;
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = nullptr;
+    submitInfo.waitSemaphoreCount = pendingBufferUpdates ? 1 : 0;
+    submitInfo.pWaitSemaphores = pendingBufferUpdates ? &uploadBatch.graphicsSemaphore : nullptr;
+    submitInfo.pWaitDstStageMask = pendingBufferUpdates ? &graphicsWaitDstStageMask : nullptr;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &uploadBatch.cmdBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &uploadBatch.semaphore;
+    VULKAN_CHECK(vkQueueSubmit(uploadQueue, 1, &submitInfo, uploadBatch.fence), "Failed to submit to Queue.");
+
+    uploadBatch.stagingBuffers = std::move(pendingStagingBuffers);
+    pendingStagingBuffers.clear();
+    pendingUploads.clear();
+    pendingBufferUpdates = false;
+    submittedUploadBatches.push_back(std::move(uploadBatch));
+}
+
+void GraphicsAPI_Vulkan::ReleaseUploadBatches(size_t index) {
+    for (UploadBatch &uploadBatch : frameContexts[index].uploadBatches) {
+        // Normally already signalled, as the graphics submission that waited on the batch has finished.
+        VULKAN_CHECK(vkWaitForFences(device, 1, &uploadBatch.fence, true, UINT64_MAX), "Failed to wait for Fence");
+        VULKAN_CHECK(vkResetFences(device, 1, &uploadBatch.fence), "Failed to reset Fence.")
+        for (StagingBuffer &stagingBuffer : uploadBatch.stagingBuffers) {
+            vkDestroyBuffer(device, stagingBuffer.buffer, nullptr);
+            memoryAllocator.Free(stagingBuffer.allocation);
+        }
+        uploadBatch.stagingBuffers.clear();
+        freeUploadBatches.push_back(std::move(uploadBatch));
+    }
+    frameContexts[index].uploadBatches.clear();
+}
+
+void GraphicsAPI_Vulkan::ReleaseDestroyedResources(size_t index) {
+    for (std::pair<VkBuffer, VulkanMemoryAllocator::Allocation> &destroyedBuffer : frameContexts[index].destroyedBuffers) {
+        vkDestroyBuffer(device, destroyedBuffer.first, nullptr);
+        memoryAllocator.Free(destroyedBuffer.second);
+    }
+    frameContexts[index].destroyedBuffers.clear();
+    for (std::pair<VkImage, VulkanMemoryAllocator::Allocation> &destroyedImage : frameContexts[index].destroyedImages) {
+        vkDestroyImage(device, destroyedImage.first, nullptr);
+        memoryAllocator.Free(destroyedImage.second);
+    }
+    frameContexts[index].destroyedImages.clear();
+}
+
+void GraphicsAPI_Vulkan::CreatePipelineCache(const std::string &path) {
+    auto start = std::chrono::steady_clock::now();
+    pipelineCachePath = path;
+
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+
+    std::vector<char> data;
+    if (!pipelineCachePath.empty()) {
+        std::ifstream file(pipelineCachePath, std::ios::binary);
+        if (file.is_open()) {
+            PipelineCacheFileHeader header{};
+            file.read(reinterpret_cast<char *>(&header), sizeof(header));
+            if (file && header.dataSize <= (uint64_t(1) << 30)) {
+                data.resize(static_cast<size_t>(header.dataSize));
+                file.read(data.data(), static_cast<std::streamsize>(data.size()));
+                data.resize(static_cast<size_t>(file.gcount()));
+            }
+            const char *reason = ValidatePipelineCacheData(MakePipelineCacheFileHeader(physicalDeviceProperties, 0), header, data);
+            if (reason) {
+                std::cout << "VULKAN: Ignoring pipeline cache " << pipelineCachePath << ": " << reason << "." << std::endl;
+                data.clear();
+            }
+        }
+    }
+
+    VkPipelineCacheCreateInfo pipelineCacheCI;
+    pipelineCacheCI.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    pipelineCacheCI.pNext = nullptr;
+    pipelineCacheCI.flags = 0;
+    pipelineCacheCI.initialDataSize = data.size();
+    pipelineCacheCI.pInitialData = data.empty() ? nullptr : data.data();
+    VULKAN_CHECK(vkCreatePipelineCache(device, &pipelineCacheCI, nullptr, &pipelineCache), "Failed to create PipelineCache.");
+
+    pipelineCacheStatistics.loaded = !data.empty();
+    pipelineCacheStatistics.loadedSize = data.size();
+    pipelineCacheStatistics.loadMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (pipelineCacheStatistics.loaded) {
+        std::cout << "VULKAN: Loaded " << data.size() << " bytes of pipeline cache from " << pipelineCachePath << " in " << pipelineCacheStatistics.loadMilliseconds << " ms." << std::endl;
+    }
+}
+
+void GraphicsAPI_Vulkan::DestroyPipelineCache() {
+    const PipelineCacheStatistics &statistics = pipelineCacheStatistics;
+    std::cout << "VULKAN: Pipeline cache: " << (statistics.loaded ? "warm" : "cold") << " start, loaded in " << statistics.loadMilliseconds << " ms. "
+              << statistics.pipelineCount << " pipelines created in " << statistics.createMilliseconds << " ms";
+    if (statistics.feedbackEnabled) {
+        std::cout << ", " << statistics.pipelines.hits << " cache hits, " << statistics.pipelines.misses << " misses";
+    }
+    std::cout << "." << std::endl;
+
+    if (!pipelineCachePath.empty()) {
+        size_t dataSize = 0;
+        VULKAN_CHECK(vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr), "Failed to get PipelineCache data size.");
+        std::vector<char> data(dataSize);
+        if (dataSize > 0 && vkGetPipelineCacheData(device, pipelineCache, &dataSize, data.data()) == VK_SUCCESS) {
+            VkPhysicalDeviceProperties physicalDeviceProperties;
+            vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+            PipelineCacheFileHeader header = MakePipelineCacheFileHeader(physicalDeviceProperties, dataSize);
+
+            // Write to a temporary file first, so that being killed part way through can't leave a corrupt cache behind.
+            const std::string temporaryPath = pipelineCachePath + ".tmp";
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(data.data(), static_cast<std::streamsize>(dataSize));
+            file.close();
+            if (file) {
+                std::remove(pipelineCachePath.c_str());
+                if (std::rename(temporaryPath.c_str(), pipelineCachePath.c_str()) != 0) {
+                    std::cout << "ERROR: VULKAN: Failed to rename " << temporaryPath << " to " << pipelineCachePath << "." << std::endl;
+                }
+            } else {
+                std::cout << "ERROR: VULKAN: Failed to write pipeline cache to " << temporaryPath << "." << std::endl;
+                std::remove(temporaryPath.c_str());
+            }
+        }
+    }
+
+    vkDestroyPipelineCache(device, pipelineCache, nullptr);
+    pipelineCache = VK_NULL_HANDLE;
 }
-// XR_DOCS_TAG_END_GraphicsAPI_Vulkan
 
 void *GraphicsAPI_Vulkan::CreateDesktopSwapchain(const SwapchainCreateInfo &swapchainCI) {
     VkSurfaceKHR surface{};
@@ -608,20 +1410,15 @@ void *GraphicsAPI_Vulkan::CreateImage(const ImageCreateInfo &imageCI) {
     VkMemoryRequirements memoryRequirements{};
     vkGetImageMemoryRequirements(device, image, &memoryRequirements);
 
-    VkDeviceMemory memory{};
-    VkMemoryAllocateInfo allocateInfo;
-    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocateInfo.pNext = nullptr;
-    allocateInfo.allocationSize = memoryRequirements.size;
-
-    VkPhysicalDeviceMemoryProperties physicalDeviceMemoryProperties{};
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &physicalDeviceMemoryProperties);
-    MemoryTypeFromProperties(physicalDeviceMemoryProperties, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &allocateInfo.memoryTypeIndex);
-
-    VULKAN_CHECK(vkAllocateMemory(device, &allocateInfo, nullptr, &memory), "Failed to allocate Memory.");
-    VULKAN_CHECK(vkBindImageMemory(device, image, memory, 0), "Failed to bind Memory to Image.");
+    VulkanMemoryAllocator::Allocation allocation;
+    if (!memoryAllocator.Allocate(memoryRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true, VulkanMemoryAllocator::Lifetime::PERSISTENT, allocation)) {
+        std::cout << "ERROR: VULKAN: Failed to allocate Memory for Image." << std::endl;
+        vkDestroyImage(device, image, nullptr);
+        return nullptr;
+    }
+    VULKAN_CHECK(vkBindImageMemory(device, image, allocation.memory, allocation.offset), "Failed to bind Memory to Image.");
 
-    imageResources[image] = {memory, imageCI};
+    imageResources[image] = {allocation, imageCI};
     imageStates[image] = vkImageCI.initialLayout;
 
     return (void *)image;
@@ -629,10 +1426,15 @@ void *GraphicsAPI_Vulkan::CreateImage(const ImageCreateInfo &imageCI) {
 
 void GraphicsAPI_Vulkan::DestroyImage(void *&image) {
     VkImage vkImage = (VkImage)image;
-    VkDeviceMemory memory = imageResources[vkImage].first;
-    vkFreeMemory(device, memory, nullptr);
-    vkDestroyImage(device, vkImage, nullptr);
-    imageResources.erase(vkImage);
+    auto it = imageResources.find(vkImage);
+    if (it == imageResources.end()) {
+        std::cout << "ERROR: VULKAN: Unknown Image." << std::endl;
+        return;
+    }
+    // As with buffers, submissions in flight may still use the image, so it's destroyed once the current FrameContext's
+    // fence has signalled.
+    frameContexts[frameContextIndex].destroyedImages.push_back({vkImage, it->second.first});
+    imageResources.erase(it);
     imageStates.erase(vkImage);
     image = nullptr;
 }
@@ -660,6 +1462,7 @@ void *GraphicsAPI_Vulkan::CreateImageView(const ImageViewCreateInfo &imageViewCI
 
 void GraphicsAPI_Vulkan::DestroyImageView(void *&imageView) {
     VkImageView vkImageView = (VkImageView)imageView;
+    DestroyCachedFramebuffers((uint64_t)vkImageView);
     vkDestroyImageView(device, vkImageView, nullptr);
     imageViewResources.erase(vkImageView);
     imageView = nullptr;
@@ -700,6 +1503,11 @@ void GraphicsAPI_Vulkan::DestroySampler(void *&sampler) {
 }
 
 void *GraphicsAPI_Vulkan::CreateBuffer(const BufferCreateInfo &bufferCI) {
+    // STATIC buffers go in DEVICE_LOCAL memory and are written through the upload queue, unless that memory is also host visible.
+    const bool deviceLocal = bufferCI.usage == BufferCreateInfo::Usage::STATIC;
+    const bool staged = deviceLocal && !unifiedMemory;
+    uint32_t queueFamilyIndices[2] = {queueFamilyIndex, uploadQueueFamilyIndex};
+
     VkBuffer buffer{};
     VkBufferCreateInfo vkBufferCI;
     vkBufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -707,39 +1515,54 @@ void *GraphicsAPI_Vulkan::CreateBuffer(const BufferCreateInfo &bufferCI) {
     vkBufferCI.flags = 0;
     vkBufferCI.size = static_cast<VkDeviceSize>(bufferCI.size);
     vkBufferCI.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | (bufferCI.type == BufferCreateInfo::Type::VERTEX ? VK_BUFFER_USAGE_VERTEX_BUFFER_BIT : 0) | (bufferCI.type == BufferCreateInfo::Type::INDEX ? VK_BUFFER_USAGE_INDEX_BUFFER_BIT : 0) | (bufferCI.type == BufferCreateInfo::Type::UNIFORM ? VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT : 0);
-    vkBufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    vkBufferCI.queueFamilyIndexCount = 0;
-    vkBufferCI.pQueueFamilyIndices = nullptr;
+    // Shared with the upload queue's family rather than transferring ownership after every upload.
+    const bool concurrent = staged && uploadQueueFamilyIndex != queueFamilyIndex;
+    vkBufferCI.sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+    vkBufferCI.queueFamilyIndexCount = concurrent ? 2 : 0;
+    vkBufferCI.pQueueFamilyIndices = concurrent ? queueFamilyIndices : nullptr;
     vkCreateBuffer(device, &vkBufferCI, nullptr, &buffer);
 
     VkMemoryRequirements memoryRequirements{};
     vkGetBufferMemoryRequirements(device, buffer, &memoryRequirements);
 
-    VkDeviceMemory memory{};
-    VkMemoryAllocateInfo allocateInfo;
-    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocateInfo.pNext = nullptr;
-    allocateInfo.allocationSize = memoryRequirements.size;
-
-    VkPhysicalDeviceMemoryProperties physicalDeviceMemoryProperties{};
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &physicalDeviceMemoryProperties);
-    MemoryTypeFromProperties(physicalDeviceMemoryProperties, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &allocateInfo.memoryTypeIndex);
-
-    VULKAN_CHECK(vkAllocateMemory(device, &allocateInfo, nullptr, &memory), "Failed to allocate Memory.");
-    VULKAN_CHECK(vkBindBufferMemory(device, buffer, memory, 0), "Failed to bind Memory to Buffer.");
+    // The allocator keeps host visible memory persistently mapped, so that SetBufferData() is just a memcpy().
+    VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    if (deviceLocal) {
+        properties = staged ? VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) : properties | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    }
+    VulkanMemoryAllocator::Allocation allocation;
+    if (!memoryAllocator.Allocate(memoryRequirements, properties, false, VulkanMemoryAllocator::Lifetime::PERSISTENT, allocation)) {
+        std::cout << "ERROR: VULKAN: Failed to allocate Memory for Buffer." << std::endl;
+        vkDestroyBuffer(device, buffer, nullptr);
+        return nullptr;
+    }
+    VULKAN_CHECK(vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset), "Failed to bind Memory to Buffer.");
 
-    bufferResources[buffer] = {memory, bufferCI};
-    SetBufferData((void *)buffer, 0, bufferCI.size, bufferCI.data);
+    bufferResources[buffer] = {allocation, bufferCI};
+    if (allocation.mappedData) {
+        SetBufferData((void *)buffer, 0, bufferCI.size, bufferCI.data);
+    } else if (bufferCI.data) {
+        QueueUpload(buffer, 0, static_cast<VkDeviceSize>(bufferCI.size), bufferCI.data);
+    }
 
     return (void *)buffer;
 }
 
 void GraphicsAPI_Vulkan::DestroyBuffer(void *&buffer) {
     VkBuffer vkBuffer = (VkBuffer)buffer;
-    VkDeviceMemory memory = bufferResources[vkBuffer].first;
-    vkFreeMemory(device, memory, nullptr);
-    vkDestroyBuffer(device, vkBuffer, nullptr);
-    bufferResources.erase(vkBuffer);
+    auto it = bufferResources.find(vkBuffer);
+    if (it == bufferResources.end()) {
+        std::cout << "ERROR: VULKAN: Unknown Buffer." << std::endl;
+        return;
+    }
+    // Drop the copies into the buffer that haven't been submitted. Their staging memory is freed with the rest of its batch.
+    for (auto upload = pendingUploads.lower_bound({vkBuffer, VkBuffer(VK_NULL_HANDLE)}); upload != pendingUploads.end() && upload->first.first == vkBuffer;) {
+        upload = pendingUploads.erase(upload);
+    }
+    // Submissions in flight may still read the buffer. Fences signal in submission order, so once the current
+    // FrameContext's fence has signalled, so have those of every earlier submission.
+    frameContexts[frameContextIndex].destroyedBuffers.push_back({vkBuffer, it->second.first});
+    bufferResources.erase(it);
     buffer = nullptr;
 }
 
@@ -753,6 +1576,7 @@ void *GraphicsAPI_Vulkan::CreateShader(const ShaderCreateInfo &shaderCI) {
     shaderModuleCI.pCode = reinterpret_cast<const uint32_t *>(shaderCI.sourceData);
     VULKAN_CHECK(vkCreateShaderModule(device, &shaderModuleCI, nullptr, &shaderModule), "Failed to create ShaderModule.");
 
+    std::lock_guard<std::mutex> lock(pipelineMutex);
     shaderResources[shaderModule] = shaderCI;
     return (void *)shaderModule;
 }
@@ -825,6 +1649,30 @@ void *GraphicsAPI_Vulkan::CreatePipeline(const PipelineCreateInfo &pipelineCI) {
     VkRenderPassCreateInfo renderPassCI;
     renderPassCI.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     renderPassCI.pNext = nullptr;
+    if (pipelineCI.viewMask != 0 && !multiviewSupported) {
+        std::cout << "ERROR: VULKAN: PipelineCreateInfo::viewMask is set, but VK_KHR_multiview isn't supported." << std::endl;
+        return nullptr;
+    }
+#if defined(VK_KHR_multiview)
+    // Each view is drawn to the layer of the attachments with the same index. The views are spatially correlated, so the
+    // implementation may render them concurrently.
+    VkRenderPassMultiviewCreateInfoKHR multiviewCI;
+    multiviewCI.sType = VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO_KHR;
+    multiviewCI.pNext = nullptr;
+    multiviewCI.subpassCount = 1;
+    multiviewCI.pViewMasks = &pipelineCI.viewMask;
+    multiviewCI.dependencyCount = 0;
+    multiviewCI.pViewOffsets = nullptr;
+    multiviewCI.correlationMaskCount = 1;
+    multiviewCI.pCorrelationMasks = &pipelineCI.viewMask;
+    if (pipelineCI.viewMask != 0) {
+        renderPassCI.pNext = &multiviewCI;
+        uint32_t viewCount = ViewCount(pipelineCI.viewMask);
+        uint32_t maxViewCount = maxMultiviewViewCount.load();
+        while (viewCount > maxViewCount && !maxMultiviewViewCount.compare_exchange_weak(maxViewCount, viewCount)) {
+        }
+    }
+#endif
     renderPassCI.flags = 0;
     renderPassCI.attachmentCount = static_cast<uint32_t>(attachmentDescriptions.size());
     renderPassCI.pAttachments = attachmentDescriptions.data();
@@ -871,11 +1719,16 @@ void *GraphicsAPI_Vulkan::CreatePipeline(const PipelineCreateInfo &pipelineCI) {
     vkShaderStages.reserve(pipelineCI.shaders.size());
     for (auto &shader : pipelineCI.shaders) {
         VkShaderModule shaderModule = (VkShaderModule)shader;
+        ShaderCreateInfo::Type shaderType;
+        {
+            std::lock_guard<std::mutex> lock(pipelineMutex);
+            shaderType = shaderResources[shaderModule].type;
+        }
         VkPipelineShaderStageCreateInfo shaderStageCI;
         shaderStageCI.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         shaderStageCI.pNext = nullptr;
         shaderStageCI.flags = 0;
-        shaderStageCI.stage = static_cast<VkShaderStageFlagBits>(1 << (uint32_t)shaderResources[shaderModule].type);
+        shaderStageCI.stage = static_cast<VkShaderStageFlagBits>(1 << (uint32_t)shaderType);
         shaderStageCI.module = shaderModule;
         shaderStageCI.pName = "main";
         shaderStageCI.pSpecializationInfo = nullptr;
@@ -886,7 +1739,7 @@ void *GraphicsAPI_Vulkan::CreatePipeline(const PipelineCreateInfo &pipelineCI) {
     std::vector<VkVertexInputBindingDescription> vkVertexInputBindingDescriptions;
     vkVertexInputBindingDescriptions.reserve(pipelineCI.vertexInputState.bindings.size());
     for (auto &binding : pipelineCI.vertexInputState.bindings)
-        vkVertexInputBindingDescriptions.push_back({binding.bindingIndex, (uint32_t)binding.stride, VK_VERTEX_INPUT_RATE_VERTEX});
+        vkVertexInputBindingDescriptions.push_back({binding.bindingIndex, (uint32_t)binding.stride, binding.inputRate == VertexInputRate::INSTANCE ? VK_VERTEX_INPUT_RATE_INSTANCE : VK_VERTEX_INPUT_RATE_VERTEX});
 
     std::vector<VkVertexInputAttributeDescription> vkVertexInputAttributeDescriptions;
     vkVertexInputAttributeDescriptions.reserve(pipelineCI.vertexInputState.attributes.size());
@@ -1047,7 +1900,34 @@ void *GraphicsAPI_Vulkan::CreatePipeline(const PipelineCreateInfo &pipelineCI) {
     GPCI.basePipelineHandle = VK_NULL_HANDLE;
     GPCI.basePipelineIndex = -1;
 
-    VULKAN_CHECK(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &GPCI, nullptr, &pipeline), "Failed to create Graphics Pipeline.");
+#if defined(VK_EXT_pipeline_creation_feedback)
+    VkPipelineCreationFeedbackEXT creationFeedback{};
+    VkPipelineCreationFeedbackCreateInfoEXT creationFeedbackCI;
+    creationFeedbackCI.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+    creationFeedbackCI.pNext = nullptr;
+    creationFeedbackCI.pPipelineCreationFeedback = &creationFeedback;
+    creationFeedbackCI.pipelineStageCreationFeedbackCount = 0;
+    creationFeedbackCI.pPipelineStageCreationFeedbacks = nullptr;
+    // Only written while the device is created.
+    if (pipelineCacheStatistics.feedbackEnabled) {
+        GPCI.pNext = &creationFeedbackCI;
+    }
+#endif
+
+    auto start = std::chrono::steady_clock::now();
+    VULKAN_CHECK(vkCreateGraphicsPipelines(device, pipelineCache, 1, &GPCI, nullptr, &pipeline), "Failed to create Graphics Pipeline.");
+    std::lock_guard<std::mutex> lock(pipelineMutex);
+    pipelineCacheStatistics.createMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    pipelineCacheStatistics.pipelineCount++;
+#if defined(VK_EXT_pipeline_creation_feedback)
+    if (creationFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT) {
+        if (creationFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT) {
+            pipelineCacheStatistics.pipelines.hits++;
+        } else {
+            pipelineCacheStatistics.pipelines.misses++;
+        }
+    }
+#endif
     pipelineResources[pipeline] = {pipelineLayout, descSetLayout, renderPass, pipelineCI};
 
     return (void *)pipeline;
@@ -1055,30 +1935,65 @@ void *GraphicsAPI_Vulkan::CreatePipeline(const PipelineCreateInfo &pipelineCI) {
 
 void GraphicsAPI_Vulkan::DestroyPipeline(void *&pipeline) {
     VkPipeline vkPipeline = (VkPipeline)pipeline;
+    std::unique_lock<std::mutex> lock(pipelineMutex);
     VkPipelineLayout pipelineLayout = std::get<0>(pipelineResources[vkPipeline]);
     VkDescriptorSetLayout descSetLayout = std::get<1>(pipelineResources[vkPipeline]);
     VkRenderPass renderPass = std::get<2>(pipelineResources[vkPipeline]);
+    pipelineResources.erase(vkPipeline);
+    lock.unlock();
+    DestroyCachedFramebuffers((uint64_t)renderPass);
     vkDestroyRenderPass(device, renderPass, nullptr);
     vkDestroyDescriptorSetLayout(device, descSetLayout, nullptr);
     vkDestroyPipeline(device, vkPipeline, nullptr);
-    pipelineResources.erase(vkPipeline);
     pipeline = nullptr;
 }
 
 void GraphicsAPI_Vulkan::BeginRendering() {
-    VULKAN_CHECK(vkWaitForFences(device, 1, &fence, true, UINT64_MAX), "Failed to wait for Fence");
-    VULKAN_CHECK(vkResetFences(device, 1, &fence), "Failed to reset Fence.")
-
-    // VULKAN_CHECK(vkResetDescriptorPool(device, descriptorPool, VkDescriptorPoolResetFlags(0)), "Failed to rest DescriptorPool")
-    for (const auto &descSet : cmdBufferDescriptorSets[cmdBuffer]) {
-        VULKAN_CHECK(vkFreeDescriptorSets(device, descriptorPool, 1, &descSet), "Failed to free DescriptorSet.");
+    // Move on to the next FrameContext. Only the submission that last used it needs to have finished,
+    // so the GPU can still be executing the other FrameContexts while we record this one.
+    frameContextIndex = (frameContextIndex + 1) % frameContexts.size();
+    FrameContext &frameContext = frameContexts[frameContextIndex];
+    cmdBuffer = frameContext.cmdBuffer;
+
+    VULKAN_CHECK(vkWaitForFences(device, 1, &frameContext.fence, true, UINT64_MAX), "Failed to wait for Fence");
+    VULKAN_CHECK(vkResetFences(device, 1, &frameContext.fence), "Failed to reset Fence.")
+    ReleaseUploadBatches(frameContextIndex);
+    ReleaseDestroyedResources(frameContextIndex);
+
+    // The GPU has finished with this FrameContext, so its region of transient data can be overwritten. The buffers are
+    // created here rather than by their first allocation, which may be made while recording in parallel.
+    for (TransientBuffer *transientBuffer : {&transientUniformBuffer, &transientVertexBuffer}) {
+        if (!transientBuffer->buffer && transientBuffer->size > 0) {
+            // The buffer holds one region of transientBuffer.size per FrameContext.
+            transientBuffer->buffer = CreateBuffer({transientBuffer->type, 0, transientBuffer->size * frameContexts.size(), nullptr, BufferCreateInfo::Usage::STREAM});
+        }
+        transientBuffer->offset = 0;
     }
-    cmdBufferDescriptorSets.erase(cmdBuffer);
 
-    for (const VkFramebuffer &framebuffer : cmdBufferFramebuffers[cmdBuffer]) {
-        vkDestroyFramebuffer(device, framebuffer, nullptr);
+    VULKAN_CHECK(vkResetDescriptorPool(device, frameContext.descriptorPool, VkDescriptorPoolResetFlags(0)), "Failed to reset DescriptorPool.")
+    frameContext.descriptorSetCache.clear();
+    for (std::unique_ptr<ParallelCommandPool> &parallelCommandPool : frameContext.parallelCommandPools) {
+        if (parallelCommandPool) {
+            VULKAN_CHECK(vkResetCommandPool(device, parallelCommandPool->cmdPool, VkCommandPoolResetFlags(0)), "Failed to reset CommandPool.");
+            parallelCommandPool->usedCmdBufferCount = 0;
+            VULKAN_CHECK(vkResetDescriptorPool(device, parallelCommandPool->descriptorPool, VkDescriptorPoolResetFlags(0)), "Failed to reset DescriptorPool.")
+            parallelCommandPool->descriptorSetCache.clear();
+        }
+    }
+    primaryCommandContext.cmdBuffer = cmdBuffer;
+    primaryCommandContext.descriptorPool = frameContext.descriptorPool;
+    primaryCommandContext.descriptorSetCache = &frameContext.descriptorSetCache;
+
+    // The fence has signalled, so the timestamps of the FrameContext's last submission are available without waiting.
+    TimestampQuerySet &querySet = frameContext.timestampQuerySet;
+    if (querySet.pending) {
+        VkResult result = vkGetQueryPoolResults(device, frameContext.timestampQueryPool, 0, querySet.count, querySet.count * sizeof(uint64_t), querySet.timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+        if (result == VK_SUCCESS) {
+            ResolveTimestampQueries(querySet, timestampPeriod, timestampValidMask);
+        }
     }
-    cmdBufferFramebuffers.erase(cmdBuffer);
+    ResetTimestampQuerySet(querySet);
+    querySet.queriesPerTimestamp = maxMultiviewViewCount.load();
 
     VULKAN_CHECK(vkResetCommandBuffer(cmdBuffer, VkCommandBufferResetFlagBits(0)), "Failed to reset CommandBuffer.");
 
@@ -1089,6 +2004,10 @@ void GraphicsAPI_Vulkan::BeginRendering() {
     beginInfo.pInheritanceInfo = nullptr;
     VULKAN_CHECK(vkBeginCommandBuffer(cmdBuffer, &beginInfo), "Failed to begin CommandBuffer.");
 
+    if (frameContext.timestampQueryPool) {
+        vkCmdResetQueryPool(cmdBuffer, frameContext.timestampQueryPool, 0, querySet.capacity);
+    }
+
     if (currentDesktopSwapchainImage) {
         VkImageMemoryBarrier barrier;
         barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -1109,10 +2028,17 @@ void GraphicsAPI_Vulkan::BeginRendering() {
 }
 
 void GraphicsAPI_Vulkan::EndRendering() {
-    if (inRenderPass) {
-        vkCmdEndRenderPass(cmdBuffer);
-        inRenderPass = false;
+    // Close any scopes left open, so every query in the submission is written.
+    while (!frameContexts[frameContextIndex].timestampQuerySet.openScopes.empty()) {
+        EndTimestampScope();
+    }
+
+    if (!recordedParallelCommands.empty()) {
+        std::cout << "ERROR: VULKAN: EndRendering() called before ExecuteParallelCommands(). The parallel commands are dropped." << std::endl;
+        recordedParallelCommands.clear();
     }
+    EndRenderPass();
+    renderPassState = RenderPassState::NONE;
 
     if (currentDesktopSwapchainImage) {
         VkImageMemoryBarrier barrier;
@@ -1134,35 +2060,116 @@ void GraphicsAPI_Vulkan::EndRendering() {
 
     VULKAN_CHECK(vkEndCommandBuffer(cmdBuffer), "Failed to end CommandBuffer.");
 
-    VkPipelineStageFlags waitDstStageMask = VkPipelineStageFlagBits::VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    TimestampQuerySet &querySet = frameContexts[frameContextIndex].timestampQuerySet;
+    querySet.pending = querySet.count > 0;
+
+    std::vector<VkSemaphore> waitSemaphores;
+    std::vector<VkPipelineStageFlags> waitDstStageMasks;
+    if (acquireSemaphore) {
+        waitSemaphores.push_back(acquireSemaphore);
+        waitDstStageMasks.push_back(VkPipelineStageFlagBits::VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+    }
+    // Wait for any uploads into STATIC buffers before they are read, and keep their staging buffers until the FrameContext's fence.
+    SubmitUploads();
+    FrameContext &frameContext = frameContexts[frameContextIndex];
+    for (UploadBatch &uploadBatch : submittedUploadBatches) {
+        waitSemaphores.push_back(uploadBatch.semaphore);
+        waitDstStageMasks.push_back(VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        frameContext.uploadBatches.push_back(std::move(uploadBatch));
+    }
+    submittedUploadBatches.clear();
 
     VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     submitInfo.pNext = nullptr;
-    submitInfo.waitSemaphoreCount = acquireSemaphore ? 1 : 0;
-    submitInfo.pWaitSemaphores = acquireSemaphore ? &acquireSemaphore : nullptr;
-    submitInfo.pWaitDstStageMask = acquireSemaphore ? &waitDstStageMask : nullptr;
+    submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitDstStageMasks.data();
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &cmdBuffer;
     submitInfo.signalSemaphoreCount = submitSemaphore ? 1 : 0;
     submitInfo.pSignalSemaphores = submitSemaphore ? &submitSemaphore : nullptr;
 
-    VULKAN_CHECK(vkQueueSubmit(queue, 1, &submitInfo, fence), "Failed to submit to Queue.");
+    VULKAN_CHECK(vkQueueSubmit(queue, 1, &submitInfo, frameContext.fence), "Failed to submit to Queue.");
 }
 
 void GraphicsAPI_Vulkan::SetBufferData(void *buffer, size_t offset, size_t size, void *data) {
     VkBuffer vkBuffer = (VkBuffer)buffer;
-    VkDeviceMemory memory = bufferResources[vkBuffer].first;
-    void *mappedData = nullptr;
-    VULKAN_CHECK(vkMapMemory(device, memory, offset, size, 0, &mappedData), "Can not map Buffer.");
+    // Called by threads recording in parallel, so bufferResources must only be read.
+    const auto &constBufferResources = bufferResources;
+    auto it = constBufferResources.find(vkBuffer);
+    if (it == constBufferResources.end()) {
+        std::cout << "ERROR: VULKAN: Unknown Buffer." << std::endl;
+        return;
+    }
+    char *mappedData = reinterpret_cast<char *>(it->second.first.mappedData);
     if (mappedData && data) {
-        memcpy(mappedData, data, size);
+        memcpy(mappedData + offset, data, size);
         // Because the VkDeviceMemory use a heap with properties (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
         // We don't need to use vkFlushMappedMemoryRanges() or vkInvalidateMappedMemoryRanges()
+    } else if (data) {
+        // A DEVICE_LOCAL buffer. Submissions in flight may still read it, so its upload batch waits for the graphics queue.
+        pendingBufferUpdates = true;
+        QueueUpload(vkBuffer, static_cast<VkDeviceSize>(offset), static_cast<VkDeviceSize>(size), data);
     }
-    vkUnmapMemory(device, memory);
 };
 
+void GraphicsAPI_Vulkan::BeginTimestampScope(const std::string &name) {
+    FrameContext &frameContext = frameContexts[frameContextIndex];
+    uint32_t query = 0;
+    if (frameContext.timestampQueryPool && BeginTimestampQuery(frameContext.timestampQuerySet, name, query)) {
+        WriteTimestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, query);
+    }
+}
+
+void GraphicsAPI_Vulkan::EndTimestampScope() {
+    FrameContext &frameContext = frameContexts[frameContextIndex];
+    uint32_t query = 0;
+    if (frameContext.timestampQueryPool && EndTimestampQuery(frameContext.timestampQuerySet, query)) {
+        WriteTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, query);
+    }
+}
+
+void GraphicsAPI_Vulkan::WriteTimestamp(VkPipelineStageFlagBits stage, uint32_t query) {
+    // Inside a multiview render pass, one timestamp writes a query for each view, starting at query. Every query of the
+    // block is written, even outside a render pass, as vkGetQueryPoolResults() fails if any of them are unavailable. If
+    // a render pass has more views than the block has queries, because its pipeline was created during this frame, the
+    // timestamp is skipped and the submission's results are dropped. A render pass begun for secondary CommandBuffers
+    // can't contain anything else, so it is ended first.
+    if (renderPassState == RenderPassState::SECONDARY) {
+        EndRenderPass();
+    }
+    FrameContext &frameContext = frameContexts[frameContextIndex];
+    uint32_t queriesPerTimestamp = frameContext.timestampQuerySet.queriesPerTimestamp;
+    for (uint32_t i = 0; i + renderPassViewCount <= queriesPerTimestamp; i += renderPassViewCount) {
+        vkCmdWriteTimestamp(cmdBuffer, stage, frameContext.timestampQueryPool, query + i);
+    }
+}
+
+GraphicsAPI::TransientAllocation GraphicsAPI_Vulkan::AllocateTransientData(TransientBuffer &transientBuffer, size_t size, const void *data) {
+    // Unlike the base class, don't wrap around: that would overwrite data referenced by the CommandBuffer being recorded.
+    size_t alignedSize = Align<size_t>(size, transientAlignment);
+    std::unique_lock<std::mutex> lock(transientMutex);
+    if (transientBuffer.offset + alignedSize > transientBuffer.size) {
+        std::cout << "ERROR: VULKAN: Out of transient memory for this frame. Reserve a larger size with ReserveTransientUniformData() or ReserveTransientVertexData()." << std::endl;
+        DEBUG_BREAK;
+        return {nullptr, 0, 0};
+    }
+
+    // BeginRendering() creates the buffer, which holds one region of transientBuffer.size per FrameContext.
+    if (!transientBuffer.buffer) {
+        std::cout << "ERROR: VULKAN: Transient data can only be allocated between BeginRendering() and EndRendering()." << std::endl;
+        return {nullptr, 0, 0};
+    }
+
+    TransientAllocation allocation = {transientBuffer.buffer, frameContextIndex * transientBuffer.size + transientBuffer.offset, size};
+    transientBuffer.offset += alignedSize;
+    lock.unlock();
+    // The buffer is persistently mapped, so threads can copy into their own regions concurrently.
+    SetBufferData(allocation.buffer, allocation.offset, size, const_cast<void *>(data));
+    return allocation;
+}
+
 void GraphicsAPI_Vulkan::ClearColor(void *imageView, float r, float g, float b, float a) {
     const ImageViewCreateInfo &imageViewCI = imageViewResources[(VkImageView)imageView];
 
@@ -1250,11 +2257,20 @@ void GraphicsAPI_Vulkan::ClearDepth(void *imageView, float d) {
 }
 
 void GraphicsAPI_Vulkan::SetRenderAttachments(void **colorViews, size_t colorViewCount, void *depthStencilView, uint32_t width, uint32_t height, void *pipeline) {
-    if (inRenderPass) {
-        vkCmdEndRenderPass(cmdBuffer);
-    }
+    EndRenderPass();
 
-    VkRenderPass renderPass = std::get<2>(pipelineResources[(VkPipeline)pipeline]);
+    VkRenderPass renderPass{};
+    uint32_t viewMask = 0;
+    {
+        std::lock_guard<std::mutex> lock(pipelineMutex);
+        auto it = pipelineResources.find((VkPipeline)pipeline);
+        if (it == pipelineResources.end()) {
+            std::cout << "ERROR: VULKAN: Unknown Pipeline." << std::endl;
+            return;
+        }
+        renderPass = std::get<2>(it->second);
+        viewMask = std::get<3>(it->second).viewMask;
+    }
 
     std::vector<VkImageView> vkImageViews;
     for (size_t i = 0; i < colorViewCount; i++) {
@@ -1264,32 +2280,201 @@ void GraphicsAPI_Vulkan::SetRenderAttachments(void **colorViews, size_t colorVie
         vkImageViews.push_back((VkImageView)depthStencilView);
     }
 
+    std::vector<uint64_t> key = {(uint64_t)renderPass, width, height};
+    for (const VkImageView &imageView : vkImageViews) {
+        key.push_back((uint64_t)imageView);
+    }
+
     VkFramebuffer framebuffer{};
-    VkFramebufferCreateInfo framebufferCI;
-    framebufferCI.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-    framebufferCI.pNext = nullptr;
-    framebufferCI.flags = 0;
-    framebufferCI.renderPass = renderPass;
-    framebufferCI.attachmentCount = static_cast<uint32_t>(vkImageViews.size());
-    framebufferCI.pAttachments = vkImageViews.data();
-    framebufferCI.width = width;
-    framebufferCI.height = height;
-    framebufferCI.layers = 1;
-    VULKAN_CHECK(vkCreateFramebuffer(device, &framebufferCI, nullptr, &framebuffer), "Failed to create Framebuffer");
-    cmdBufferFramebuffers[cmdBuffer].push_back(framebuffer);
+    auto it = framebufferCache.find(key);
+    if (it != framebufferCache.end()) {
+        framebuffer = it->second;
+        framebufferCacheStatistics.hits++;
+    } else {
+        VkFramebufferCreateInfo framebufferCI;
+        framebufferCI.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferCI.pNext = nullptr;
+        framebufferCI.flags = 0;
+        framebufferCI.renderPass = renderPass;
+        framebufferCI.attachmentCount = static_cast<uint32_t>(vkImageViews.size());
+        framebufferCI.pAttachments = vkImageViews.data();
+        framebufferCI.width = width;
+        framebufferCI.height = height;
+        framebufferCI.layers = 1;
+        VULKAN_CHECK(vkCreateFramebuffer(device, &framebufferCI, nullptr, &framebuffer), "Failed to create Framebuffer");
+        framebufferCache[key] = framebuffer;
+        framebufferCacheStatistics.misses++;
+    }
+
+    // The render pass is begun by the first command recorded into it.
+    currentRenderPass = renderPass;
+    currentFramebuffer = framebuffer;
+    currentRenderArea = {width, height};
+    currentViewMask = viewMask;
+    renderPassState = RenderPassState::PENDING;
+}
+
+void GraphicsAPI_Vulkan::BeginRenderPass(RenderPassState contents) {
+    if (renderPassState == contents || renderPassState == RenderPassState::NONE) {
+        return;
+    }
+    EndRenderPass();
 
     VkRenderPassBeginInfo renderPassBegin;
     renderPassBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     renderPassBegin.pNext = nullptr;
-    renderPassBegin.renderPass = renderPass;
-    renderPassBegin.framebuffer = framebuffer;
+    renderPassBegin.renderPass = currentRenderPass;
+    renderPassBegin.framebuffer = currentFramebuffer;
     renderPassBegin.renderArea.offset = {0, 0};
-    renderPassBegin.renderArea.extent.width = framebufferCI.width;
-    renderPassBegin.renderArea.extent.height = framebufferCI.height;
+    renderPassBegin.renderArea.extent = currentRenderArea;
     renderPassBegin.clearValueCount = 0;
     renderPassBegin.pClearValues = nullptr;
-    vkCmdBeginRenderPass(cmdBuffer, &renderPassBegin, VK_SUBPASS_CONTENTS_INLINE);
-    inRenderPass = true;
+    vkCmdBeginRenderPass(cmdBuffer, &renderPassBegin, contents == RenderPassState::SECONDARY ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+    renderPassState = contents;
+    renderPassViewCount = std::max(ViewCount(currentViewMask), 1u);
+}
+
+void GraphicsAPI_Vulkan::EndRenderPass() {
+    if (renderPassState == RenderPassState::INLINE || renderPassState == RenderPassState::SECONDARY) {
+        vkCmdEndRenderPass(cmdBuffer);
+        renderPassState = RenderPassState::PENDING;
+        renderPassViewCount = 1;
+    }
+}
+
+GraphicsAPI_Vulkan::CommandContext &GraphicsAPI_Vulkan::GetCommandContext() {
+    if (threadCommandContext) {
+        return *threadCommandContext;
+    }
+    BeginRenderPass(RenderPassState::INLINE);
+    return primaryCommandContext;
+}
+
+void GraphicsAPI_Vulkan::BeginParallelCommands(uint32_t index) {
+    if (threadCommandContext) {
+        std::cout << "ERROR: VULKAN: BeginParallelCommands() called twice on the same thread without EndParallelCommands()." << std::endl;
+        DEBUG_BREAK;
+        return;
+    }
+    if (renderPassState == RenderPassState::NONE) {
+        std::cout << "ERROR: VULKAN: BeginParallelCommands() called without SetRenderAttachments()." << std::endl;
+        DEBUG_BREAK;
+        return;
+    }
+
+    ParallelCommandPool *parallelCommandPool = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(parallelCommandsMutex);
+        std::vector<std::unique_ptr<ParallelCommandPool>> &parallelCommandPools = frameContexts[frameContextIndex].parallelCommandPools;
+        if (parallelCommandPools.size() <= index) {
+            parallelCommandPools.resize(index + 1);
+        }
+        if (!parallelCommandPools[index]) {
+            parallelCommandPools[index] = std::make_unique<ParallelCommandPool>();
+            VkCommandPoolCreateInfo cmdPoolCI;
+            cmdPoolCI.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            cmdPoolCI.pNext = nullptr;
+            cmdPoolCI.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            cmdPoolCI.queueFamilyIndex = queueFamilyIndex;
+            VULKAN_CHECK(vkCreateCommandPool(device, &cmdPoolCI, nullptr, &parallelCommandPools[index]->cmdPool), "Failed to create CommandPool.");
+            parallelCommandPools[index]->descriptorPool = CreateDescriptorPool();
+        }
+        parallelCommandPool = parallelCommandPools[index].get();
+    }
+
+    // Each index may be recorded once per render pass, so its CommandBuffers are reused after the CommandPool is reset.
+    if (parallelCommandPool->usedCmdBufferCount == parallelCommandPool->cmdBuffers.size()) {
+        VkCommandBufferAllocateInfo allocateInfo;
+        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.pNext = nullptr;
+        allocateInfo.commandPool = parallelCommandPool->cmdPool;
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocateInfo.commandBufferCount = 1;
+        VkCommandBuffer secondaryCmdBuffer{};
+        VULKAN_CHECK(vkAllocateCommandBuffers(device, &allocateInfo, &secondaryCmdBuffer), "Failed to allocate CommandBuffers.");
+        parallelCommandPool->cmdBuffers.push_back(secondaryCmdBuffer);
+    }
+    VkCommandBuffer secondaryCmdBuffer = parallelCommandPool->cmdBuffers[parallelCommandPool->usedCmdBufferCount++];
+
+    VkCommandBufferInheritanceInfo inheritanceInfo;
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.pNext = nullptr;
+    inheritanceInfo.renderPass = currentRenderPass;
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = currentFramebuffer;
+    inheritanceInfo.occlusionQueryEnable = VK_FALSE;
+    inheritanceInfo.queryFlags = 0;
+    inheritanceInfo.pipelineStatistics = 0;
+
+    VkCommandBufferBeginInfo beginInfo;
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.pNext = nullptr;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+    VULKAN_CHECK(vkBeginCommandBuffer(secondaryCmdBuffer, &beginInfo), "Failed to begin CommandBuffer.");
+
+    CommandContext &context = parallelCommandPool->context;
+    context.cmdBuffer = secondaryCmdBuffer;
+    context.descriptorPool = parallelCommandPool->descriptorPool;
+    context.descriptorSetCache = &parallelCommandPool->descriptorSetCache;
+    context.setPipeline = VK_NULL_HANDLE;
+    context.writeDescSets.clear();
+    context.index = index;
+    threadCommandContext = &context;
+}
+
+void GraphicsAPI_Vulkan::EndParallelCommands() {
+    if (!threadCommandContext) {
+        std::cout << "ERROR: VULKAN: EndParallelCommands() called without BeginParallelCommands()." << std::endl;
+        DEBUG_BREAK;
+        return;
+    }
+    VULKAN_CHECK(vkEndCommandBuffer(threadCommandContext->cmdBuffer), "Failed to end CommandBuffer.");
+    {
+        std::lock_guard<std::mutex> lock(parallelCommandsMutex);
+        recordedParallelCommands.push_back({threadCommandContext->index, threadCommandContext->cmdBuffer});
+    }
+    threadCommandContext = nullptr;
+}
+
+void GraphicsAPI_Vulkan::ExecuteParallelCommands() {
+    std::vector<std::pair<uint32_t, VkCommandBuffer>> recorded;
+    {
+        std::lock_guard<std::mutex> lock(parallelCommandsMutex);
+        recorded.swap(recordedParallelCommands);
+    }
+    if (recorded.empty()) {
+        return;
+    }
+    std::stable_sort(recorded.begin(), recorded.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+    std::vector<VkCommandBuffer> secondaryCmdBuffers;
+    secondaryCmdBuffers.reserve(recorded.size());
+    for (const auto &recordedCommands : recorded) {
+        secondaryCmdBuffers.push_back(recordedCommands.second);
+    }
+
+    BeginRenderPass(RenderPassState::SECONDARY);
+    vkCmdExecuteCommands(cmdBuffer, static_cast<uint32_t>(secondaryCmdBuffers.size()), secondaryCmdBuffers.data());
+}
+
+void GraphicsAPI_Vulkan::DestroyCachedFramebuffers(uint64_t handle) {
+    // Key layout is {renderPass, width, height, imageViews...}.
+    bool waitedForDevice = false;
+    for (auto it = framebufferCache.begin(); it != framebufferCache.end();) {
+        const std::vector<uint64_t> &key = it->first;
+        bool uses = key[0] == handle || std::find(key.begin() + 3, key.end(), handle) != key.end();
+        if (!uses) {
+            ++it;
+            continue;
+        }
+        // The Framebuffer may still be referenced by a submitted CommandBuffer.
+        if (!waitedForDevice) {
+            VULKAN_CHECK(vkDeviceWaitIdle(device), "Failed to wait for Device.");
+            waitedForDevice = true;
+        }
+        vkDestroyFramebuffer(device, it->second, nullptr);
+        it = framebufferCache.erase(it);
+    }
 }
 
 void GraphicsAPI_Vulkan::SetViewports(Viewport *viewports, size_t count) {
@@ -1300,7 +2485,7 @@ void GraphicsAPI_Vulkan::SetViewports(Viewport *viewports, size_t count) {
         vkViewports.push_back({viewport.x, viewport.y, viewport.width, viewport.height, viewport.minDepth, viewport.maxDepth});
     }
 
-    vkCmdSetViewport(cmdBuffer, 0, static_cast<uint32_t>(vkViewports.size()), vkViewports.data());
+    vkCmdSetViewport(GetCommandContext().cmdBuffer, 0, static_cast<uint32_t>(vkViewports.size()), vkViewports.data());
 }
 void GraphicsAPI_Vulkan::SetScissors(Rect2D *scissors, size_t count) {
     std::vector<VkRect2D> vkRect2D;
@@ -1310,14 +2495,16 @@ void GraphicsAPI_Vulkan::SetScissors(Rect2D *scissors, size_t count) {
         vkRect2D.push_back({{scissor.offset.x, scissor.offset.y}, {scissor.extent.width, scissor.extent.height}});
     }
 
-    vkCmdSetScissor(cmdBuffer, 0, static_cast<uint32_t>(vkRect2D.size()), vkRect2D.data());
+    vkCmdSetScissor(GetCommandContext().cmdBuffer, 0, static_cast<uint32_t>(vkRect2D.size()), vkRect2D.data());
 }
 void GraphicsAPI_Vulkan::SetPipeline(void *pipeline) {
-    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, (VkPipeline)pipeline);
-    setPipeline = (VkPipeline)pipeline;
+    CommandContext &context = GetCommandContext();
+    vkCmdBindPipeline(context.cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, (VkPipeline)pipeline);
+    context.setPipeline = (VkPipeline)pipeline;
 }
 
 void GraphicsAPI_Vulkan::SetDescriptor(const DescriptorInfo &descriptorInfo) {
+    std::vector<std::tuple<VkWriteDescriptorSet, VkDescriptorBufferInfo, VkDescriptorImageInfo, uint32_t>> &writeDescSets = GetCommandContext().writeDescSets;
     VkWriteDescriptorSet writeDescSet;
     writeDescSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     writeDescSet.pNext = nullptr;
@@ -1329,15 +2516,20 @@ void GraphicsAPI_Vulkan::SetDescriptor(const DescriptorInfo &descriptorInfo) {
     writeDescSet.pImageInfo = nullptr;
     writeDescSet.pBufferInfo = nullptr;
     writeDescSet.pTexelBufferView = nullptr;
-    writeDescSets.push_back({writeDescSet, {}, {}});
+    writeDescSets.push_back({writeDescSet, {}, {}, 0});
 
     if (descriptorInfo.type == DescriptorInfo::Type::BUFFER) {
         VkDescriptorBufferInfo &descBufferInfo = std::get<1>(writeDescSets.back());
         VkBuffer buffer = (VkBuffer)descriptorInfo.resource;
-        const BufferCreateInfo &bufferCI = bufferResources[buffer].second;
         descBufferInfo.buffer = buffer;
-        descBufferInfo.offset = descriptorInfo.bufferOffset;
         descBufferInfo.range = descriptorInfo.bufferSize;
+        if (writeDescSet.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) {
+            // The offset is supplied at bind time in UpdateDescriptors().
+            descBufferInfo.offset = 0;
+            std::get<3>(writeDescSets.back()) = static_cast<uint32_t>(descriptorInfo.bufferOffset);
+        } else {
+            descBufferInfo.offset = descriptorInfo.bufferOffset;
+        }
     } else if (descriptorInfo.type == DescriptorInfo::Type::IMAGE) {
         VkDescriptorImageInfo &descImageInfo = std::get<2>(writeDescSets.back());
         VkImageView imageView = (VkImageView)descriptorInfo.resource;
@@ -1358,65 +2550,112 @@ void GraphicsAPI_Vulkan::SetDescriptor(const DescriptorInfo &descriptorInfo) {
 }
 
 void GraphicsAPI_Vulkan::UpdateDescriptors() {
-    VkPipelineLayout pipelineLayout = std::get<0>(pipelineResources[(VkPipeline)setPipeline]);
-    VkDescriptorSetLayout descSetLayout = std::get<1>(pipelineResources[(VkPipeline)setPipeline]);
-    PipelineCreateInfo pipelinCI = std::get<3>(pipelineResources[(VkPipeline)setPipeline]);
+    CommandContext &context = GetCommandContext();
+    std::vector<std::tuple<VkWriteDescriptorSet, VkDescriptorBufferInfo, VkDescriptorImageInfo, uint32_t>> &writeDescSets = context.writeDescSets;
+    VkPipelineLayout pipelineLayout{};
+    VkDescriptorSetLayout descSetLayout{};
+    {
+        std::lock_guard<std::mutex> lock(pipelineMutex);
+        auto it = pipelineResources.find(context.setPipeline);
+        if (it == pipelineResources.end()) {
+            std::cout << "ERROR: VULKAN: Unknown Pipeline." << std::endl;
+            return;
+        }
+        pipelineLayout = std::get<0>(it->second);
+        descSetLayout = std::get<1>(it->second);
+    }
 
-    VkDescriptorSet descSet{};
-    VkDescriptorSetAllocateInfo descSetAI;
-    descSetAI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    descSetAI.pNext = nullptr;
-    descSetAI.descriptorPool = descriptorPool;
-    descSetAI.descriptorSetCount = 1;
-    descSetAI.pSetLayouts = &descSetLayout;
-    VULKAN_CHECK(vkAllocateDescriptorSets(device, &descSetAI, &descSet), "Failed to allocate DescriptorSet.");
-
-    std::vector<VkWriteDescriptorSet> vkWriteDescSets;
+    // Dynamic offsets are consumed in binding order.
+    std::sort(writeDescSets.begin(), writeDescSets.end(), [](const auto &a, const auto &b) { return std::get<0>(a).dstBinding < std::get<0>(b).dstBinding; });
+
+    std::vector<uint64_t> key;
+    std::vector<uint32_t> dynamicOffsets;
+    key.push_back((uint64_t)descSetLayout);
     for (auto &writeDescSet : writeDescSets) {
-        VkWriteDescriptorSet &vkWriteDescSet = std::get<0>(writeDescSet);
-        VkDescriptorBufferInfo &vkDescBufferInfo = std::get<1>(writeDescSet);
-        VkDescriptorImageInfo &vkDescImageInfo = std::get<2>(writeDescSet);
-
-        vkWriteDescSet.dstSet = descSet;
-        if (vkDescBufferInfo.buffer) {
-            vkWriteDescSet.pBufferInfo = &vkDescBufferInfo;
-        } else if (vkDescImageInfo.imageView || vkDescImageInfo.sampler) {
-            vkWriteDescSet.pImageInfo = &vkDescImageInfo;
-        } else {
-            continue;
+        const VkWriteDescriptorSet &vkWriteDescSet = std::get<0>(writeDescSet);
+        const VkDescriptorBufferInfo &vkDescBufferInfo = std::get<1>(writeDescSet);
+        const VkDescriptorImageInfo &vkDescImageInfo = std::get<2>(writeDescSet);
+        key.push_back(vkWriteDescSet.dstBinding);
+        key.push_back(vkWriteDescSet.descriptorType);
+        key.push_back((uint64_t)vkDescBufferInfo.buffer);
+        key.push_back(vkDescBufferInfo.offset);
+        key.push_back(vkDescBufferInfo.range);
+        key.push_back((uint64_t)vkDescImageInfo.imageView);
+        key.push_back((uint64_t)vkDescImageInfo.sampler);
+        key.push_back(vkDescImageInfo.imageLayout);
+        if (vkWriteDescSet.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) {
+            dynamicOffsets.push_back(std::get<3>(writeDescSet));
+        }
+    }
+
+    VkDescriptorSet descSet{};
+    // Each CommandContext allocates from its own DescriptorPool, so this needs no lock.
+    DescriptorSetCache &descriptorSetCache = *context.descriptorSetCache;
+    auto it = descriptorSetCache.find(key);
+    if (it != descriptorSetCache.end()) {
+        descSet = it->second;
+    } else {
+        VkDescriptorSetAllocateInfo descSetAI;
+        descSetAI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descSetAI.pNext = nullptr;
+        descSetAI.descriptorPool = context.descriptorPool;
+        descSetAI.descriptorSetCount = 1;
+        descSetAI.pSetLayouts = &descSetLayout;
+        VULKAN_CHECK(vkAllocateDescriptorSets(device, &descSetAI, &descSet), "Failed to allocate DescriptorSet.");
+
+        std::vector<VkWriteDescriptorSet> vkWriteDescSets;
+        for (auto &writeDescSet : writeDescSets) {
+            VkWriteDescriptorSet &vkWriteDescSet = std::get<0>(writeDescSet);
+            VkDescriptorBufferInfo &vkDescBufferInfo = std::get<1>(writeDescSet);
+            VkDescriptorImageInfo &vkDescImageInfo = std::get<2>(writeDescSet);
+
+            vkWriteDescSet.dstSet = descSet;
+            if (vkDescBufferInfo.buffer) {
+                vkWriteDescSet.pBufferInfo = &vkDescBufferInfo;
+            } else if (vkDescImageInfo.imageView || vkDescImageInfo.sampler) {
+                vkWriteDescSet.pImageInfo = &vkDescImageInfo;
+            } else {
+                continue;
+            }
+            vkWriteDescSets.push_back(vkWriteDescSet);
         }
-        vkWriteDescSets.push_back(vkWriteDescSet);
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(vkWriteDescSets.size()), vkWriteDescSets.data(), 0, nullptr);
+        descriptorSetCache[key] = descSet;
     }
-    vkUpdateDescriptorSets(device, static_cast<uint32_t>(vkWriteDescSets.size()), vkWriteDescSets.data(), 0, nullptr);
     writeDescSets.clear();
 
-    vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descSet, 0, nullptr);
-    cmdBufferDescriptorSets[cmdBuffer].push_back({descSet});
+    vkCmdBindDescriptorSets(context.cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descSet, static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
 }
 
-void GraphicsAPI_Vulkan::SetVertexBuffers(void **vertexBuffers, size_t count) {
+void GraphicsAPI_Vulkan::SetVertexBuffers(void **vertexBuffers, size_t count, const size_t *offsets) {
     std::vector<VkBuffer> vkBuffers;
-    std::vector<VkDeviceSize> offsets;
+    std::vector<VkDeviceSize> vkOffsets;
     for (size_t i = 0; i < count; i++) {
         vkBuffers.push_back((VkBuffer)vertexBuffers[i]);
-        offsets.push_back(0);
+        vkOffsets.push_back(offsets ? offsets[i] : 0);
     }
 
-    vkCmdBindVertexBuffers(cmdBuffer, 0, static_cast<uint32_t>(vkBuffers.size()), vkBuffers.data(), offsets.data());
+    vkCmdBindVertexBuffers(GetCommandContext().cmdBuffer, 0, static_cast<uint32_t>(vkBuffers.size()), vkBuffers.data(), vkOffsets.data());
 }
 
 void GraphicsAPI_Vulkan::SetIndexBuffer(void *indexBuffer) {
-    const BufferCreateInfo &bufferCI = bufferResources[(VkBuffer)indexBuffer].second;
+    const auto &constBufferResources = bufferResources;
+    auto it = constBufferResources.find((VkBuffer)indexBuffer);
+    if (it == constBufferResources.end()) {
+        std::cout << "ERROR: VULKAN: Unknown Index Buffer." << std::endl;
+        return;
+    }
+    const BufferCreateInfo &bufferCI = it->second.second;
     VkIndexType type = bufferCI.stride == 4 ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16;
-    vkCmdBindIndexBuffer(cmdBuffer, (VkBuffer)indexBuffer, 0, type);
+    vkCmdBindIndexBuffer(GetCommandContext().cmdBuffer, (VkBuffer)indexBuffer, 0, type);
 }
 
 void GraphicsAPI_Vulkan::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {
-    vkCmdDrawIndexed(cmdBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+    vkCmdDrawIndexed(GetCommandContext().cmdBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 }
 
 void GraphicsAPI_Vulkan::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) {
-    vkCmdDraw(cmdBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+    vkCmdDraw(GetCommandContext().cmdBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
 }
 
 // XR_DOCS_TAG_BEGIN_GraphicsAPI_Vulkan_LoadPFN_XrFunctions
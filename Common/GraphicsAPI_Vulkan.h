@@ -7,11 +7,110 @@
 #pragma once
 #include <GraphicsAPI.h>
 
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+
 #if defined(XR_USE_GRAPHICS_API_VULKAN)
+// Sub-allocates device memory for buffers and images, so that many small resources share a few large VkDeviceMemory
+// allocations rather than each using one of the limited number that a device allows (maxMemoryAllocationCount, as low as
+// 4096). Memory is allocated in blocks per memory type. Buffers and images are kept in separate blocks, so that
+// bufferImageGranularity never has to be considered.
+// Persistent resources are placed with a best fit free list, which merges neighbouring free ranges. Transient
+// resources are placed linearly, and a transient block is rewound once everything in it has been freed. Resources larger
+// than half a block get a dedicated allocation. Host visible blocks stay mapped for their whole lifetime.
+class VulkanMemoryAllocator {
+public:
+    enum class Lifetime : uint8_t {
+        PERSISTENT,
+        TRANSIENT
+    };
+
+    struct Allocation {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        void* mappedData = nullptr;  // The address of offset, if the memory is host visible.
+        uint32_t poolIndex = 0;
+        uint32_t blockIndex = 0;  // dedicatedBlockIndex for a dedicated allocation.
+    };
+
+    struct PoolStatistics {
+        uint32_t memoryTypeIndex = 0;
+        uint32_t heapIndex = 0;
+        bool image = false;
+        Lifetime lifetime = Lifetime::PERSISTENT;
+        uint32_t blockCount = 0;
+        VkDeviceSize blockBytes = 0;
+        uint32_t allocationCount = 0;
+        VkDeviceSize allocatedBytes = 0;  // Including the padding needed for alignment.
+        uint32_t freeRangeCount = 0;
+        VkDeviceSize largestFreeRange = 0;
+        // 0 when all of the free memory is in one range, approaching 1 as it is split into many small ones.
+        float fragmentation = 0.0f;
+    };
+    struct Statistics {
+        std::vector<PoolStatistics> pools;  // Only pools that have blocks.
+        uint32_t dedicatedAllocationCount = 0;
+        VkDeviceSize dedicatedBytes = 0;
+        uint32_t deviceMemoryCount = 0;  // Live VkDeviceMemory allocations, blocks and dedicated.
+        uint32_t maxDeviceMemoryCount = 0;
+        std::vector<VkDeviceSize> heapBytes;  // Allocated from each memory heap.
+    };
+
+    void Init(VkPhysicalDevice physicalDevice, VkDevice device);
+    // Frees all of the blocks. Every allocation should have been freed first.
+    void Destroy();
+
+    // Returns false if there is no suitable memory type or the device is out of memory.
+    bool Allocate(const VkMemoryRequirements& memoryRequirements, VkMemoryPropertyFlags properties, bool image, Lifetime lifetime, Allocation& allocation);
+    void Free(Allocation& allocation);
+
+    Statistics GetStatistics() const;
+
+private:
+    struct Block {
+        VkDeviceMemory memory = VK_NULL_HANDLE;  // VK_NULL_HANDLE if the block has been freed and its slot can be reused.
+        VkDeviceSize size = 0;
+        void* mappedData = nullptr;
+        uint32_t allocationCount = 0;
+        std::map<VkDeviceSize, VkDeviceSize> freeRanges;  // Persistent pools. Offset to size, merged with neighbours.
+        VkDeviceSize linearOffset = 0;                    // Transient pools.
+    };
+    struct Pool {
+        uint32_t memoryTypeIndex = 0;
+        bool image = false;
+        Lifetime lifetime = Lifetime::PERSISTENT;
+        VkDeviceSize blockSize = 0;
+        std::vector<Block> blocks;
+    };
+    static const uint32_t dedicatedBlockIndex = 0xFFFFFFFF;
+
+    bool AllocateFromBlock(Pool& pool, Block& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+    bool AllocateDeviceMemory(uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory& memory, void*& mappedData);
+    void FreeDeviceMemory(uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory memory, void* mappedData);
+
+private:
+    VkDevice device{};
+    VkPhysicalDeviceMemoryProperties memoryProperties{};
+    uint32_t maxDeviceMemoryCount = 0;
+
+    // Indexed by memory type, then image, then lifetime.
+    std::vector<Pool> pools;
+    uint32_t dedicatedAllocationCount = 0;
+    VkDeviceSize dedicatedBytes = 0;
+    uint32_t deviceMemoryCount = 0;
+    VkDeviceSize heapBytes[VK_MAX_MEMORY_HEAPS] = {};
+};
+
 class GraphicsAPI_Vulkan : public GraphicsAPI {
 public:
-    GraphicsAPI_Vulkan();
-    GraphicsAPI_Vulkan(XrInstance m_xrInstance, XrSystemId systemId);
+    // frameContextCount is the number of frames that can be recorded or in flight on the GPU at once.
+    // The VkPipelineCache is loaded from pipelineCachePath when the device is created and saved back to it on
+    // destruction. With an empty path the cache only lasts for the lifetime of the device.
+    GraphicsAPI_Vulkan(uint32_t frameContextCount = 2, const std::string& pipelineCachePath = "");
+    GraphicsAPI_Vulkan(XrInstance m_xrInstance, XrSystemId systemId, uint32_t frameContextCount = 2, const std::string& pipelineCachePath = "");
     ~GraphicsAPI_Vulkan();
 
     virtual void* CreateDesktopSwapchain(const SwapchainCreateInfo& swapchainCI) override;
@@ -57,12 +156,17 @@ public:
 
     virtual void* CreatePipeline(const PipelineCreateInfo& pipelineCI) override;
     virtual void DestroyPipeline(void*& pipeline) override;
+    virtual bool SupportsThreadedPipelineCreation() const override { return true; }
+    virtual bool SupportsMultiview() const override { return multiviewSupported; }
 
     virtual void BeginRendering() override;
     virtual void EndRendering() override;
 
     virtual void SetBufferData(void* buffer, size_t offset, size_t size, void* data) override;
 
+    virtual void BeginTimestampScope(const std::string& name) override;
+    virtual void EndTimestampScope() override;
+
     virtual void ClearColor(void* imageView, float r, float g, float b, float a) override;
     virtual void ClearDepth(void* imageView, float d) override;
 
@@ -73,11 +177,33 @@ public:
     virtual void SetPipeline(void* pipeline) override;
     virtual void SetDescriptor(const DescriptorInfo& descriptorInfo) override;
     virtual void UpdateDescriptors() override;
-    virtual void SetVertexBuffers(void** vertexBuffers, size_t count) override;
+    virtual void SetVertexBuffers(void** vertexBuffers, size_t count, const size_t* offsets = nullptr) override;
     virtual void SetIndexBuffer(void* indexBuffer) override;
     virtual void DrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0) override;
     virtual void Draw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0) override;
 
+    virtual bool SupportsParallelRecording() const override { return true; }
+    virtual void BeginParallelCommands(uint32_t index) override;
+    virtual void EndParallelCommands() override;
+    virtual void ExecuteParallelCommands() override;
+
+    const CacheStatistics& GetFramebufferCacheStatistics() const { return framebufferCacheStatistics; }
+
+    struct PipelineCacheStatistics {
+        bool loaded = false;            // Data from a file written by the same device and driver seeded the cache.
+        size_t loadedSize = 0;          // Bytes.
+        double loadMilliseconds = 0.0;  // Reading and validating the file, and creating the VkPipelineCache.
+        // Pipelines whose creation did or didn't find everything in the cache. Only counted when
+        // VK_EXT_pipeline_creation_feedback is enabled.
+        bool feedbackEnabled = false;
+        CacheStatistics pipelines;
+        uint64_t pipelineCount = 0;
+        double createMilliseconds = 0.0;  // Summed over all the calls to vkCreateGraphicsPipelines().
+    };
+    const PipelineCacheStatistics& GetPipelineCacheStatistics() const { return pipelineCacheStatistics; }
+
+    VulkanMemoryAllocator::Statistics GetMemoryStatistics() const { return memoryAllocator.GetStatistics(); }
+
 private:
     void LoadPFN_XrFunctions(XrInstance m_xrInstance);
     std::vector<std::string> GetInstanceExtensionsForOpenXR(XrInstance m_xrInstance, XrSystemId systemId);
@@ -86,6 +212,59 @@ private:
     virtual const std::vector<int64_t> GetSupportedColorSwapchainFormats() override;
     virtual const std::vector<int64_t> GetSupportedDepthSwapchainFormats() override;
 
+    virtual TransientAllocation AllocateTransientData(TransientBuffer& transientBuffer, size_t size, const void* data) override;
+
+    void CreateFrameContexts(uint32_t count);
+    void DestroyFrameContexts();
+    VkDescriptorPool CreateDescriptorPool();
+    void DestroyCachedFramebuffers(uint64_t handle);
+    void WriteTimestamp(VkPipelineStageFlagBits stage, uint32_t query);
+
+    // Render passes are begun lazily: SetRenderAttachments() only makes one PENDING, and it is begun by the first command
+    // recorded into it. Commands recorded on the rendering thread need INLINE contents and ExecuteParallelCommands() needs
+    // SECONDARY contents. Switching between them ends the render pass and begins it again, which is cheap as the
+    // attachments are loaded and stored.
+    enum class RenderPassState : uint8_t {
+        NONE,
+        PENDING,
+        INLINE,
+        SECONDARY
+    };
+    void BeginRenderPass(RenderPassState contents);
+    // Ends the render pass, leaving it PENDING so that it can be begun again.
+    void EndRenderPass();
+
+    typedef std::unordered_map<std::vector<uint64_t>, VkDescriptorSet, CacheKeyHash> DescriptorSetCache;
+    // The state of recording into one CommandBuffer: the FrameContext's primary CommandBuffer on the rendering thread, or
+    // a secondary CommandBuffer on a thread between BeginParallelCommands() and EndParallelCommands().
+    struct CommandContext {
+        VkCommandBuffer cmdBuffer{};
+        VkDescriptorPool descriptorPool{};
+        DescriptorSetCache *descriptorSetCache = nullptr;
+        VkPipeline setPipeline = VK_NULL_HANDLE;
+        std::vector<std::tuple<VkWriteDescriptorSet, VkDescriptorBufferInfo, VkDescriptorImageInfo, uint32_t>> writeDescSets;
+        // The index passed to BeginParallelCommands().
+        uint32_t index = 0;
+    };
+    // Returns the calling thread's secondary CommandContext, or the primary one, beginning the render pass with INLINE
+    // contents if needed.
+    CommandContext& GetCommandContext();
+
+    void CreateUploadQueue();
+    void DestroyUploadQueue();
+    // Copies data into a staging buffer and queues a copy from it into buffer. Returns false if no staging memory is available.
+    bool QueueUpload(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, const void* data);
+    // Submits the queued copies as one batch. The next graphics submission waits for it.
+    void SubmitUploads();
+    // Called once the FrameContext's fence has signalled, after which the staging buffers it waited on can be freed.
+    void ReleaseUploadBatches(size_t frameContextIndex);
+    // Called once the FrameContext's fence has signalled, after which the buffers and images destroyed while it was current
+    // are unused.
+    void ReleaseDestroyedResources(size_t frameContextIndex);
+
+    void CreatePipelineCache(const std::string& path);
+    void DestroyPipelineCache();
+
 private:
     VkInstance instance{};
     VkPhysicalDevice physicalDevice{};
@@ -93,11 +272,10 @@ private:
     uint32_t queueFamilyIndex = 0xFFFFFFFF;
     uint32_t queueIndex = 0xFFFFFFFF;
     VkQueue queue{};
-    VkFence fence{};
 
     VkCommandPool cmdPool{};
+    // The CommandBuffer of the current FrameContext.
     VkCommandBuffer cmdBuffer{};
-    VkDescriptorPool descriptorPool;
 
     std::vector<const char*> activeInstanceLayers{};
     std::vector<const char*> activeInstanceExtensions{};
@@ -119,20 +297,118 @@ private:
     VkSemaphore submitSemaphore{};
 
     std::unordered_map<VkImage, VkImageLayout> imageStates;
-    std::unordered_map<VkImage, std::pair<VkDeviceMemory, ImageCreateInfo>> imageResources;
+    VulkanMemoryAllocator memoryAllocator;
+
+    std::unordered_map<VkImage, std::pair<VulkanMemoryAllocator::Allocation, ImageCreateInfo>> imageResources;
     std::unordered_map<VkImageView, ImageViewCreateInfo> imageViewResources;
 
-    std::unordered_map<VkBuffer, std::pair<VkDeviceMemory, BufferCreateInfo>> bufferResources;
+    // Also read by threads recording in parallel, so buffers must not be created or destroyed while they are.
+    std::unordered_map<VkBuffer, std::pair<VulkanMemoryAllocator::Allocation, BufferCreateInfo>> bufferResources;
 
+    // Guards shaderResources, pipelineResources and pipelineCacheStatistics, as shaders and pipelines may be created on
+    // other threads.
+    std::mutex pipelineMutex;
     std::unordered_map<VkShaderModule, ShaderCreateInfo> shaderResources;
     std::unordered_map<VkPipeline, std::tuple<VkPipelineLayout, VkDescriptorSetLayout, VkRenderPass, PipelineCreateInfo>> pipelineResources;
 
-    std::unordered_map<VkCommandBuffer, std::vector<VkFramebuffer>> cmdBufferFramebuffers;
-    bool inRenderPass = false;
-
-    VkPipeline setPipeline = VK_NULL_HANDLE;
-    std::unordered_map<VkCommandBuffer, std::vector<VkDescriptorSet>> cmdBufferDescriptorSets;
-    std::vector<std::tuple<VkWriteDescriptorSet, VkDescriptorBufferInfo, VkDescriptorImageInfo>> writeDescSets;
+    VkPipelineCache pipelineCache{};
+    std::string pipelineCachePath;
+    PipelineCacheStatistics pipelineCacheStatistics;
+
+    // Framebuffers keyed by {renderPass, width, height, imageViews...}. They live until one of their
+    // imageViews or their renderPass is destroyed.
+    std::unordered_map<std::vector<uint64_t>, VkFramebuffer, CacheKeyHash> framebufferCache;
+    CacheStatistics framebufferCacheStatistics;
+    RenderPassState renderPassState = RenderPassState::NONE;
+    // Set by SetRenderAttachments() for the render pass to begin.
+    VkRenderPass currentRenderPass{};
+    VkFramebuffer currentFramebuffer{};
+    VkExtent2D currentRenderArea{};
+    uint32_t currentViewMask = 0;
+
+    bool multiviewSupported = false;
+    // Views drawn by the current render pass, or 1 outside of one.
+    uint32_t renderPassViewCount = 1;
+    // The most views of any pipeline created so far, which sets TimestampQuerySet::queriesPerTimestamp.
+    std::atomic<uint32_t> maxMultiviewViewCount{1};
+
+    CommandContext primaryCommandContext;
+    static thread_local CommandContext* threadCommandContext;
+
+    // Each index passed to BeginParallelCommands() has its own CommandPool and DescriptorPool in each FrameContext, as
+    // both must only be used by one thread at a time. They are reset along with the FrameContext in BeginRendering().
+    struct ParallelCommandPool {
+        VkCommandPool cmdPool{};
+        std::vector<VkCommandBuffer> cmdBuffers;
+        size_t usedCmdBufferCount = 0;
+        VkDescriptorPool descriptorPool{};
+        DescriptorSetCache descriptorSetCache;
+        CommandContext context;
+    };
+    // Guards the FrameContexts' parallelCommandPools and recordedParallelCommands.
+    std::mutex parallelCommandsMutex;
+    // Secondary CommandBuffers ended since the last ExecuteParallelCommands(), with their index.
+    std::vector<std::pair<uint32_t, VkCommandBuffer>> recordedParallelCommands;
+    // Guards the transient buffers' offsets, which may be allocated from while recording in parallel.
+    std::mutex transientMutex;
+
+    // STATIC buffers are DEVICE_LOCAL and written by copying from staging buffers on the upload queue, which is on a
+    // transfer only queue family when the device has one. The copies queued between two graphics submissions are recorded
+    // into one CommandBuffer, and the graphics submission waits on its semaphore.
+    struct StagingBuffer {
+        VkBuffer buffer{};
+        VkDeviceSize size = 0;
+        VkDeviceSize offset = 0;  // Where the next upload is written.
+        VulkanMemoryAllocator::Allocation allocation;
+    };
+    struct UploadBatch {
+        VkCommandBuffer cmdBuffer{};
+        VkFence fence{};
+        VkSemaphore semaphore{};
+        // Signalled by the graphics queue for a batch that overwrites buffers that earlier submissions may still read.
+        VkSemaphore graphicsSemaphore{};
+        std::vector<StagingBuffer> stagingBuffers;
+    };
+    uint32_t uploadQueueFamilyIndex = 0xFFFFFFFF;
+    VkQueue uploadQueue{};
+    VkCommandPool uploadCmdPool{};
+    // True if memory is both DEVICE_LOCAL and host visible, as on integrated GPUs, so STATIC buffers are written directly.
+    bool unifiedMemory = false;
+    std::vector<StagingBuffer> pendingStagingBuffers;
+    // Copy regions keyed by destination and staging buffer, so that the copies into a buffer are adjacent.
+    std::map<std::pair<VkBuffer, VkBuffer>, std::vector<VkBufferCopy>> pendingUploads;
+    // Whether pendingUploads updates a buffer after its creation, rather than only writing its initial data.
+    bool pendingBufferUpdates = false;
+    // Submitted batches that the next graphics submission hasn't waited on yet.
+    std::vector<UploadBatch> submittedUploadBatches;
+    std::vector<UploadBatch> freeUploadBatches;
+
+    // Resources used to record and submit one frame. BeginRendering() cycles through them, waiting only for the
+    // submission that last used the FrameContext, so recording overlaps with the GPU executing the others.
+    struct FrameContext {
+        VkCommandBuffer cmdBuffer{};
+        VkFence fence{};
+        VkDescriptorPool descriptorPool{};
+        // DescriptorSets keyed by their layout and bound resources. Uniform buffers use dynamic offsets, so only the
+        // resources are part of the key. The whole cache is dropped when the descriptorPool is reset.
+        DescriptorSetCache descriptorSetCache;
+        std::vector<std::unique_ptr<ParallelCommandPool>> parallelCommandPools;
+        // Written by the submission and read back once the fence has signalled. VK_NULL_HANDLE if the queue doesn't
+        // support timestamps.
+        VkQueryPool timestampQueryPool{};
+        TimestampQuerySet timestampQuerySet;
+        // The upload batches that the FrameContext's submission waited on.
+        std::vector<UploadBatch> uploadBatches;
+        // Buffers and images destroyed while the FrameContext was current. Its submission, or an earlier one, may still use them.
+        std::vector<std::pair<VkBuffer, VulkanMemoryAllocator::Allocation>> destroyedBuffers;
+        std::vector<std::pair<VkImage, VulkanMemoryAllocator::Allocation>> destroyedImages;
+    };
+    std::vector<FrameContext> frameContexts;
+    size_t frameContextIndex = 0;
+
+    // Nanoseconds per timestamp tick and the bits of a timestamp that are valid on the queue.
+    double timestampPeriod = 0.0;
+    uint64_t timestampValidMask = 0;
 
 };
 #endif
@@ -46,6 +46,10 @@ T Align(T value, T alignment) {
     return (value + (alignment - 1)) & ~(alignment - 1);
 };
 
+inline void HashCombine(size_t &seed, size_t value) {
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
 inline std::string GetEnv(const std::string &variable) {
     const char *value = std::getenv(variable.c_str());
     // It's invalid to assign nullptr to std::string
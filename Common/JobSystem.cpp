@@ -0,0 +1,168 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+#include <JobSystem.h>
+
+#include <algorithm>
+#include <chrono>
+
+static int64_t NowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Set on each worker thread, so that jobs it queues go into its own deque.
+static thread_local const JobSystem *workerJobSystem = nullptr;
+static thread_local uint32_t workerIndex = 0;
+
+JobSystem::JobSystem(uint32_t workerCount) {
+    if (workerCount == 0) {
+        uint32_t hardwareThreadCount = std::thread::hardware_concurrency();
+        workerCount = hardwareThreadCount > 1 ? hardwareThreadCount - 1 : 1;
+    }
+    statisticsStart = NowNanoseconds();
+    workers.reserve(workerCount + 1);
+    for (uint32_t i = 0; i < workerCount + 1; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    threads.reserve(workerCount);
+    for (uint32_t i = 1; i < workerCount + 1; i++) {
+        threads.emplace_back(&JobSystem::WorkerMain, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+void JobSystem::Run(Counter &counter, std::function<void()> job) {
+    counter.pending.fetch_add(1, std::memory_order_relaxed);
+    Worker &worker = *workers[GetWorkerIndex()];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.jobs.push_back({std::move(job), &counter});
+    }
+    queuedJobCount.fetch_add(1, std::memory_order_release);
+    // Taking the mutex orders this with a worker that has just found nothing queued and is about to sleep.
+    { std::lock_guard<std::mutex> lock(wakeMutex); }
+    wakeCondition.notify_one();
+}
+
+void JobSystem::Wait(Counter &counter) {
+    uint32_t index = GetWorkerIndex();
+    while (!counter.IsDone()) {
+        // The remaining jobs may be running on other threads, with nothing left to help with.
+        if (!TryRunJob(index)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)> &function) {
+    if (count == 0) {
+        return;
+    }
+    grainSize = std::max(grainSize, 1u);
+    Counter counter;
+    for (uint32_t begin = grainSize; begin < count; begin += grainSize) {
+        uint32_t end = std::min(begin + grainSize, count);
+        Run(counter, [&function, begin, end]() { function(begin, end); });
+    }
+    function(0, std::min(grainSize, count));
+    Wait(counter);
+}
+
+JobSystem::Statistics JobSystem::GetStatistics() const {
+    Statistics statistics;
+    statistics.elapsedMilliseconds = static_cast<double>(NowNanoseconds() - statisticsStart.load()) / 1e6;
+    for (const std::unique_ptr<Worker> &worker : workers) {
+        WorkerStatistics workerStatistics;
+        workerStatistics.jobCount = worker->jobCount.load(std::memory_order_relaxed);
+        workerStatistics.stolenJobCount = worker->stolenJobCount.load(std::memory_order_relaxed);
+        workerStatistics.busyMilliseconds = static_cast<double>(worker->busyNanoseconds.load(std::memory_order_relaxed)) / 1e6;
+        workerStatistics.utilisation = statistics.elapsedMilliseconds > 0.0 ? workerStatistics.busyMilliseconds / statistics.elapsedMilliseconds : 0.0;
+        statistics.workers.push_back(workerStatistics);
+    }
+    return statistics;
+}
+
+void JobSystem::ResetStatistics() {
+    for (std::unique_ptr<Worker> &worker : workers) {
+        worker->jobCount = 0;
+        worker->stolenJobCount = 0;
+        worker->busyNanoseconds = 0;
+    }
+    statisticsStart = NowNanoseconds();
+}
+
+uint32_t JobSystem::GetWorkerIndex() const {
+    return workerJobSystem == this ? workerIndex : 0;
+}
+
+bool JobSystem::TryRunJob(uint32_t index) {
+    if (queuedJobCount.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    // Take the newest job of our own deque, as its data is the most likely to still be in the cache. Otherwise steal the
+    // oldest job of another, starting from the next deque along so that thieves spread out.
+    Job job;
+    bool stolen = false;
+    const uint32_t workerCount = static_cast<uint32_t>(workers.size());
+    for (uint32_t i = 0; i < workerCount && !job.function; i++) {
+        Worker &victim = *workers[(index + i) % workerCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.jobs.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            job = std::move(victim.jobs.back());
+            victim.jobs.pop_back();
+        } else {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            stolen = true;
+        }
+    }
+    if (!job.function) {
+        return false;
+    }
+    queuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+
+    int64_t start = NowNanoseconds();
+    job.function();
+    Worker &worker = *workers[index];
+    worker.busyNanoseconds.fetch_add(NowNanoseconds() - start, std::memory_order_relaxed);
+    worker.jobCount.fetch_add(1, std::memory_order_relaxed);
+    if (stolen) {
+        worker.stolenJobCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Release the job's writes to the thread waiting on its counter.
+    job.counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+void JobSystem::WorkerMain(uint32_t index) {
+    workerJobSystem = this;
+    workerIndex = index;
+    while (true) {
+        if (TryRunJob(index)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this]() { return stopping || queuedJobCount.load(std::memory_order_acquire) > 0; });
+        // Finish the queued jobs before stopping, as their counters may still be waited on.
+        if (stopping && queuedJobCount.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
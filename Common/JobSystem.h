@@ -0,0 +1,101 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A work-stealing scheduler for short, CPU bound jobs that are split out of the frame loop. Each worker thread has its own
+// deque of jobs: it runs the jobs it queued itself newest first, and when its deque is empty it steals the oldest job from
+// another deque. Jobs queued by threads that aren't workers, like the frame loop thread, go into a shared deque that the
+// workers steal from. A thread waiting on a Counter runs queued jobs until the Counter reaches zero, so jobs may queue and
+// wait on jobs of their own without blocking a worker. Jobs must not throw, and mustn't block on anything but a Counter;
+// ThreadPool suits blocking tasks like file I/O better.
+class JobSystem {
+public:
+    // The number of jobs of a group that haven't finished. Wait() on it before it's destroyed.
+    class Counter {
+    public:
+        bool IsDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+        std::atomic<uint32_t> pending{0};
+    };
+
+    // With workerCount 0, one worker is created per hardware thread, less one for the calling thread.
+    JobSystem(uint32_t workerCount = 0);
+    // Runs the jobs that are still queued, then joins the workers.
+    ~JobSystem();
+
+    // Queues job and adds it to counter.
+    void Run(Counter &counter, std::function<void()> job);
+    // Runs queued jobs until all the jobs added to counter have finished.
+    void Wait(Counter &counter);
+
+    // Calls function(begin, end) for consecutive ranges of at most grainSize indices that together cover [0, count). The
+    // first range is run on the calling thread and the rest are queued. Returns once they have all finished.
+    void ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)> &function);
+
+    uint32_t GetWorkerCount() const { return static_cast<uint32_t>(threads.size()); }
+
+    struct WorkerStatistics {
+        uint64_t jobCount = 0;         // Jobs run.
+        uint64_t stolenJobCount = 0;   // Jobs run that were taken from another thread's deque.
+        double busyMilliseconds = 0.0; // Time spent running jobs.
+        double utilisation = 0.0;      // busyMilliseconds as a fraction of elapsedMilliseconds.
+    };
+    struct Statistics {
+        double elapsedMilliseconds = 0.0;  // Since the JobSystem was created or ResetStatistics() was last called.
+        // The first entry is for the threads that aren't workers, which run jobs in ParallelFor() and Wait(). The rest
+        // are for the workers.
+        std::vector<WorkerStatistics> workers;
+    };
+    // May be called while jobs run, though the figures for jobs still running aren't included.
+    Statistics GetStatistics() const;
+    void ResetStatistics();
+
+private:
+    struct Job {
+        std::function<void()> function;
+        Counter *counter = nullptr;
+    };
+    // Aligned to keep the workers' deques and statistics off each other's cache lines.
+    struct alignas(64) Worker {
+        std::mutex mutex;
+        std::deque<Job> jobs;  // Guarded by mutex.
+
+        std::atomic<uint64_t> jobCount{0};
+        std::atomic<uint64_t> stolenJobCount{0};
+        std::atomic<int64_t> busyNanoseconds{0};
+    };
+
+    // The index of the calling thread's Worker: its own for a worker thread of this JobSystem, or 0.
+    uint32_t GetWorkerIndex() const;
+    // Runs one job, from the deque of workerIndex or stolen from another. Returns false if there were none.
+    bool TryRunJob(uint32_t workerIndex);
+    void WorkerMain(uint32_t workerIndex);
+
+private:
+    // workers[0] is shared by the threads that aren't workers, and workers[i] belongs to threads[i - 1].
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    // Jobs in all the deques. Idle workers sleep on wakeCondition until it's non-zero.
+    std::atomic<uint32_t> queuedJobCount{0};
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::atomic<bool> stopping{false};
+
+    std::atomic<int64_t> statisticsStart{0};  // Nanoseconds on std::chrono::steady_clock.
+};
@@ -0,0 +1,111 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+#include <SpatialGrid.h>
+
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid(float cellSize)
+    : cellSize(cellSize) {
+}
+
+void SpatialGrid::Clear() {
+    points.clear();
+    cells.clear();
+}
+
+void SpatialGrid::Insert(uint32_t id, const XrVector3f &position) {
+    if (id >= points.size()) {
+        points.resize(id + 1);
+    }
+    Point &point = points[id];
+    if (point.inserted) {
+        Move(id, position);
+        return;
+    }
+    point.position = position;
+    point.cell = GetCell(position);
+    point.inserted = true;
+    AddToCell(id, point.cell);
+}
+
+void SpatialGrid::Move(uint32_t id, const XrVector3f &position) {
+    if (id >= points.size() || !points[id].inserted) {
+        Insert(id, position);
+        return;
+    }
+    Point &point = points[id];
+    point.position = position;
+    Cell cell = GetCell(position);
+    if (!(cell == point.cell)) {
+        RemoveFromCell(id, point.cell);
+        AddToCell(id, cell);
+        point.cell = cell;
+    }
+}
+
+void SpatialGrid::Remove(uint32_t id) {
+    if (id >= points.size() || !points[id].inserted) {
+        return;
+    }
+    RemoveFromCell(id, points[id].cell);
+    points[id].inserted = false;
+}
+
+int SpatialGrid::FindNearest(const XrVector3f &position, float radius) const {
+    const XrVector3f minimum = {position.x - radius, position.y - radius, position.z - radius};
+    const XrVector3f maximum = {position.x + radius, position.y + radius, position.z + radius};
+    const Cell first = GetCell(minimum);
+    const Cell last = GetCell(maximum);
+
+    int nearestId = -1;
+    float nearest = radius;
+    for (int32_t z = first.z; z <= last.z; z++) {
+        for (int32_t y = first.y; y <= last.y; y++) {
+            for (int32_t x = first.x; x <= last.x; x++) {
+                auto it = cells.find({x, y, z});
+                if (it == cells.end()) {
+                    continue;
+                }
+                for (uint32_t id : it->second) {
+                    const XrVector3f &p = points[id].position;
+                    float distance = std::max(std::fabs(p.x - position.x), std::max(std::fabs(p.y - position.y), std::fabs(p.z - position.z)));
+                    if (distance < nearest || (distance == nearest && nearestId != -1 && static_cast<int>(id) < nearestId)) {
+                        nearestId = static_cast<int>(id);
+                        nearest = distance;
+                    }
+                }
+            }
+        }
+    }
+    return nearestId;
+}
+
+SpatialGrid::Cell SpatialGrid::GetCell(const XrVector3f &position) const {
+    return {static_cast<int32_t>(std::floor(position.x / cellSize)), static_cast<int32_t>(std::floor(position.y / cellSize)), static_cast<int32_t>(std::floor(position.z / cellSize))};
+}
+
+void SpatialGrid::AddToCell(uint32_t id, const Cell &cell) {
+    cells[cell].push_back(id);
+}
+
+void SpatialGrid::RemoveFromCell(uint32_t id, const Cell &cell) {
+    auto it = cells.find(cell);
+    if (it == cells.end()) {
+        return;
+    }
+    std::vector<uint32_t> &ids = it->second;
+    auto found = std::find(ids.begin(), ids.end(), id);
+    if (found != ids.end()) {
+        // Order within a cell doesn't matter.
+        *found = ids.back();
+        ids.pop_back();
+    }
+    if (ids.empty()) {
+        cells.erase(it);
+    }
+}
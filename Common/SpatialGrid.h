@@ -0,0 +1,55 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+#pragma once
+#include <OpenXRHelper.h>
+
+#include <unordered_map>
+
+// A uniform grid of cubic cells over a set of points, each identified by a small integer id. Only the cells that hold
+// points are stored. Finding the nearest point to a position only visits the cells within the search radius, so its cost
+// depends on how crowded the points are around the position rather than on the total number of points.
+class SpatialGrid {
+public:
+    // cellSize should be at least the radius that will be passed to FindNearest().
+    SpatialGrid(float cellSize);
+
+    void Clear();
+    // Adds a point, or moves it if the id is already in the grid.
+    void Insert(uint32_t id, const XrVector3f &position);
+    // Moves a point. Points that stay in the same cell don't change the grid.
+    void Move(uint32_t id, const XrVector3f &position);
+    void Remove(uint32_t id);
+
+    // Returns the id of the nearest point whose distance from position, along the axis where it is furthest away, is less
+    // than radius. Of equally near points the lowest id is returned. Returns -1 if there are none.
+    int FindNearest(const XrVector3f &position, float radius) const;
+
+private:
+    struct Cell {
+        int32_t x, y, z;
+        bool operator==(const Cell &other) const { return x == other.x && y == other.y && z == other.z; }
+    };
+    struct CellHash {
+        size_t operator()(const Cell &cell) const {
+            return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(cell.x)) * 73856093u) ^ (static_cast<uint64_t>(static_cast<uint32_t>(cell.y)) * 19349663u) ^ (static_cast<uint64_t>(static_cast<uint32_t>(cell.z)) * 83492791u));
+        }
+    };
+    struct Point {
+        XrVector3f position;
+        Cell cell;
+        bool inserted = false;
+    };
+
+    Cell GetCell(const XrVector3f &position) const;
+    void AddToCell(uint32_t id, const Cell &cell);
+    void RemoveFromCell(uint32_t id, const Cell &cell);
+
+private:
+    float cellSize;
+    std::vector<Point> points;  // Indexed by id.
+    std::unordered_map<Cell, std::vector<uint32_t>, CellHash> cells;
+};
@@ -0,0 +1,45 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+#include <ThreadPool.h>
+
+ThreadPool::ThreadPool(uint32_t threadCount) {
+    if (threadCount == 0) {
+        uint32_t hardwareThreadCount = std::thread::hardware_concurrency();
+        threadCount = hardwareThreadCount > 1 ? hardwareThreadCount - 1 : 1;
+    }
+    threads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++) {
+        threads.emplace_back(&ThreadPool::WorkerMain, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::WorkerMain() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
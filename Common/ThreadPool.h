@@ -0,0 +1,56 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A fixed set of worker threads that run submitted tasks in the order they were submitted. Each task's result, or the
+// exception it threw, is returned through a std::future. A task may wait on the futures of tasks submitted before it:
+// those have already been taken by a worker by the time it starts, so the wait can't deadlock.
+class ThreadPool {
+public:
+    // With threadCount 0, one thread per hardware thread is created, less one for the calling thread.
+    ThreadPool(uint32_t threadCount = 0);
+    // Runs the tasks that are still queued, then joins the threads.
+    ~ThreadPool();
+
+    template <typename Task>
+    std::future<decltype(std::declval<Task &>()())> Submit(Task task) {
+        typedef decltype(std::declval<Task &>()()) Result;
+        // std::function needs a copyable callable, so the packaged_task is shared.
+        auto packagedTask = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+        std::future<Result> future = packagedTask->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back([packagedTask]() { (*packagedTask)(); });
+        }
+        condition.notify_one();
+        return future;
+    }
+
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(threads.size()); }
+
+private:
+    void WorkerMain();
+
+private:
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    // Guarded by mutex.
+    std::deque<std::function<void()>> tasks;
+    bool stopping = false;
+};
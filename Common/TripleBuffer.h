@@ -0,0 +1,47 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Passes the latest value of T from one writer thread to one reader thread without locking or waiting. Of the three
+// buffers, the writer owns one, the reader owns one, and the third holds the last value published. Publish() swaps the
+// writer's buffer with the third, and Read() swaps the reader's buffer with it if a value was published since. The writer
+// never waits for the reader to finish, and the reader sees each published value whole. A value published before the
+// reader took the previous one is dropped. The buffers are reused, so a T that holds containers keeps their capacity.
+template <typename T>
+class TripleBuffer {
+public:
+    // The writer's buffer, to be filled in before Publish(). It still holds whatever value was last written into it.
+    T &GetWriteBuffer() { return buffers[writeIndex]; }
+
+    // Makes the writer's buffer the latest value.
+    void Publish() {
+        writeIndex = shared.exchange(writeIndex | PUBLISHED_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Takes the latest published value if there is a new one, and returns the reader's buffer. Before anything has been
+    // published, that holds a default constructed T.
+    const T &Read() {
+        if (shared.load(std::memory_order_relaxed) & PUBLISHED_BIT) {
+            readIndex = shared.exchange(readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        }
+        return buffers[readIndex];
+    }
+
+    // Whether anything has been published that Read() hasn't taken.
+    bool HasNewValue() const { return (shared.load(std::memory_order_relaxed) & PUBLISHED_BIT) != 0; }
+
+private:
+    static constexpr uint32_t INDEX_MASK = 0x3;
+    static constexpr uint32_t PUBLISHED_BIT = 0x4;
+
+    T buffers[3];
+    uint32_t writeIndex = 0;          // Only used by the writer.
+    uint32_t readIndex = 1;           // Only used by the reader.
+    std::atomic<uint32_t> shared{2};  // The index of the third buffer, and PUBLISHED_BIT if it holds a new value.
+};
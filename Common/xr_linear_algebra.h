@@ -23,6 +23,8 @@
 // Changes made for: OpenXR Tutorial for Khronos Group.
 // - Removed GraphicsAPI_Type due to naming conflict.
 // - Updated relevant functions to use the GraphicsAPI_Type from the OpenXR Tutorial.
+// - Added SSE and NEON code paths for the functions called per object per frame. The original scalar versions are
+//   kept with a _Scalar suffix as the reference.
 
 #ifndef XR_LINEAR_H_
 #define XR_LINEAR_H_
@@ -50,6 +52,13 @@ DESCRIPTION
 
 All matrices are column-major.
 
+XrMatrix4x4f_Multiply, XrMatrix4x4f_InvertRigidBody, XrMatrix4x4f_CreateTranslationRotationScale and
+XrMatrix4x4f_TransformVector4f use SSE or NEON when the compiler targets them, unless XR_LINEAR_NO_SIMD is defined.
+The SIMD versions perform the same multiplies and adds in the same order as the _Scalar reference versions, so they
+return the same results as long as the compiler doesn't contract a multiply and an add into a fused multiply-add, which
+rounds once instead of twice. GCC and Clang may do so when targeting FMA instructions unless -ffp-contract=off is set,
+and it can happen on one side but not the other. Tests/LinearAlgebra.cpp compares the two over random inputs.
+
 INTERFACE
 =========
 
@@ -110,6 +119,8 @@ inline static void XrMatrix4x4f_TransformVector4f(XrVector4f* result, const XrMa
 inline static void XrMatrix4x4f_TransformBounds(XrVector3f* resultMins, XrVector3f* resultMaxs, const XrMatrix4x4f* matrix,
                                                 const XrVector3f* mins, const XrVector3f* maxs);
 inline static bool XrMatrix4x4f_CullBounds(const XrMatrix4x4f* mvp, const XrVector3f* mins, const XrVector3f* maxs);
+inline static void XrMatrix4x4f_CreateCombinedViewProjection(XrMatrix4x4f* result, GraphicsAPI_Type graphicsApi, const XrView* views,
+                                                             const uint32_t viewCount, const float nearZ, const float farZ);
 
 ================================================================================================
 */
@@ -118,6 +129,16 @@ inline static bool XrMatrix4x4f_CullBounds(const XrMatrix4x4f* mvp, const XrVect
 #include <math.h>
 #include <stdbool.h>
 
+#if !defined(XR_LINEAR_NO_SIMD)
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define XR_LINEAR_SSE 1
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define XR_LINEAR_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
 #define MATH_PI 3.14159265358979323846f
 
 #define DEFAULT_NEAR_Z 0.015625f  // exact floating point representation
@@ -245,7 +266,7 @@ inline static void XrQuaternionf_Multiply(XrQuaternionf* result, const XrQuatern
 }
 
 // Use left-multiplication to accumulate transformations.
-inline static void XrMatrix4x4f_Multiply(XrMatrix4x4f* result, const XrMatrix4x4f* a, const XrMatrix4x4f* b) {
+inline static void XrMatrix4x4f_Multiply_Scalar(XrMatrix4x4f* result, const XrMatrix4x4f* a, const XrMatrix4x4f* b) {
     result->m[0] = a->m[0] * b->m[0] + a->m[4] * b->m[1] + a->m[8] * b->m[2] + a->m[12] * b->m[3];
     result->m[1] = a->m[1] * b->m[0] + a->m[5] * b->m[1] + a->m[9] * b->m[2] + a->m[13] * b->m[3];
     result->m[2] = a->m[2] * b->m[0] + a->m[6] * b->m[1] + a->m[10] * b->m[2] + a->m[14] * b->m[3];
@@ -267,6 +288,40 @@ inline static void XrMatrix4x4f_Multiply(XrMatrix4x4f* result, const XrMatrix4x4
     result->m[15] = a->m[3] * b->m[12] + a->m[7] * b->m[13] + a->m[11] * b->m[14] + a->m[15] * b->m[15];
 }
 
+// Each column of the result is the columns of 'a' weighted by the elements of the matching column of 'b'.
+inline static void XrMatrix4x4f_Multiply(XrMatrix4x4f* result, const XrMatrix4x4f* a, const XrMatrix4x4f* b) {
+#if defined(XR_LINEAR_SSE)
+    const __m128 a0 = _mm_loadu_ps(&a->m[0]);
+    const __m128 a1 = _mm_loadu_ps(&a->m[4]);
+    const __m128 a2 = _mm_loadu_ps(&a->m[8]);
+    const __m128 a3 = _mm_loadu_ps(&a->m[12]);
+    for (int i = 0; i < 4; i++) {
+        const float* bColumn = &b->m[4 * i];
+        __m128 column = _mm_mul_ps(a0, _mm_set1_ps(bColumn[0]));
+        column = _mm_add_ps(column, _mm_mul_ps(a1, _mm_set1_ps(bColumn[1])));
+        column = _mm_add_ps(column, _mm_mul_ps(a2, _mm_set1_ps(bColumn[2])));
+        column = _mm_add_ps(column, _mm_mul_ps(a3, _mm_set1_ps(bColumn[3])));
+        _mm_storeu_ps(&result->m[4 * i], column);
+    }
+#elif defined(XR_LINEAR_NEON)
+    // vmlaq_f32 may be fused on some targets, so multiply and add separately to round like the scalar version.
+    const float32x4_t a0 = vld1q_f32(&a->m[0]);
+    const float32x4_t a1 = vld1q_f32(&a->m[4]);
+    const float32x4_t a2 = vld1q_f32(&a->m[8]);
+    const float32x4_t a3 = vld1q_f32(&a->m[12]);
+    for (int i = 0; i < 4; i++) {
+        const float* bColumn = &b->m[4 * i];
+        float32x4_t column = vmulq_n_f32(a0, bColumn[0]);
+        column = vaddq_f32(column, vmulq_n_f32(a1, bColumn[1]));
+        column = vaddq_f32(column, vmulq_n_f32(a2, bColumn[2]));
+        column = vaddq_f32(column, vmulq_n_f32(a3, bColumn[3]));
+        vst1q_f32(&result->m[4 * i], column);
+    }
+#else
+    XrMatrix4x4f_Multiply_Scalar(result, a, b);
+#endif
+}
+
 // Creates the transpose of the given matrix.
 inline static void XrMatrix4x4f_Transpose(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
     result->m[0] = src->m[0];
@@ -325,7 +380,7 @@ inline static void XrMatrix4x4f_Invert(XrMatrix4x4f* result, const XrMatrix4x4f*
 }
 
 // Calculates the inverse of a rigid body transform.
-inline static void XrMatrix4x4f_InvertRigidBody(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
+inline static void XrMatrix4x4f_InvertRigidBody_Scalar(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
     result->m[0] = src->m[0];
     result->m[1] = src->m[4];
     result->m[2] = src->m[8];
@@ -344,6 +399,56 @@ inline static void XrMatrix4x4f_InvertRigidBody(XrMatrix4x4f* result, const XrMa
     result->m[15] = 1.0f;
 }
 
+// Transposes the rotation and rotates the negated translation by it.
+inline static void XrMatrix4x4f_InvertRigidBody(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
+#if defined(XR_LINEAR_SSE)
+    __m128 column0 = _mm_loadu_ps(&src->m[0]);
+    __m128 column1 = _mm_loadu_ps(&src->m[4]);
+    __m128 column2 = _mm_loadu_ps(&src->m[8]);
+    __m128 column3 = _mm_setzero_ps();
+    const float x = src->m[12];
+    const float y = src->m[13];
+    const float z = src->m[14];
+    // Transposing with a zero fourth column leaves the last element of each rotation column zero.
+    _MM_TRANSPOSE4_PS(column0, column1, column2, column3);
+    __m128 translation = _mm_mul_ps(column0, _mm_set1_ps(x));
+    translation = _mm_add_ps(translation, _mm_mul_ps(column1, _mm_set1_ps(y)));
+    translation = _mm_add_ps(translation, _mm_mul_ps(column2, _mm_set1_ps(z)));
+    float t[4];
+    _mm_storeu_ps(t, translation);
+    _mm_storeu_ps(&result->m[0], column0);
+    _mm_storeu_ps(&result->m[4], column1);
+    _mm_storeu_ps(&result->m[8], column2);
+    result->m[12] = -t[0];
+    result->m[13] = -t[1];
+    result->m[14] = -t[2];
+    result->m[15] = 1.0f;
+#elif defined(XR_LINEAR_NEON)
+    // De-interleaving the 16 elements into 4 vectors transposes the matrix.
+    float32x4x4_t rows = vld4q_f32(src->m);
+    const float32x4_t column0 = vsetq_lane_f32(0.0f, rows.val[0], 3);
+    const float32x4_t column1 = vsetq_lane_f32(0.0f, rows.val[1], 3);
+    const float32x4_t column2 = vsetq_lane_f32(0.0f, rows.val[2], 3);
+    const float x = src->m[12];
+    const float y = src->m[13];
+    const float z = src->m[14];
+    float32x4_t translation = vmulq_n_f32(column0, x);
+    translation = vaddq_f32(translation, vmulq_n_f32(column1, y));
+    translation = vaddq_f32(translation, vmulq_n_f32(column2, z));
+    float t[4];
+    vst1q_f32(t, translation);
+    vst1q_f32(&result->m[0], column0);
+    vst1q_f32(&result->m[4], column1);
+    vst1q_f32(&result->m[8], column2);
+    result->m[12] = -t[0];
+    result->m[13] = -t[1];
+    result->m[14] = -t[2];
+    result->m[15] = 1.0f;
+#else
+    XrMatrix4x4f_InvertRigidBody_Scalar(result, src);
+#endif
+}
+
 // Creates an identity matrix.
 inline static void XrMatrix4x4f_CreateIdentity(XrMatrix4x4f* result) {
     result->m[0] = 1.0f;
@@ -461,8 +566,8 @@ inline static void XrMatrix4x4f_CreateFromQuaternion(XrMatrix4x4f* result, const
 }
 
 // Creates a combined translation(rotation(scale(object))) matrix.
-inline static void XrMatrix4x4f_CreateTranslationRotationScale(XrMatrix4x4f* result, const XrVector3f* translation,
-                                                               const XrQuaternionf* rotation, const XrVector3f* scale) {
+inline static void XrMatrix4x4f_CreateTranslationRotationScale_Scalar(XrMatrix4x4f* result, const XrVector3f* translation,
+                                                                      const XrQuaternionf* rotation, const XrVector3f* scale) {
     XrMatrix4x4f scaleMatrix;
     XrMatrix4x4f_CreateScale(&scaleMatrix, scale->x, scale->y, scale->z);
 
@@ -473,8 +578,33 @@ inline static void XrMatrix4x4f_CreateTranslationRotationScale(XrMatrix4x4f* res
     XrMatrix4x4f_CreateTranslation(&translationMatrix, translation->x, translation->y, translation->z);
 
     XrMatrix4x4f combinedMatrix;
-    XrMatrix4x4f_Multiply(&combinedMatrix, &rotationMatrix, &scaleMatrix);
-    XrMatrix4x4f_Multiply(result, &translationMatrix, &combinedMatrix);
+    XrMatrix4x4f_Multiply_Scalar(&combinedMatrix, &rotationMatrix, &scaleMatrix);
+    XrMatrix4x4f_Multiply_Scalar(result, &translationMatrix, &combinedMatrix);
+}
+
+// Multiplying by the scale and translation matrices only scales the rotation's columns and sets the last column, so
+// this skips the two full matrix multiplies. The results only differ from the _Scalar version in the sign of zeros.
+inline static void XrMatrix4x4f_CreateTranslationRotationScale(XrMatrix4x4f* result, const XrVector3f* translation,
+                                                               const XrQuaternionf* rotation, const XrVector3f* scale) {
+#if defined(XR_LINEAR_SSE) || defined(XR_LINEAR_NEON)
+    XrMatrix4x4f rotationMatrix;
+    XrMatrix4x4f_CreateFromQuaternion(&rotationMatrix, rotation);
+#if defined(XR_LINEAR_SSE)
+    _mm_storeu_ps(&result->m[0], _mm_mul_ps(_mm_loadu_ps(&rotationMatrix.m[0]), _mm_set1_ps(scale->x)));
+    _mm_storeu_ps(&result->m[4], _mm_mul_ps(_mm_loadu_ps(&rotationMatrix.m[4]), _mm_set1_ps(scale->y)));
+    _mm_storeu_ps(&result->m[8], _mm_mul_ps(_mm_loadu_ps(&rotationMatrix.m[8]), _mm_set1_ps(scale->z)));
+#else
+    vst1q_f32(&result->m[0], vmulq_n_f32(vld1q_f32(&rotationMatrix.m[0]), scale->x));
+    vst1q_f32(&result->m[4], vmulq_n_f32(vld1q_f32(&rotationMatrix.m[4]), scale->y));
+    vst1q_f32(&result->m[8], vmulq_n_f32(vld1q_f32(&rotationMatrix.m[8]), scale->z));
+#endif
+    result->m[12] = translation->x;
+    result->m[13] = translation->y;
+    result->m[14] = translation->z;
+    result->m[15] = 1.0f;
+#else
+    XrMatrix4x4f_CreateTranslationRotationScale_Scalar(result, translation, rotation, scale);
+#endif
 }
 
 // Creates a projection matrix based on the specified dimensions.
@@ -702,13 +832,43 @@ inline static void XrMatrix4x4f_TransformVector3f(XrVector3f* result, const XrMa
 }
 
 // Transforms a 4D vector.
-inline static void XrMatrix4x4f_TransformVector4f(XrVector4f* result, const XrMatrix4x4f* m, const XrVector4f* v) {
+inline static void XrMatrix4x4f_TransformVector4f_Scalar(XrVector4f* result, const XrMatrix4x4f* m, const XrVector4f* v) {
     result->x = m->m[0] * v->x + m->m[4] * v->y + m->m[8] * v->z + m->m[12] * v->w;
     result->y = m->m[1] * v->x + m->m[5] * v->y + m->m[9] * v->z + m->m[13] * v->w;
     result->z = m->m[2] * v->x + m->m[6] * v->y + m->m[10] * v->z + m->m[14] * v->w;
     result->w = m->m[3] * v->x + m->m[7] * v->y + m->m[11] * v->z + m->m[15] * v->w;
 }
 
+inline static void XrMatrix4x4f_TransformVector4f(XrVector4f* result, const XrMatrix4x4f* m, const XrVector4f* v) {
+#if defined(XR_LINEAR_SSE) || defined(XR_LINEAR_NEON)
+    // Read 'v' before writing 'result', in case they are the same vector.
+    const float x = v->x;
+    const float y = v->y;
+    const float z = v->z;
+    const float w = v->w;
+    float r[4];
+#if defined(XR_LINEAR_SSE)
+    __m128 column = _mm_mul_ps(_mm_loadu_ps(&m->m[0]), _mm_set1_ps(x));
+    column = _mm_add_ps(column, _mm_mul_ps(_mm_loadu_ps(&m->m[4]), _mm_set1_ps(y)));
+    column = _mm_add_ps(column, _mm_mul_ps(_mm_loadu_ps(&m->m[8]), _mm_set1_ps(z)));
+    column = _mm_add_ps(column, _mm_mul_ps(_mm_loadu_ps(&m->m[12]), _mm_set1_ps(w)));
+    _mm_storeu_ps(r, column);
+#else
+    float32x4_t column = vmulq_n_f32(vld1q_f32(&m->m[0]), x);
+    column = vaddq_f32(column, vmulq_n_f32(vld1q_f32(&m->m[4]), y));
+    column = vaddq_f32(column, vmulq_n_f32(vld1q_f32(&m->m[8]), z));
+    column = vaddq_f32(column, vmulq_n_f32(vld1q_f32(&m->m[12]), w));
+    vst1q_f32(r, column);
+#endif
+    result->x = r[0];
+    result->y = r[1];
+    result->z = r[2];
+    result->w = r[3];
+#else
+    XrMatrix4x4f_TransformVector4f_Scalar(result, m, v);
+#endif
+}
+
 // Transforms the 'mins' and 'maxs' bounds with the given 'matrix'.
 inline static void XrMatrix4x4f_TransformBounds(XrVector3f* resultMins, XrVector3f* resultMaxs, const XrMatrix4x4f* matrix,
                                                 const XrVector3f* mins, const XrVector3f* maxs) {
@@ -790,4 +950,75 @@ inline static bool XrMatrix4x4f_CullBounds(const XrMatrix4x4f* mvp, const XrVect
     return i == 8;
 }
 
+// Creates a view-projection matrix whose frustum contains the frustums of all the views between 'nearZ' and 'farZ', for
+// culling once for the views that are rendered together, such as the two eyes of a stereo pair. The combined frustum faces
+// the same way as the first view. Its apex is moved back from the views until its sides line up with the outer sides of
+// the views, and its near and far planes are moved out to take in every view.
+inline static void XrMatrix4x4f_CreateCombinedViewProjection(XrMatrix4x4f* result, GraphicsAPI_Type graphicsApi, const XrView* views,
+                                                             const uint32_t viewCount, const float nearZ, const float farZ) {
+    const XrVector3f unitScale = {1.0f, 1.0f, 1.0f};
+
+    // Work relative to the center of the views, facing the same way as the first view.
+    XrVector3f center = {0.0f, 0.0f, 0.0f};
+    for (uint32_t v = 0; v < viewCount; v++) {
+        XrVector3f_Add(&center, &center, &views[v].pose.position);
+    }
+    XrVector3f_Scale(&center, &center, 1.0f / (float)viewCount);
+    XrMatrix4x4f centerToWorld;
+    XrMatrix4x4f_CreateTranslationRotationScale(&centerToWorld, &center, &views[0].pose.orientation, &unitScale);
+    XrMatrix4x4f worldToCenter;
+    XrMatrix4x4f_InvertRigidBody(&worldToCenter, &centerToWorld);
+
+    // Move the apex back until the sides of a frustum as wide as the first view's reach the outermost views.
+    float maxOffsetX = 0.0f;
+    float maxOffsetY = 0.0f;
+    for (uint32_t v = 0; v < viewCount; v++) {
+        XrVector3f offset;
+        XrMatrix4x4f_TransformVector3f(&offset, &worldToCenter, &views[v].pose.position);
+        maxOffsetX = fmaxf(maxOffsetX, fabsf(offset.x));
+        maxOffsetY = fmaxf(maxOffsetY, fabsf(offset.y));
+    }
+    const float tanWidth = tanf(views[0].fov.angleRight) - tanf(views[0].fov.angleLeft);
+    const float tanHeight = tanf(views[0].fov.angleUp) - tanf(views[0].fov.angleDown);
+    const float apexZ = fmaxf(2.0f * maxOffsetX / tanWidth, 2.0f * maxOffsetY / tanHeight);
+
+    // Widen the frustum from the apex to take in the corners of every view's frustum.
+    float tanLeft = 0.0f, tanRight = 0.0f, tanDown = 0.0f, tanUp = 0.0f;
+    float combinedNearZ = farZ + apexZ, combinedFarZ = nearZ;
+    for (uint32_t v = 0; v < viewCount; v++) {
+        XrMatrix4x4f viewToWorld;
+        XrMatrix4x4f_CreateTranslationRotationScale(&viewToWorld, &views[v].pose.position, &views[v].pose.orientation, &unitScale);
+        XrMatrix4x4f viewToCenter;
+        XrMatrix4x4f_Multiply(&viewToCenter, &worldToCenter, &viewToWorld);
+
+        const float tanX[2] = {tanf(views[v].fov.angleLeft), tanf(views[v].fov.angleRight)};
+        const float tanY[2] = {tanf(views[v].fov.angleDown), tanf(views[v].fov.angleUp)};
+        for (int i = 0; i < 8; i++) {
+            const float viewDepth = (i & 4) != 0 ? farZ : nearZ;
+            const XrVector3f viewCorner = {tanX[i & 1] * viewDepth, tanY[(i >> 1) & 1] * viewDepth, -viewDepth};
+            XrVector3f corner;
+            XrMatrix4x4f_TransformVector3f(&corner, &viewToCenter, &viewCorner);
+            const float depth = apexZ - corner.z;
+            tanLeft = fminf(tanLeft, corner.x / depth);
+            tanRight = fmaxf(tanRight, corner.x / depth);
+            tanDown = fminf(tanDown, corner.y / depth);
+            tanUp = fmaxf(tanUp, corner.y / depth);
+            combinedNearZ = fminf(combinedNearZ, depth);
+            combinedFarZ = fmaxf(combinedFarZ, depth);
+        }
+    }
+
+    XrMatrix4x4f projection;
+    XrMatrix4x4f_CreateProjection(&projection, graphicsApi, tanLeft, tanRight, tanUp, tanDown, combinedNearZ, combinedFarZ);
+
+    const XrVector3f apexInCenter = {0.0f, 0.0f, apexZ};
+    XrVector3f apex;
+    XrMatrix4x4f_TransformVector3f(&apex, &centerToWorld, &apexInCenter);
+    XrMatrix4x4f apexToWorld;
+    XrMatrix4x4f_CreateTranslationRotationScale(&apexToWorld, &apex, &views[0].pose.orientation, &unitScale);
+    XrMatrix4x4f worldToApex;
+    XrMatrix4x4f_InvertRigidBody(&worldToApex, &apexToWorld);
+    XrMatrix4x4f_Multiply(result, &projection, &worldToApex);
+}
+
 #endif  // XR_LINEAR_H_
@@ -0,0 +1,203 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+#pragma once
+#include <xr_linear_algebra.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Batched versions of the xr_linear_algebra.h transform functions, for creating the matrices of many objects at once.
+
+The transforms are passed as a structure of arrays, so that with SSE or NEON each instruction works on the same element
+of four instances. The results are written as ordinary XrMatrix4x4f structures, resultStride bytes apart, so that they
+can be written straight into a larger per-instance structure. Instances left over after the groups of four, and builds
+without SIMD, use the single matrix functions.
+
+The results equal those of XrMatrix4x4f_CreateTranslationRotationScale() and XrMatrix4x4f_Multiply(), except that
+zeros may differ in sign.
+*/
+
+// Element i of every array belongs to instance i.
+typedef struct XrTransformsSoA {
+    const float* positionX;
+    const float* positionY;
+    const float* positionZ;
+    const float* orientationX;
+    const float* orientationY;
+    const float* orientationZ;
+    const float* orientationW;
+    const float* scaleX;
+    const float* scaleY;
+    const float* scaleZ;
+} XrTransformsSoA;
+
+#if defined(XR_LINEAR_SSE)
+typedef __m128 XrBatchVector;
+inline static XrBatchVector XrBatchVector_Load(const float* p) { return _mm_loadu_ps(p); }
+inline static XrBatchVector XrBatchVector_Set(const float value) { return _mm_set1_ps(value); }
+inline static XrBatchVector XrBatchVector_Add(XrBatchVector a, XrBatchVector b) { return _mm_add_ps(a, b); }
+inline static XrBatchVector XrBatchVector_Sub(XrBatchVector a, XrBatchVector b) { return _mm_sub_ps(a, b); }
+inline static XrBatchVector XrBatchVector_Mul(XrBatchVector a, XrBatchVector b) { return _mm_mul_ps(a, b); }
+inline static void XrBatchVector_Store(float* p, XrBatchVector v) { _mm_storeu_ps(p, v); }
+inline static void XrBatchVector_Transpose(XrBatchVector* v0, XrBatchVector* v1, XrBatchVector* v2, XrBatchVector* v3) {
+    _MM_TRANSPOSE4_PS(*v0, *v1, *v2, *v3);
+}
+#elif defined(XR_LINEAR_NEON)
+typedef float32x4_t XrBatchVector;
+inline static XrBatchVector XrBatchVector_Load(const float* p) { return vld1q_f32(p); }
+inline static XrBatchVector XrBatchVector_Set(const float value) { return vdupq_n_f32(value); }
+inline static XrBatchVector XrBatchVector_Add(XrBatchVector a, XrBatchVector b) { return vaddq_f32(a, b); }
+inline static XrBatchVector XrBatchVector_Sub(XrBatchVector a, XrBatchVector b) { return vsubq_f32(a, b); }
+inline static XrBatchVector XrBatchVector_Mul(XrBatchVector a, XrBatchVector b) { return vmulq_f32(a, b); }
+inline static void XrBatchVector_Store(float* p, XrBatchVector v) { vst1q_f32(p, v); }
+inline static void XrBatchVector_Transpose(XrBatchVector* v0, XrBatchVector* v1, XrBatchVector* v2, XrBatchVector* v3) {
+    const float32x4x2_t t01 = vtrnq_f32(*v0, *v1);
+    const float32x4x2_t t23 = vtrnq_f32(*v2, *v3);
+    *v0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+    *v1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+    *v2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+    *v3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+#endif
+
+#if defined(XR_LINEAR_SSE) || defined(XR_LINEAR_NEON)
+// Creates the translation(rotation(scale(object))) matrices of instances first to first + 3. Element e of the matrices
+// is held in m[e], one instance per lane.
+inline static void XrBatch_CreateTranslationRotationScale(XrBatchVector m[16], const XrTransformsSoA* transforms, uint32_t first) {
+    const XrBatchVector x = XrBatchVector_Load(transforms->orientationX + first);
+    const XrBatchVector y = XrBatchVector_Load(transforms->orientationY + first);
+    const XrBatchVector z = XrBatchVector_Load(transforms->orientationZ + first);
+    const XrBatchVector w = XrBatchVector_Load(transforms->orientationW + first);
+    const XrBatchVector scaleX = XrBatchVector_Load(transforms->scaleX + first);
+    const XrBatchVector scaleY = XrBatchVector_Load(transforms->scaleY + first);
+    const XrBatchVector scaleZ = XrBatchVector_Load(transforms->scaleZ + first);
+    const XrBatchVector zero = XrBatchVector_Set(0.0f);
+    const XrBatchVector one = XrBatchVector_Set(1.0f);
+
+    // As XrMatrix4x4f_CreateFromQuaternion().
+    const XrBatchVector x2 = XrBatchVector_Add(x, x);
+    const XrBatchVector y2 = XrBatchVector_Add(y, y);
+    const XrBatchVector z2 = XrBatchVector_Add(z, z);
+
+    const XrBatchVector xx2 = XrBatchVector_Mul(x, x2);
+    const XrBatchVector yy2 = XrBatchVector_Mul(y, y2);
+    const XrBatchVector zz2 = XrBatchVector_Mul(z, z2);
+
+    const XrBatchVector yz2 = XrBatchVector_Mul(y, z2);
+    const XrBatchVector wx2 = XrBatchVector_Mul(w, x2);
+    const XrBatchVector xy2 = XrBatchVector_Mul(x, y2);
+    const XrBatchVector wz2 = XrBatchVector_Mul(w, z2);
+    const XrBatchVector xz2 = XrBatchVector_Mul(x, z2);
+    const XrBatchVector wy2 = XrBatchVector_Mul(w, y2);
+
+    m[0] = XrBatchVector_Mul(XrBatchVector_Sub(XrBatchVector_Sub(one, yy2), zz2), scaleX);
+    m[1] = XrBatchVector_Mul(XrBatchVector_Add(xy2, wz2), scaleX);
+    m[2] = XrBatchVector_Mul(XrBatchVector_Sub(xz2, wy2), scaleX);
+    m[3] = zero;
+
+    m[4] = XrBatchVector_Mul(XrBatchVector_Sub(xy2, wz2), scaleY);
+    m[5] = XrBatchVector_Mul(XrBatchVector_Sub(XrBatchVector_Sub(one, xx2), zz2), scaleY);
+    m[6] = XrBatchVector_Mul(XrBatchVector_Add(yz2, wx2), scaleY);
+    m[7] = zero;
+
+    m[8] = XrBatchVector_Mul(XrBatchVector_Add(xz2, wy2), scaleZ);
+    m[9] = XrBatchVector_Mul(XrBatchVector_Sub(yz2, wx2), scaleZ);
+    m[10] = XrBatchVector_Mul(XrBatchVector_Sub(XrBatchVector_Sub(one, xx2), yy2), scaleZ);
+    m[11] = zero;
+
+    m[12] = XrBatchVector_Load(transforms->positionX + first);
+    m[13] = XrBatchVector_Load(transforms->positionY + first);
+    m[14] = XrBatchVector_Load(transforms->positionZ + first);
+    m[15] = one;
+}
+
+// Writes the four matrices held in m, one per lane, to consecutive results.
+inline static void XrBatch_StoreMatrices(char* results, size_t resultStride, XrBatchVector m[16]) {
+    for (int column = 0; column < 4; column++) {
+        XrBatchVector* v = &m[4 * column];
+        XrBatchVector_Transpose(&v[0], &v[1], &v[2], &v[3]);
+        for (int lane = 0; lane < 4; lane++) {
+            XrBatchVector_Store(&((XrMatrix4x4f*)(results + lane * resultStride))->m[4 * column], v[lane]);
+        }
+    }
+}
+#endif
+
+inline static void XrBatch_GetTransform(const XrTransformsSoA* transforms, uint32_t i, XrVector3f* position, XrQuaternionf* orientation, XrVector3f* scale) {
+    position->x = transforms->positionX[i];
+    position->y = transforms->positionY[i];
+    position->z = transforms->positionZ[i];
+    orientation->x = transforms->orientationX[i];
+    orientation->y = transforms->orientationY[i];
+    orientation->z = transforms->orientationZ[i];
+    orientation->w = transforms->orientationW[i];
+    scale->x = transforms->scaleX[i];
+    scale->y = transforms->scaleY[i];
+    scale->z = transforms->scaleZ[i];
+}
+
+// Creates the model matrix of each of the count instances.
+inline static void XrMatrix4x4f_CreateTranslationRotationScaleBatch(void* results, size_t resultStride, const XrTransformsSoA* transforms, uint32_t count) {
+    char* result = (char*)results;
+    uint32_t i = 0;
+#if defined(XR_LINEAR_SSE) || defined(XR_LINEAR_NEON)
+    for (; i + 4 <= count; i += 4) {
+        XrBatchVector m[16];
+        XrBatch_CreateTranslationRotationScale(m, transforms, i);
+        XrBatch_StoreMatrices(result + i * resultStride, resultStride, m);
+    }
+#endif
+    for (; i < count; i++) {
+        XrVector3f position, scale;
+        XrQuaternionf orientation;
+        XrBatch_GetTransform(transforms, i, &position, &orientation, &scale);
+        XrMatrix4x4f_CreateTranslationRotationScale((XrMatrix4x4f*)(result + i * resultStride), &position, &orientation, &scale);
+    }
+}
+
+// Creates viewProjection[v] * model matrix of each of the count instances for each of the viewCount views. The model
+// matrices are created once and shared by the views. The result for view v and instance i is at index v * count + i.
+inline static void XrMatrix4x4f_CreateModelViewProjectionBatch(void* results, size_t resultStride, const XrMatrix4x4f* viewProjections, uint32_t viewCount,
+                                                               const XrTransformsSoA* transforms, uint32_t count) {
+    char* result = (char*)results;
+    uint32_t i = 0;
+#if defined(XR_LINEAR_SSE) || defined(XR_LINEAR_NEON)
+    for (; i + 4 <= count; i += 4) {
+        XrBatchVector model[16];
+        XrBatch_CreateTranslationRotationScale(model, transforms, i);
+        for (uint32_t v = 0; v < viewCount; v++) {
+            const float* vp = viewProjections[v].m;
+            XrBatchVector mvp[16];
+            for (int column = 0; column < 4; column++) {
+                const XrBatchVector* modelColumn = &model[4 * column];
+                for (int row = 0; row < 4; row++) {
+                    XrBatchVector element = XrBatchVector_Mul(XrBatchVector_Set(vp[row]), modelColumn[0]);
+                    element = XrBatchVector_Add(element, XrBatchVector_Mul(XrBatchVector_Set(vp[row + 4]), modelColumn[1]));
+                    element = XrBatchVector_Add(element, XrBatchVector_Mul(XrBatchVector_Set(vp[row + 8]), modelColumn[2]));
+                    // The last row of the model matrix is (0, 0, 0, 1).
+                    if (column == 3) {
+                        element = XrBatchVector_Add(element, XrBatchVector_Set(vp[row + 12]));
+                    }
+                    mvp[4 * column + row] = element;
+                }
+            }
+            XrBatch_StoreMatrices(result + (v * count + i) * resultStride, resultStride, mvp);
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        XrVector3f position, scale;
+        XrQuaternionf orientation;
+        XrBatch_GetTransform(transforms, i, &position, &orientation, &scale);
+        XrMatrix4x4f model;
+        XrMatrix4x4f_CreateTranslationRotationScale(&model, &position, &orientation, &scale);
+        for (uint32_t v = 0; v < viewCount; v++) {
+            XrMatrix4x4f_Multiply((XrMatrix4x4f*)(result + (v * count + i) * resultStride), &viewProjections[v], &model);
+        }
+    }
+}
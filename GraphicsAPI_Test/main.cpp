@@ -176,8 +176,8 @@ void RenderCuboid(XrPosef pose, XrVector3f scale) {
 
     graphicsAPI->SetPipeline(pipeline);
 
-    graphicsAPI->SetBufferData(uniformBuffer_Vert, 0, sizeof(CameraConstants), &cameraConstants);
-    graphicsAPI->SetDescriptor({1, uniformBuffer_Vert, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::VERTEX, false});
+    GraphicsAPI::TransientAllocation cameraConstantsUB = graphicsAPI->AllocateTransientUniformData(sizeof(CameraConstants), &cameraConstants);
+    graphicsAPI->SetDescriptor({1, cameraConstantsUB.buffer, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::VERTEX, false, cameraConstantsUB.offset, cameraConstantsUB.size});
     graphicsAPI->SetDescriptor({0, uniformBuffer_Frag, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::FRAGMENT, false});
     graphicsAPI->UpdateDescriptors();
 
@@ -457,9 +457,9 @@ int main() {
 
         graphicsAPI->SetPipeline(pipeline);
 
-        graphicsAPI->SetBufferData(uniformBuffer_Vert, 0, sizeof(CameraConstants), &cameraConstants);
-        graphicsAPI->SetDescriptor({1, uniformBuffer_Vert, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::VERTEX, false});
-        graphicsAPI->SetBufferData(uniformBuffer_Frag, 0, sizeof(colors), (void*)colors);
+        // Per-frame constants come from transient memory, as uniformBuffer_Vert may still be in use by a previous frame on the GPU.
+        GraphicsAPI::TransientAllocation cameraConstantsUB = graphicsAPI->AllocateTransientUniformData(sizeof(CameraConstants), &cameraConstants);
+        graphicsAPI->SetDescriptor({1, cameraConstantsUB.buffer, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::VERTEX, false, cameraConstantsUB.offset, cameraConstantsUB.size});
         graphicsAPI->SetDescriptor({0, uniformBuffer_Frag, GraphicsAPI::DescriptorInfo::Type::BUFFER, GraphicsAPI::DescriptorInfo::Stage::FRAGMENT, false});
         graphicsAPI->UpdateDescriptors();
 
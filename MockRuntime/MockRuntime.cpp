@@ -0,0 +1,1302 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+// A minimal OpenXR runtime for running the tutorial's frame loops without a headset. It is loaded by the OpenXR loader
+// through a runtime manifest (see XR_RUNTIME_JSON) and provides:
+// - Scripted head, controller and hand joint poses, which are pure functions of the XrTime being located.
+// - Fixed predicted display times: frame N is displayed at a constant start time plus N display periods, and xrWaitFrame
+//   never blocks. So every run of an application sees the same sequence of times and poses.
+// - Headless sessions only (XR_MND_headless), to be paired with GraphicsAPI_Null. Unlike a conforming headless session,
+//   swapchains and the frame loop are still supported, so that the application's rendering code is exercised. The swapchain
+//   images are owned by GraphicsAPI_Null, so xrEnumerateSwapchainImages only reports the image count.
+//
+// It is configured with environment variables:
+// - XR_MOCK_RUNTIME_FRAME_COUNT: after this many calls to xrEndFrame, the session is stopped and the application is asked to
+//   exit. 0, the default, runs until the application requests to exit.
+// - XR_MOCK_RUNTIME_DISPLAY_RATE: the display refresh rate in Hz. Default 90.
+//
+// The runtime isn't thread safe. All calls are expected to come from the application's main thread.
+
+#define XR_NO_PROTOTYPES
+#include <openxr/openxr.h>
+#include <openxr/openxr_loader_negotiation.h>
+#include <openxr/openxr_reflection.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#if defined(_WIN32)
+#define MOCK_RUNTIME_EXPORT extern "C" __declspec(dllexport)
+#else
+#define MOCK_RUNTIME_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+constexpr XrSystemId systemId = 1;
+constexpr XrTime startTime = 1000000000;  // 1 second, so that no valid XrTime is zero.
+constexpr uint32_t swapchainImageCount = 3;
+constexpr float pi = 3.14159265358979f;
+
+const std::vector<XrExtensionProperties> supportedExtensions = {
+    {XR_TYPE_EXTENSION_PROPERTIES, nullptr, XR_EXT_DEBUG_UTILS_EXTENSION_NAME, XR_EXT_debug_utils_SPEC_VERSION},
+    {XR_TYPE_EXTENSION_PROPERTIES, nullptr, XR_EXT_HAND_INTERACTION_EXTENSION_NAME, XR_EXT_hand_interaction_SPEC_VERSION},
+    {XR_TYPE_EXTENSION_PROPERTIES, nullptr, XR_EXT_HAND_TRACKING_EXTENSION_NAME, XR_EXT_hand_tracking_SPEC_VERSION},
+    {XR_TYPE_EXTENSION_PROPERTIES, nullptr, XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME, XR_KHR_composition_layer_depth_SPEC_VERSION},
+    {XR_TYPE_EXTENSION_PROPERTIES, nullptr, XR_MND_HEADLESS_EXTENSION_NAME, XR_MND_headless_SPEC_VERSION}};
+
+// These match the values of GraphicsAPI_Null::Format.
+const std::vector<int64_t> swapchainFormats = {1, 2, 3, 4};
+
+struct Instance;
+struct Session;
+struct ActionSet;
+
+struct Action {
+    ActionSet *actionSet;
+    XrActionType type;
+    std::vector<XrPath> subactionPaths;
+    bool bound[2] = {false, false};  // Per hand, whether the current interaction profile has a binding for this action.
+    XrActionStateBoolean booleanState[2] = {{XR_TYPE_ACTION_STATE_BOOLEAN}, {XR_TYPE_ACTION_STATE_BOOLEAN}};
+    XrActionStateFloat floatState[2] = {{XR_TYPE_ACTION_STATE_FLOAT}, {XR_TYPE_ACTION_STATE_FLOAT}};
+};
+
+struct ActionSet {
+    Instance *instance;
+    std::vector<Action *> actions;
+    bool attached = false;
+};
+
+struct Instance {
+    std::vector<std::string> enabledExtensions;
+    std::vector<std::string> paths = {""};  // XR_NULL_PATH is index 0.
+    std::unordered_map<std::string, XrPath> pathIndices;
+    std::unordered_map<XrPath, std::vector<std::pair<XrAction, XrPath>>> suggestedBindings;
+    std::deque<XrEventDataBuffer> events;
+    Session *session = nullptr;
+};
+
+struct Session {
+    Instance *instance;
+    XrSessionState state = XR_SESSION_STATE_UNKNOWN;
+    XrViewConfigurationType viewConfiguration = XR_VIEW_CONFIGURATION_TYPE_MAX_ENUM;
+    XrPath interactionProfile = XR_NULL_PATH;
+    bool running = false;
+    bool exitRequested = false;
+    // Frame loop state.
+    uint64_t frameIndex = 0;  // Index of the frame returned by the last xrWaitFrame.
+    uint64_t framesEnded = 0;
+    bool frameWaited = false;
+    bool frameBegun = false;
+};
+
+struct Space {
+    Session *session;
+    XrReferenceSpaceType referenceSpaceType;  // XR_REFERENCE_SPACE_TYPE_MAX_ENUM for action spaces.
+    Action *action;
+    int hand;  // For action spaces: 0 for left, 1 for right.
+    XrPosef offset;
+};
+
+struct Swapchain {
+    Session *session;
+    XrSwapchainCreateInfo createInfo;
+    uint32_t acquiredCount = 0;
+    uint32_t nextIndex = 0;
+};
+
+struct HandTracker {
+    Session *session;
+    XrHandEXT hand;
+};
+
+struct DebugUtilsMessenger {
+    Instance *instance;
+};
+
+struct Config {
+    uint64_t frameCount = 0;
+    XrDuration displayPeriod = 1000000000 / 90;
+};
+
+static const Config &GetConfig() {
+    static Config config = []() {
+        Config config;
+        if (const char *frameCount = getenv("XR_MOCK_RUNTIME_FRAME_COUNT")) {
+            config.frameCount = strtoull(frameCount, nullptr, 10);
+        }
+        if (const char *displayRate = getenv("XR_MOCK_RUNTIME_DISPLAY_RATE")) {
+            double rate = strtod(displayRate, nullptr);
+            if (rate > 0.0) {
+                config.displayPeriod = static_cast<XrDuration>(1e9 / rate);
+            }
+        }
+        return config;
+    }();
+    return config;
+}
+
+// Every object handed out by the runtime, so that stale or foreign handles can be rejected.
+static std::unordered_set<const void *> liveObjects;
+
+template <typename H, typename T>
+static H CreateHandle(T *object) {
+    liveObjects.insert(object);
+    return (H)(uintptr_t)object;
+}
+template <typename T, typename H>
+static T *FindObject(H handle) {
+    T *object = (T *)(uintptr_t)handle;
+    return liveObjects.count(object) ? object : nullptr;
+}
+template <typename T>
+static void DestroyObject(T *object) {
+    liveObjects.erase(object);
+    delete object;
+}
+
+// Implements the two call idiom. fill is called for each element to be written.
+template <typename T, typename F>
+static XrResult WriteArray(uint32_t size, uint32_t capacityInput, uint32_t *countOutput, T *output, F fill) {
+    if (!countOutput) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    *countOutput = size;
+    if (capacityInput == 0) {
+        return XR_SUCCESS;
+    }
+    if (capacityInput < size || !output) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    for (uint32_t i = 0; i < size; i++) {
+        fill(output[i], i);
+    }
+    return XR_SUCCESS;
+}
+template <typename T>
+static XrResult WriteArray(const std::vector<T> &input, uint32_t capacityInput, uint32_t *countOutput, T *output) {
+    return WriteArray(static_cast<uint32_t>(input.size()), capacityInput, countOutput, output, [&](T &element, uint32_t i) { element = input[i]; });
+}
+
+// Pose math. Poses are rigid body transforms: rotate, then translate.
+static XrVector3f Rotate(const XrQuaternionf &q, const XrVector3f &v) {
+    // v + 2w(q x v) + 2q x (q x v)
+    XrVector3f t = {2.0f * (q.y * v.z - q.z * v.y), 2.0f * (q.z * v.x - q.x * v.z), 2.0f * (q.x * v.y - q.y * v.x)};
+    return {v.x + q.w * t.x + (q.y * t.z - q.z * t.y), v.y + q.w * t.y + (q.z * t.x - q.x * t.z), v.z + q.w * t.z + (q.x * t.y - q.y * t.x)};
+}
+static XrQuaternionf Multiply(const XrQuaternionf &a, const XrQuaternionf &b) {
+    return {a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+            a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+            a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+            a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z};
+}
+// Returns the pose b, given relative to a, in the space that a is in.
+static XrPosef Multiply(const XrPosef &a, const XrPosef &b) {
+    XrVector3f p = Rotate(a.orientation, b.position);
+    return {Multiply(a.orientation, b.orientation), {p.x + a.position.x, p.y + a.position.y, p.z + a.position.z}};
+}
+static XrPosef Invert(const XrPosef &a) {
+    XrQuaternionf q = {-a.orientation.x, -a.orientation.y, -a.orientation.z, a.orientation.w};
+    XrVector3f p = Rotate(q, a.position);
+    return {q, {-p.x, -p.y, -p.z}};
+}
+static XrQuaternionf YawPitch(float yaw, float pitch) {
+    XrQuaternionf qYaw = {0.0f, sinf(yaw * 0.5f), 0.0f, cosf(yaw * 0.5f)};
+    XrQuaternionf qPitch = {sinf(pitch * 0.5f), 0.0f, 0.0f, cosf(pitch * 0.5f)};
+    return Multiply(qYaw, qPitch);
+}
+
+// The script. All poses are in LOCAL space, and depend only on the time in seconds since the start time. The motions are
+// chosen to keep the hands moving through the blocks of Chapter 5, so that grabbing them is exercised too.
+static float ScriptTime(XrTime time) {
+    return static_cast<float>(static_cast<double>(time - startTime) * 1e-9);
+}
+static XrPosef ScriptedHeadPose(XrTime time) {
+    float t = ScriptTime(time);
+    return {YawPitch(0.2f * sinf(2.0f * pi * 0.25f * t), 0.1f * sinf(2.0f * pi * 0.2f * t)), {0.05f * sinf(2.0f * pi * 0.5f * t), 0.0f, 0.0f}};
+}
+static XrPosef ScriptedHandPose(int hand, XrTime time) {
+    float t = ScriptTime(time);
+    float side = hand == 0 ? -1.0f : 1.0f;
+    float phase = hand == 0 ? 0.0f : 0.5f * pi;
+    XrVector3f position = {side * 0.15f + 0.1f * sinf(2.0f * pi * 0.5f * t + phase),
+                           -0.2f + 0.1f * cosf(2.0f * pi * 0.5f * t + phase),
+                           -0.7f + 0.25f * sinf(2.0f * pi * 0.25f * t + phase)};
+    return {YawPitch(side * 0.3f, -0.5f), position};
+}
+// Grab is held for one second out of every two, and the hands alternate. Select clicks every three seconds.
+static float ScriptedFloatInput(int hand, XrTime time) {
+    return fmodf(ScriptTime(time) + (hand == 0 ? 0.0f : 1.0f), 2.0f) >= 1.0f ? 1.0f : 0.0f;
+}
+static bool ScriptedBooleanInput(int hand, XrTime time) {
+    return fmodf(ScriptTime(time) + (hand == 0 ? 0.0f : 1.5f), 3.0f) < 0.1f;
+}
+// A flat hand pointing forwards from the palm, given relative to the palm.
+static XrPosef ScriptedHandJointPose(int hand, uint32_t joint) {
+    float side = hand == 0 ? -1.0f : 1.0f;
+    if (joint == XR_HAND_JOINT_PALM_EXT) {
+        return {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+    }
+    if (joint == XR_HAND_JOINT_WRIST_EXT) {
+        return {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.06f}};
+    }
+    // The thumb has four joints, starting at its metacarpal. The fingers have five, so the thumb is offset by one.
+    uint32_t finger = joint <= XR_HAND_JOINT_THUMB_TIP_EXT ? 0 : 1 + (joint - XR_HAND_JOINT_INDEX_METACARPAL_EXT) / 5;
+    uint32_t bone = joint <= XR_HAND_JOINT_THUMB_TIP_EXT ? joint - XR_HAND_JOINT_THUMB_METACARPAL_EXT + 1 : (joint - XR_HAND_JOINT_INDEX_METACARPAL_EXT) % 5;
+    return {{0.0f, 0.0f, 0.0f, 1.0f}, {side * 0.02f * (2.0f - static_cast<float>(finger)), 0.0f, 0.03f - 0.025f * static_cast<float>(bone)}};
+}
+
+// The pose of a space in LOCAL space.
+static XrPosef LocateInLocal(const Space *space, XrTime time) {
+    XrPosef origin = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+    if (space->action) {
+        origin = ScriptedHandPose(space->hand, time);
+    } else if (space->referenceSpaceType == XR_REFERENCE_SPACE_TYPE_VIEW) {
+        origin = ScriptedHeadPose(time);
+    } else if (space->referenceSpaceType == XR_REFERENCE_SPACE_TYPE_STAGE) {
+        origin.position.y = -1.6f;  // LOCAL is at standing eye height.
+    }
+    return Multiply(origin, space->offset);
+}
+
+static XrTime PredictedDisplayTime(uint64_t frameIndex) {
+    return startTime + static_cast<XrTime>(frameIndex) * GetConfig().displayPeriod;
+}
+
+static int HandFromPath(const Instance *instance, XrPath path) {
+    if (path >= instance->paths.size()) {
+        return -1;
+    }
+    const std::string &string = instance->paths[path];
+    if (string.compare(0, 15, "/user/hand/left") == 0) {
+        return 0;
+    }
+    if (string.compare(0, 16, "/user/hand/right") == 0) {
+        return 1;
+    }
+    return -1;
+}
+
+static XrPath GetPath(Instance *instance, const std::string &string) {
+    auto it = instance->pathIndices.find(string);
+    if (it != instance->pathIndices.end()) {
+        return it->second;
+    }
+    XrPath path = static_cast<XrPath>(instance->paths.size());
+    instance->paths.push_back(string);
+    instance->pathIndices[string] = path;
+    return path;
+}
+
+static bool IsExtensionEnabled(const Instance *instance, const char *extension) {
+    for (const std::string &enabledExtension : instance->enabledExtensions) {
+        if (enabledExtension == extension) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+static void PushEvent(Instance *instance, const T &event) {
+    XrEventDataBuffer buffer{XR_TYPE_EVENT_DATA_BUFFER};
+    static_assert(sizeof(T) <= sizeof(XrEventDataBuffer), "Event is larger than XrEventDataBuffer.");
+    memcpy(&buffer, &event, sizeof(T));
+    instance->events.push_back(buffer);
+}
+
+static void SetSessionState(Session *session, XrSessionState state) {
+    session->state = state;
+    XrEventDataSessionStateChanged event{XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED};
+    event.session = (XrSession)(uintptr_t)session;
+    event.state = state;
+    event.time = PredictedDisplayTime(session->frameIndex);
+    PushEvent(session->instance, event);
+}
+
+static void StopSession(Session *session) {
+    if (session->exitRequested) {
+        return;
+    }
+    session->exitRequested = true;
+    if (session->state == XR_SESSION_STATE_FOCUSED) {
+        SetSessionState(session, XR_SESSION_STATE_VISIBLE);
+    }
+    if (session->state == XR_SESSION_STATE_VISIBLE) {
+        SetSessionState(session, XR_SESSION_STATE_SYNCHRONIZED);
+    }
+    SetSessionState(session, XR_SESSION_STATE_STOPPING);
+}
+
+// Instance
+
+static XrResult XRAPI_CALL EnumerateApiLayerProperties(uint32_t propertyCapacityInput, uint32_t *propertyCountOutput, XrApiLayerProperties *properties) {
+    return WriteArray(0, propertyCapacityInput, propertyCountOutput, properties, [](XrApiLayerProperties &, uint32_t) {});
+}
+
+static XrResult XRAPI_CALL EnumerateInstanceExtensionProperties(const char *layerName, uint32_t propertyCapacityInput, uint32_t *propertyCountOutput, XrExtensionProperties *properties) {
+    if (layerName) {
+        return XR_ERROR_API_LAYER_NOT_PRESENT;
+    }
+    return WriteArray(static_cast<uint32_t>(supportedExtensions.size()), propertyCapacityInput, propertyCountOutput, properties, [](XrExtensionProperties &property, uint32_t i) {
+        strncpy(property.extensionName, supportedExtensions[i].extensionName, XR_MAX_EXTENSION_NAME_SIZE);
+        property.extensionVersion = supportedExtensions[i].extensionVersion;
+    });
+}
+
+static XrResult XRAPI_CALL CreateInstance(const XrInstanceCreateInfo *createInfo, XrInstance *instance) {
+    if (!createInfo || !instance || createInfo->type != XR_TYPE_INSTANCE_CREATE_INFO) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (XR_VERSION_MAJOR(createInfo->applicationInfo.apiVersion) != 1) {
+        return XR_ERROR_API_VERSION_UNSUPPORTED;
+    }
+    Instance *newInstance = new Instance;
+    for (uint32_t i = 0; i < createInfo->enabledExtensionCount; i++) {
+        bool supported = false;
+        for (const XrExtensionProperties &extension : supportedExtensions) {
+            supported |= strcmp(extension.extensionName, createInfo->enabledExtensionNames[i]) == 0;
+        }
+        if (!supported) {
+            delete newInstance;
+            return XR_ERROR_EXTENSION_NOT_PRESENT;
+        }
+        newInstance->enabledExtensions.push_back(createInfo->enabledExtensionNames[i]);
+    }
+    *instance = CreateHandle<XrInstance>(newInstance);
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL DestroyInstance(XrInstance instance) {
+    Instance *object = FindObject<Instance>(instance);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    DestroyObject(object);
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL GetInstanceProperties(XrInstance instance, XrInstanceProperties *instanceProperties) {
+    if (!FindObject<Instance>(instance)) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    instanceProperties->runtimeVersion = XR_MAKE_VERSION(1, 0, 0);
+    strncpy(instanceProperties->runtimeName, "OpenXR Tutorial Mock Runtime", XR_MAX_RUNTIME_NAME_SIZE);
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL PollEvent(XrInstance instance, XrEventDataBuffer *eventData) {
+    Instance *object = FindObject<Instance>(instance);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (object->events.empty()) {
+        return XR_EVENT_UNAVAILABLE;
+    }
+    *eventData = object->events.front();
+    object->events.pop_front();
+    return XR_SUCCESS;
+}
+
+#define MOCK_RUNTIME_ENUM_NAME(name, value) {name, #name},
+
+static XrResult XRAPI_CALL ResultToString(XrInstance instance, XrResult value, char buffer[XR_MAX_RESULT_STRING_SIZE]) {
+    static const std::unordered_map<int32_t, const char *> names = {XR_LIST_ENUM_XrResult(MOCK_RUNTIME_ENUM_NAME)};
+    auto it = names.find(value);
+    if (it != names.end()) {
+        snprintf(buffer, XR_MAX_RESULT_STRING_SIZE, "%s", it->second);
+    } else {
+        snprintf(buffer, XR_MAX_RESULT_STRING_SIZE, "XR_UNKNOWN_%s_%d", value < 0 ? "FAILURE" : "SUCCESS", value);
+    }
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StructureTypeToString(XrInstance instance, XrStructureType value, char buffer[XR_MAX_STRUCTURE_NAME_SIZE]) {
+    static const std::unordered_map<int32_t, const char *> names = {XR_LIST_ENUM_XrStructureType(MOCK_RUNTIME_ENUM_NAME)};
+    auto it = names.find(value);
+    if (it != names.end()) {
+        snprintf(buffer, XR_MAX_STRUCTURE_NAME_SIZE, "%s", it->second);
+    } else {
+        snprintf(buffer, XR_MAX_STRUCTURE_NAME_SIZE, "XR_UNKNOWN_STRUCTURE_TYPE_%d", value);
+    }
+    return XR_SUCCESS;
+}
+
+// System
+
+static XrResult XRAPI_CALL GetSystem(XrInstance instance, const XrSystemGetInfo *getInfo, XrSystemId *systemIdOutput) {
+    if (!FindObject<Instance>(instance)) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (getInfo->formFactor != XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY) {
+        return XR_ERROR_FORM_FACTOR_UNSUPPORTED;
+    }
+    *systemIdOutput = systemId;
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL GetSystemProperties(XrInstance instance, XrSystemId system, XrSystemProperties *properties) {
+    if (!FindObject<Instance>(instance)) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (system != systemId) {
+        return XR_ERROR_SYSTEM_INVALID;
+    }
+    properties->systemId = systemId;
+    properties->vendorId = 0;
+    strncpy(properties->systemName, "OpenXR Tutorial Mock System", XR_MAX_SYSTEM_NAME_SIZE);
+    properties->graphicsProperties = {4096, 4096, XR_MIN_COMPOSITION_LAYERS_SUPPORTED};
+    properties->trackingProperties = {XR_TRUE, XR_TRUE};
+    for (XrBaseOutStructure *next = reinterpret_cast<XrBaseOutStructure *>(properties->next); next; next = next->next) {
+        if (next->type == XR_TYPE_SYSTEM_HAND_TRACKING_PROPERTIES_EXT) {
+            reinterpret_cast<XrSystemHandTrackingPropertiesEXT *>(next)->supportsHandTracking = XR_TRUE;
+        }
+    }
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL EnumerateEnvironmentBlendModes(XrInstance instance, XrSystemId system, XrViewConfigurationType viewConfigurationType, uint32_t environmentBlendModeCapacityInput, uint32_t *environmentBlendModeCountOutput, XrEnvironmentBlendMode *environmentBlendModes) {
+    if (!FindObject<Instance>(instance)) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    return WriteArray(std::vector<XrEnvironmentBlendMode>{XR_ENVIRONMENT_BLEND_MODE_OPAQUE}, environmentBlendModeCapacityInput, environmentBlendModeCountOutput, environmentBlendModes);
+}
+
+static XrResult XRAPI_CALL EnumerateViewConfigurations(XrInstance instance, XrSystemId system, uint32_t viewConfigurationTypeCapacityInput, uint32_t *viewConfigurationTypeCountOutput, XrViewConfigurationType *viewConfigurationTypes) {
+    if (!FindObject<Instance>(instance)) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    return WriteArray(std::vector<XrViewConfigurationType>{XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, XR_VIEW_CONFIGURATION_TYPE_PRIMARY_MONO}, viewConfigurationTypeCapacityInput, viewConfigurationTypeCountOutput, viewConfigurationTypes);
+}
+
+static uint32_t GetViewCount(XrViewConfigurationType viewConfigurationType) {
+    return viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO ? 2 : viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_MONO ? 1 : 0;
+}
+
+static XrResult XRAPI_CALL GetViewConfigurationProperties(XrInstance instance, XrSystemId system, XrViewConfigurationType viewConfigurationType, XrViewConfigurationProperties *configurationProperties) {
+    if (!FindObject<Instance>(instance)) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (GetViewCount(viewConfigurationType) == 0) {
+        return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+    }
+    configurationProperties->viewConfigurationType = viewConfigurationType;
+    configurationProperties->fovMutable = XR_FALSE;
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL EnumerateViewConfigurationViews(XrInstance instance, XrSystemId system, XrViewConfigurationType viewConfigurationType, uint32_t viewCapacityInput, uint32_t *viewCountOutput, XrViewConfigurationView *views) {
+    if (!FindObject<Instance>(instance)) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (GetViewCount(viewConfigurationType) == 0) {
+        return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+    }
+    return WriteArray(GetViewCount(viewConfigurationType), viewCapacityInput, viewCountOutput, views, [](XrViewConfigurationView &view, uint32_t) {
+        view.recommendedImageRectWidth = 1024;
+        view.maxImageRectWidth = 4096;
+        view.recommendedImageRectHeight = 1024;
+        view.maxImageRectHeight = 4096;
+        view.recommendedSwapchainSampleCount = 1;
+        view.maxSwapchainSampleCount = 1;
+    });
+}
+
+// Session
+
+static XrResult XRAPI_CALL CreateSession(XrInstance instance, const XrSessionCreateInfo *createInfo, XrSession *session) {
+    Instance *object = FindObject<Instance>(instance);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (createInfo->systemId != systemId) {
+        return XR_ERROR_SYSTEM_INVALID;
+    }
+    // There is no graphics device to bind to.
+    if (!IsExtensionEnabled(object, XR_MND_HEADLESS_EXTENSION_NAME) || createInfo->next) {
+        return XR_ERROR_GRAPHICS_DEVICE_INVALID;
+    }
+    if (object->session) {
+        return XR_ERROR_LIMIT_REACHED;
+    }
+    Session *newSession = new Session;
+    newSession->instance = object;
+    object->session = newSession;
+    *session = CreateHandle<XrSession>(newSession);
+    SetSessionState(newSession, XR_SESSION_STATE_IDLE);
+    SetSessionState(newSession, XR_SESSION_STATE_READY);
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL DestroySession(XrSession session) {
+    Session *object = FindObject<Session>(session);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    object->instance->session = nullptr;
+    DestroyObject(object);
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL BeginSession(XrSession session, const XrSessionBeginInfo *beginInfo) {
+    Session *object = FindObject<Session>(session);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (object->running) {
+        return XR_ERROR_SESSION_RUNNING;
+    }
+    if (object->state != XR_SESSION_STATE_READY) {
+        return XR_ERROR_SESSION_NOT_READY;
+    }
+    if (GetViewCount(beginInfo->primaryViewConfigurationType) == 0) {
+        return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+    }
+    object->viewConfiguration = beginInfo->primaryViewConfigurationType;
+    object->running = true;
+    SetSessionState(object, XR_SESSION_STATE_SYNCHRONIZED);
+    SetSessionState(object, XR_SESSION_STATE_VISIBLE);
+    SetSessionState(object, XR_SESSION_STATE_FOCUSED);
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL EndSession(XrSession session) {
+    Session *object = FindObject<Session>(session);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (!object->running) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    if (object->state != XR_SESSION_STATE_STOPPING) {
+        return XR_ERROR_SESSION_NOT_STOPPING;
+    }
+    object->running = false;
+    SetSessionState(object, XR_SESSION_STATE_IDLE);
+    SetSessionState(object, XR_SESSION_STATE_EXITING);
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL RequestExitSession(XrSession session) {
+    Session *object = FindObject<Session>(session);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (!object->running) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    StopSession(object);
+    return XR_SUCCESS;
+}
+
+// Frame loop
+
+static XrResult XRAPI_CALL WaitFrame(XrSession session, const XrFrameWaitInfo *frameWaitInfo, XrFrameState *frameState) {
+    Session *object = FindObject<Session>(session);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (!object->running) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    // Don't wait for a display: the frame loop runs as fast as the application can go, but times advance at a fixed rate.
+    object->frameIndex++;
+    object->frameWaited = true;
+    frameState->predictedDisplayTime = PredictedDisplayTime(object->frameIndex);
+    frameState->predictedDisplayPeriod = GetConfig().displayPeriod;
+    frameState->shouldRender = object->state == XR_SESSION_STATE_VISIBLE || object->state == XR_SESSION_STATE_FOCUSED;
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL BeginFrame(XrSession session, const XrFrameBeginInfo *frameBeginInfo) {
+    Session *object = FindObject<Session>(session);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (!object->running) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    if (!object->frameWaited) {
+        return XR_ERROR_CALL_ORDER_INVALID;
+    }
+    object->frameWaited = false;
+    if (object->frameBegun) {
+        return XR_FRAME_DISCARDED;
+    }
+    object->frameBegun = true;
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL EndFrame(XrSession session, const XrFrameEndInfo *frameEndInfo) {
+    Session *object = FindObject<Session>(session);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (!object->running) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    if (!object->frameBegun) {
+        return XR_ERROR_CALL_ORDER_INVALID;
+    }
+    if (frameEndInfo->displayTime <= 0) {
+        return XR_ERROR_TIME_INVALID;
+    }
+    if (frameEndInfo->environmentBlendMode != XR_ENVIRONMENT_BLEND_MODE_OPAQUE) {
+        return XR_ERROR_ENVIRONMENT_BLEND_MODE_UNSUPPORTED;
+    }
+    if (frameEndInfo->layerCount > XR_MIN_COMPOSITION_LAYERS_SUPPORTED) {
+        return XR_ERROR_LAYER_LIMIT_EXCEEDED;
+    }
+    object->frameBegun = false;
+    object->framesEnded++;
+    if (GetConfig().frameCount != 0 && object->framesEnded >= GetConfig().frameCount) {
+        StopSession(object);
+    }
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL LocateViews(XrSession session, const XrViewLocateInfo *viewLocateInfo, XrViewState *viewState, uint32_t viewCapacityInput, uint32_t *viewCountOutput, XrView *views) {
+    Session *object = FindObject<Session>(session);
+    Space *space = FindObject<Space>(viewLocateInfo->space);
+    if (!object || !space) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    uint32_t viewCount = GetViewCount(viewLocateInfo->viewConfigurationType);
+    if (viewCount == 0) {
+        return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+    }
+    viewState->viewStateFlags = XR_VIEW_STATE_ORIENTATION_VALID_BIT | XR_VIEW_STATE_POSITION_VALID_BIT | XR_VIEW_STATE_ORIENTATION_TRACKED_BIT | XR_VIEW_STATE_POSITION_TRACKED_BIT;
+    XrPosef headInSpace = Multiply(Invert(LocateInLocal(space, viewLocateInfo->displayTime)), ScriptedHeadPose(viewLocateInfo->displayTime));
+    return WriteArray(viewCount, viewCapacityInput, viewCountOutput, views, [&](XrView &view, uint32_t i) {
+        float eyeOffset = viewCount == 1 ? 0.0f : (i == 0 ? -0.032f : 0.032f);
+        view.pose = Multiply(headInSpace, {{0.0f, 0.0f, 0.0f, 1.0f}, {eyeOffset, 0.0f, 0.0f}});
+        view.fov = {-0.8f, 0.8f, 0.8f, -0.8f};
+    });
+}
+
+// Spaces
+
+static XrResult XRAPI_CALL EnumerateReferenceSpaces(XrSession session, uint32_t spaceCapacityInput, uint32_t *spaceCountOutput, XrReferenceSpaceType *spaces) {
+    if (!FindObject<Session>(session)) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    return WriteArray(std::vector<XrReferenceSpaceType>{XR_REFERENCE_SPACE_TYPE_VIEW, XR_REFERENCE_SPACE_TYPE_LOCAL, XR_REFERENCE_SPACE_TYPE_STAGE}, spaceCapacityInput, spaceCountOutput, spaces);
+}
+
+static XrResult XRAPI_CALL CreateReferenceSpace(XrSession session, const XrReferenceSpaceCreateInfo *createInfo, XrSpace *space) {
+    Session *object = FindObject<Session>(session);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (createInfo->referenceSpaceType != XR_REFERENCE_SPACE_TYPE_VIEW && createInfo->referenceSpaceType != XR_REFERENCE_SPACE_TYPE_LOCAL && createInfo->referenceSpaceType != XR_REFERENCE_SPACE_TYPE_STAGE) {
+        return XR_ERROR_REFERENCE_SPACE_UNSUPPORTED;
+    }
+    *space = CreateHandle<XrSpace>(new Space{object, createInfo->referenceSpaceType, nullptr, -1, createInfo->poseInReferenceSpace});
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL GetReferenceSpaceBoundsRect(XrSession session, XrReferenceSpaceType referenceSpaceType, XrExtent2Df *bounds) {
+    if (!FindObject<Session>(session)) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    *bounds = {0.0f, 0.0f};
+    return XR_SPACE_BOUNDS_UNAVAILABLE;
+}
+
+static XrResult XRAPI_CALL CreateActionSpace(XrSession session, const XrActionSpaceCreateInfo *createInfo, XrSpace *space) {
+    Session *object = FindObject<Session>(session);
+    Action *action = FindObject<Action>(createInfo->action);
+    if (!object || !action) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (action->type != XR_ACTION_TYPE_POSE_INPUT) {
+        return XR_ERROR_ACTION_TYPE_MISMATCH;
+    }
+    int hand = createInfo->subactionPath == XR_NULL_PATH ? 0 : HandFromPath(object->instance, createInfo->subactionPath);
+    if (hand < 0) {
+        return XR_ERROR_PATH_UNSUPPORTED;
+    }
+    *space = CreateHandle<XrSpace>(new Space{object, XR_REFERENCE_SPACE_TYPE_MAX_ENUM, action, hand, createInfo->poseInActionSpace});
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL LocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation *location) {
+    Space *object = FindObject<Space>(space);
+    Space *base = FindObject<Space>(baseSpace);
+    if (!object || !base) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (time <= 0) {
+        return XR_ERROR_TIME_INVALID;
+    }
+    bool tracked = (!object->action || object->action->bound[object->hand]) && (!base->action || base->action->bound[base->hand]);
+    if (!tracked) {
+        location->locationFlags = 0;
+        return XR_SUCCESS;
+    }
+    location->locationFlags = XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_POSITION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT | XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
+    location->pose = Multiply(Invert(LocateInLocal(base, time)), LocateInLocal(object, time));
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL DestroySpace(XrSpace space) {
+    Space *object = FindObject<Space>(space);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    DestroyObject(object);
+    return XR_SUCCESS;
+}
+
+// Swapchains
+
+static XrResult XRAPI_CALL EnumerateSwapchainFormats(XrSession session, uint32_t formatCapacityInput, uint32_t *formatCountOutput, int64_t *formats) {
+    if (!FindObject<Session>(session)) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    return WriteArray(swapchainFormats, formatCapacityInput, formatCountOutput, formats);
+}
+
+static XrResult XRAPI_CALL CreateSwapchain(XrSession session, const XrSwapchainCreateInfo *createInfo, XrSwapchain *swapchain) {
+    Session *object = FindObject<Session>(session);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    bool formatSupported = false;
+    for (int64_t format : swapchainFormats) {
+        formatSupported |= format == createInfo->format;
+    }
+    if (!formatSupported) {
+        return XR_ERROR_SWAPCHAIN_FORMAT_UNSUPPORTED;
+    }
+    if (createInfo->width == 0 || createInfo->height == 0 || createInfo->width > 4096 || createInfo->height > 4096) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    *swapchain = CreateHandle<XrSwapchain>(new Swapchain{object, *createInfo});
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL DestroySwapchain(XrSwapchain swapchain) {
+    Swapchain *object = FindObject<Swapchain>(swapchain);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    DestroyObject(object);
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL EnumerateSwapchainImages(XrSwapchain swapchain, uint32_t imageCapacityInput, uint32_t *imageCountOutput, XrSwapchainImageBaseHeader *images) {
+    if (!FindObject<Swapchain>(swapchain)) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    // The images belong to GraphicsAPI_Null, so there is nothing to write.
+    return WriteArray(swapchainImageCount, imageCapacityInput, imageCountOutput, images, [](XrSwapchainImageBaseHeader &, uint32_t) {});
+}
+
+static XrResult XRAPI_CALL AcquireSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageAcquireInfo *acquireInfo, uint32_t *index) {
+    Swapchain *object = FindObject<Swapchain>(swapchain);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (object->acquiredCount == swapchainImageCount) {
+        return XR_ERROR_CALL_ORDER_INVALID;
+    }
+    *index = object->nextIndex;
+    object->nextIndex = (object->nextIndex + 1) % swapchainImageCount;
+    object->acquiredCount++;
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL WaitSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageWaitInfo *waitInfo) {
+    Swapchain *object = FindObject<Swapchain>(swapchain);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (object->acquiredCount == 0) {
+        return XR_ERROR_CALL_ORDER_INVALID;
+    }
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL ReleaseSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageReleaseInfo *releaseInfo) {
+    Swapchain *object = FindObject<Swapchain>(swapchain);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (object->acquiredCount == 0) {
+        return XR_ERROR_CALL_ORDER_INVALID;
+    }
+    object->acquiredCount--;
+    return XR_SUCCESS;
+}
+
+// Paths
+
+static XrResult XRAPI_CALL StringToPath(XrInstance instance, const char *pathString, XrPath *path) {
+    Instance *object = FindObject<Instance>(instance);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (!pathString || pathString[0] != '/' || strlen(pathString) >= XR_MAX_PATH_LENGTH) {
+        return XR_ERROR_PATH_FORMAT_INVALID;
+    }
+    *path = GetPath(object, pathString);
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL PathToString(XrInstance instance, XrPath path, uint32_t bufferCapacityInput, uint32_t *bufferCountOutput, char *buffer) {
+    Instance *object = FindObject<Instance>(instance);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (path == XR_NULL_PATH || path >= object->paths.size()) {
+        return XR_ERROR_PATH_INVALID;
+    }
+    const std::string &string = object->paths[path];
+    return WriteArray(static_cast<uint32_t>(string.size() + 1), bufferCapacityInput, bufferCountOutput, buffer, [&](char &c, uint32_t i) { c = string.c_str()[i]; });
+}
+
+// Actions
+
+static XrResult XRAPI_CALL CreateActionSet(XrInstance instance, const XrActionSetCreateInfo *createInfo, XrActionSet *actionSet) {
+    Instance *object = FindObject<Instance>(instance);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    *actionSet = CreateHandle<XrActionSet>(new ActionSet{object});
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL DestroyActionSet(XrActionSet actionSet) {
+    ActionSet *object = FindObject<ActionSet>(actionSet);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    for (Action *action : object->actions) {
+        DestroyObject(action);
+    }
+    DestroyObject(object);
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL CreateAction(XrActionSet actionSet, const XrActionCreateInfo *createInfo, XrAction *action) {
+    ActionSet *object = FindObject<ActionSet>(actionSet);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (object->attached) {
+        return XR_ERROR_ACTIONSETS_ALREADY_ATTACHED;
+    }
+    Action *newAction = new Action;
+    newAction->actionSet = object;
+    newAction->type = createInfo->actionType;
+    newAction->subactionPaths.assign(createInfo->subactionPaths, createInfo->subactionPaths + createInfo->countSubactionPaths);
+    object->actions.push_back(newAction);
+    *action = CreateHandle<XrAction>(newAction);
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL DestroyAction(XrAction action) {
+    Action *object = FindObject<Action>(action);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    std::vector<Action *> &actions = object->actionSet->actions;
+    for (auto it = actions.begin(); it != actions.end(); ++it) {
+        if (*it == object) {
+            actions.erase(it);
+            break;
+        }
+    }
+    DestroyObject(object);
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL SuggestInteractionProfileBindings(XrInstance instance, const XrInteractionProfileSuggestedBinding *suggestedBindings) {
+    Instance *object = FindObject<Instance>(instance);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    std::vector<std::pair<XrAction, XrPath>> &bindings = object->suggestedBindings[suggestedBindings->interactionProfile];
+    bindings.clear();
+    for (uint32_t i = 0; i < suggestedBindings->countSuggestedBindings; i++) {
+        Action *action = FindObject<Action>(suggestedBindings->suggestedBindings[i].action);
+        if (!action) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+        if (action->actionSet->attached) {
+            return XR_ERROR_ACTIONSETS_ALREADY_ATTACHED;
+        }
+        bindings.push_back({suggestedBindings->suggestedBindings[i].action, suggestedBindings->suggestedBindings[i].binding});
+    }
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL AttachSessionActionSets(XrSession session, const XrSessionActionSetsAttachInfo *attachInfo) {
+    Session *object = FindObject<Session>(session);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (object->interactionProfile != XR_NULL_PATH) {
+        return XR_ERROR_ACTIONSETS_ALREADY_ATTACHED;
+    }
+    for (uint32_t i = 0; i < attachInfo->countActionSets; i++) {
+        ActionSet *actionSet = FindObject<ActionSet>(attachInfo->actionSets[i]);
+        if (!actionSet) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+        actionSet->attached = true;
+    }
+
+    // The mock devices are bound to the interaction profile with the most suggested bindings.
+    Instance *instance = object->instance;
+    const std::vector<std::pair<XrAction, XrPath>> *profileBindings = nullptr;
+    for (const auto &suggestedBindings : instance->suggestedBindings) {
+        if (!profileBindings || suggestedBindings.second.size() > profileBindings->size()) {
+            object->interactionProfile = suggestedBindings.first;
+            profileBindings = &suggestedBindings.second;
+        }
+    }
+    if (!profileBindings) {
+        return XR_SUCCESS;
+    }
+    for (const std::pair<XrAction, XrPath> &binding : *profileBindings) {
+        Action *action = FindObject<Action>(binding.first);
+        int hand = HandFromPath(instance, binding.second);
+        if (action && hand >= 0) {
+            action->bound[hand] = true;
+        }
+    }
+    XrEventDataInteractionProfileChanged event{XR_TYPE_EVENT_DATA_INTERACTION_PROFILE_CHANGED};
+    event.session = session;
+    PushEvent(instance, event);
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL GetCurrentInteractionProfile(XrSession session, XrPath topLevelUserPath, XrInteractionProfileState *interactionProfile) {
+    Session *object = FindObject<Session>(session);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (HandFromPath(object->instance, topLevelUserPath) < 0) {
+        interactionProfile->interactionProfile = XR_NULL_PATH;
+        return XR_SUCCESS;
+    }
+    interactionProfile->interactionProfile = object->interactionProfile;
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL SyncActions(XrSession session, const XrActionsSyncInfo *syncInfo) {
+    Session *object = FindObject<Session>(session);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (object->state != XR_SESSION_STATE_FOCUSED) {
+        return XR_SESSION_NOT_FOCUSED;
+    }
+    // Sample the script at the time of the frame that the application is working on.
+    XrTime time = PredictedDisplayTime(object->frameIndex);
+    for (uint32_t i = 0; i < syncInfo->countActiveActionSets; i++) {
+        ActionSet *actionSet = FindObject<ActionSet>(syncInfo->activeActionSets[i].actionSet);
+        if (!actionSet) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+        if (!actionSet->attached) {
+            return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+        }
+        for (Action *action : actionSet->actions) {
+            for (int hand = 0; hand < 2; hand++) {
+                XrActionStateBoolean &booleanState = action->booleanState[hand];
+                XrActionStateFloat &floatState = action->floatState[hand];
+                bool booleanValue = action->bound[hand] && ScriptedBooleanInput(hand, time);
+                float floatValue = action->bound[hand] ? ScriptedFloatInput(hand, time) : 0.0f;
+                booleanState.changedSinceLastSync = (booleanState.currentState != 0) != booleanValue;
+                booleanState.currentState = booleanValue;
+                booleanState.isActive = action->bound[hand];
+                booleanState.lastChangeTime = booleanState.changedSinceLastSync ? time : booleanState.lastChangeTime;
+                floatState.changedSinceLastSync = floatState.currentState != floatValue;
+                floatState.currentState = floatValue;
+                floatState.isActive = action->bound[hand];
+                floatState.lastChangeTime = floatState.changedSinceLastSync ? time : floatState.lastChangeTime;
+            }
+        }
+    }
+    return XR_SUCCESS;
+}
+
+// Returns the hand for the subaction path of a get info, or -1 if the action has no such subaction path.
+// The state of an action queried with XR_NULL_PATH is that of the left hand.
+static int GetActionStateHand(Session *session, const XrActionStateGetInfo *getInfo, Action *&action) {
+    action = FindObject<Action>(getInfo->action);
+    if (!action || getInfo->subactionPath == XR_NULL_PATH) {
+        return 0;
+    }
+    return HandFromPath(session->instance, getInfo->subactionPath);
+}
+
+template <typename T>
+static XrResult GetActionState(XrSession session, const XrActionStateGetInfo *getInfo, XrActionType type, T &state, T (Action::*actionStates)[2]) {
+    Session *object = FindObject<Session>(session);
+    Action *action = nullptr;
+    int hand = object ? GetActionStateHand(object, getInfo, action) : 0;
+    if (!object || !action) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (action->type != type) {
+        return XR_ERROR_ACTION_TYPE_MISMATCH;
+    }
+    if (!action->actionSet->attached) {
+        return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+    }
+    if (hand < 0) {
+        return XR_ERROR_PATH_UNSUPPORTED;
+    }
+    void *next = state.next;
+    state = (action->*actionStates)[hand];
+    state.next = next;
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL GetActionStateBoolean(XrSession session, const XrActionStateGetInfo *getInfo, XrActionStateBoolean *state) {
+    return GetActionState(session, getInfo, XR_ACTION_TYPE_BOOLEAN_INPUT, *state, &Action::booleanState);
+}
+
+static XrResult XRAPI_CALL GetActionStateFloat(XrSession session, const XrActionStateGetInfo *getInfo, XrActionStateFloat *state) {
+    return GetActionState(session, getInfo, XR_ACTION_TYPE_FLOAT_INPUT, *state, &Action::floatState);
+}
+
+static XrResult XRAPI_CALL GetActionStateVector2f(XrSession session, const XrActionStateGetInfo *getInfo, XrActionStateVector2f *state) {
+    Session *object = FindObject<Session>(session);
+    Action *action = object ? FindObject<Action>(getInfo->action) : nullptr;
+    if (!object || !action) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (action->type != XR_ACTION_TYPE_VECTOR2F_INPUT) {
+        return XR_ERROR_ACTION_TYPE_MISMATCH;
+    }
+    // No thumbsticks are scripted.
+    state->currentState = {0.0f, 0.0f};
+    state->changedSinceLastSync = XR_FALSE;
+    state->lastChangeTime = 0;
+    state->isActive = XR_FALSE;
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL GetActionStatePose(XrSession session, const XrActionStateGetInfo *getInfo, XrActionStatePose *state) {
+    Session *object = FindObject<Session>(session);
+    Action *action = nullptr;
+    int hand = object ? GetActionStateHand(object, getInfo, action) : 0;
+    if (!object || !action) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (action->type != XR_ACTION_TYPE_POSE_INPUT) {
+        return XR_ERROR_ACTION_TYPE_MISMATCH;
+    }
+    if (hand < 0) {
+        return XR_ERROR_PATH_UNSUPPORTED;
+    }
+    state->isActive = action->bound[hand];
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL ApplyHapticFeedback(XrSession session, const XrHapticActionInfo *hapticActionInfo, const XrHapticBaseHeader *hapticFeedback) {
+    if (!FindObject<Session>(session) || !FindObject<Action>(hapticActionInfo->action)) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StopHapticFeedback(XrSession session, const XrHapticActionInfo *hapticActionInfo) {
+    if (!FindObject<Session>(session) || !FindObject<Action>(hapticActionInfo->action)) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    return XR_SUCCESS;
+}
+
+// XR_EXT_hand_tracking
+
+static XrResult XRAPI_CALL CreateHandTrackerEXT(XrSession session, const XrHandTrackerCreateInfoEXT *createInfo, XrHandTrackerEXT *handTracker) {
+    Session *object = FindObject<Session>(session);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (!IsExtensionEnabled(object->instance, XR_EXT_HAND_TRACKING_EXTENSION_NAME)) {
+        return XR_ERROR_FUNCTION_UNSUPPORTED;
+    }
+    if (createInfo->handJointSet != XR_HAND_JOINT_SET_DEFAULT_EXT) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    *handTracker = CreateHandle<XrHandTrackerEXT>(new HandTracker{object, createInfo->hand});
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL DestroyHandTrackerEXT(XrHandTrackerEXT handTracker) {
+    HandTracker *object = FindObject<HandTracker>(handTracker);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    DestroyObject(object);
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL LocateHandJointsEXT(XrHandTrackerEXT handTracker, const XrHandJointsLocateInfoEXT *locateInfo, XrHandJointLocationsEXT *locations) {
+    HandTracker *object = FindObject<HandTracker>(handTracker);
+    Space *base = FindObject<Space>(locateInfo->baseSpace);
+    if (!object || !base) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (locations->jointCount != XR_HAND_JOINT_COUNT_EXT) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    int hand = object->hand == XR_HAND_LEFT_EXT ? 0 : 1;
+    XrPosef palmInBase = Multiply(Invert(LocateInLocal(base, locateInfo->time)), ScriptedHandPose(hand, locateInfo->time));
+    locations->isActive = XR_TRUE;
+    for (uint32_t i = 0; i < locations->jointCount; i++) {
+        XrHandJointLocationEXT &jointLocation = locations->jointLocations[i];
+        jointLocation.locationFlags = XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_POSITION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT | XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
+        jointLocation.pose = Multiply(palmInBase, ScriptedHandJointPose(hand, i));
+        jointLocation.radius = i == XR_HAND_JOINT_PALM_EXT || i == XR_HAND_JOINT_WRIST_EXT ? 0.02f : 0.008f;
+    }
+    return XR_SUCCESS;
+}
+
+// XR_EXT_debug_utils. The runtime has nothing to report, so messengers never receive messages.
+
+static XrResult XRAPI_CALL CreateDebugUtilsMessengerEXT(XrInstance instance, const XrDebugUtilsMessengerCreateInfoEXT *createInfo, XrDebugUtilsMessengerEXT *messenger) {
+    Instance *object = FindObject<Instance>(instance);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    *messenger = CreateHandle<XrDebugUtilsMessengerEXT>(new DebugUtilsMessenger{object});
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL DestroyDebugUtilsMessengerEXT(XrDebugUtilsMessengerEXT messenger) {
+    DebugUtilsMessenger *object = FindObject<DebugUtilsMessenger>(messenger);
+    if (!object) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    DestroyObject(object);
+    return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL SetDebugUtilsObjectNameEXT(XrInstance instance, const XrDebugUtilsObjectNameInfoEXT *nameInfo) {
+    return FindObject<Instance>(instance) ? XR_SUCCESS : XR_ERROR_HANDLE_INVALID;
+}
+
+static XrResult XRAPI_CALL SubmitDebugUtilsMessageEXT(XrInstance instance, XrDebugUtilsMessageSeverityFlagsEXT messageSeverity, XrDebugUtilsMessageTypeFlagsEXT messageTypes, const XrDebugUtilsMessengerCallbackDataEXT *callbackData) {
+    return FindObject<Instance>(instance) ? XR_SUCCESS : XR_ERROR_HANDLE_INVALID;
+}
+
+static XrResult XRAPI_CALL GetInstanceProcAddr(XrInstance instance, const char *name, PFN_xrVoidFunction *function);
+
+#define MOCK_RUNTIME_FUNCTION(name) {"xr" #name, reinterpret_cast<PFN_xrVoidFunction>(name)}
+
+static const std::unordered_map<std::string, PFN_xrVoidFunction> &GetFunctions() {
+    static const std::unordered_map<std::string, PFN_xrVoidFunction> functions = {
+        MOCK_RUNTIME_FUNCTION(GetInstanceProcAddr),
+        MOCK_RUNTIME_FUNCTION(EnumerateApiLayerProperties),
+        MOCK_RUNTIME_FUNCTION(EnumerateInstanceExtensionProperties),
+        MOCK_RUNTIME_FUNCTION(CreateInstance),
+        MOCK_RUNTIME_FUNCTION(DestroyInstance),
+        MOCK_RUNTIME_FUNCTION(GetInstanceProperties),
+        MOCK_RUNTIME_FUNCTION(PollEvent),
+        MOCK_RUNTIME_FUNCTION(ResultToString),
+        MOCK_RUNTIME_FUNCTION(StructureTypeToString),
+        MOCK_RUNTIME_FUNCTION(GetSystem),
+        MOCK_RUNTIME_FUNCTION(GetSystemProperties),
+        MOCK_RUNTIME_FUNCTION(EnumerateEnvironmentBlendModes),
+        MOCK_RUNTIME_FUNCTION(EnumerateViewConfigurations),
+        MOCK_RUNTIME_FUNCTION(GetViewConfigurationProperties),
+        MOCK_RUNTIME_FUNCTION(EnumerateViewConfigurationViews),
+        MOCK_RUNTIME_FUNCTION(CreateSession),
+        MOCK_RUNTIME_FUNCTION(DestroySession),
+        MOCK_RUNTIME_FUNCTION(BeginSession),
+        MOCK_RUNTIME_FUNCTION(EndSession),
+        MOCK_RUNTIME_FUNCTION(RequestExitSession),
+        MOCK_RUNTIME_FUNCTION(WaitFrame),
+        MOCK_RUNTIME_FUNCTION(BeginFrame),
+        MOCK_RUNTIME_FUNCTION(EndFrame),
+        MOCK_RUNTIME_FUNCTION(LocateViews),
+        MOCK_RUNTIME_FUNCTION(EnumerateReferenceSpaces),
+        MOCK_RUNTIME_FUNCTION(CreateReferenceSpace),
+        MOCK_RUNTIME_FUNCTION(GetReferenceSpaceBoundsRect),
+        MOCK_RUNTIME_FUNCTION(CreateActionSpace),
+        MOCK_RUNTIME_FUNCTION(LocateSpace),
+        MOCK_RUNTIME_FUNCTION(DestroySpace),
+        MOCK_RUNTIME_FUNCTION(EnumerateSwapchainFormats),
+        MOCK_RUNTIME_FUNCTION(CreateSwapchain),
+        MOCK_RUNTIME_FUNCTION(DestroySwapchain),
+        MOCK_RUNTIME_FUNCTION(EnumerateSwapchainImages),
+        MOCK_RUNTIME_FUNCTION(AcquireSwapchainImage),
+        MOCK_RUNTIME_FUNCTION(WaitSwapchainImage),
+        MOCK_RUNTIME_FUNCTION(ReleaseSwapchainImage),
+        MOCK_RUNTIME_FUNCTION(StringToPath),
+        MOCK_RUNTIME_FUNCTION(PathToString),
+        MOCK_RUNTIME_FUNCTION(CreateActionSet),
+        MOCK_RUNTIME_FUNCTION(DestroyActionSet),
+        MOCK_RUNTIME_FUNCTION(CreateAction),
+        MOCK_RUNTIME_FUNCTION(DestroyAction),
+        MOCK_RUNTIME_FUNCTION(SuggestInteractionProfileBindings),
+        MOCK_RUNTIME_FUNCTION(AttachSessionActionSets),
+        MOCK_RUNTIME_FUNCTION(GetCurrentInteractionProfile),
+        MOCK_RUNTIME_FUNCTION(SyncActions),
+        MOCK_RUNTIME_FUNCTION(GetActionStateBoolean),
+        MOCK_RUNTIME_FUNCTION(GetActionStateFloat),
+        MOCK_RUNTIME_FUNCTION(GetActionStateVector2f),
+        MOCK_RUNTIME_FUNCTION(GetActionStatePose),
+        MOCK_RUNTIME_FUNCTION(ApplyHapticFeedback),
+        MOCK_RUNTIME_FUNCTION(StopHapticFeedback),
+        MOCK_RUNTIME_FUNCTION(CreateHandTrackerEXT),
+        MOCK_RUNTIME_FUNCTION(DestroyHandTrackerEXT),
+        MOCK_RUNTIME_FUNCTION(LocateHandJointsEXT),
+        MOCK_RUNTIME_FUNCTION(CreateDebugUtilsMessengerEXT),
+        MOCK_RUNTIME_FUNCTION(DestroyDebugUtilsMessengerEXT),
+        MOCK_RUNTIME_FUNCTION(SetDebugUtilsObjectNameEXT),
+        MOCK_RUNTIME_FUNCTION(SubmitDebugUtilsMessageEXT),
+    };
+    return functions;
+}
+
+static XrResult XRAPI_CALL GetInstanceProcAddr(XrInstance instance, const char *name, PFN_xrVoidFunction *function) {
+    if (!name || !function) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    *function = nullptr;
+    // Only these can be called without an instance.
+    bool global = strcmp(name, "xrEnumerateApiLayerProperties") == 0 || strcmp(name, "xrEnumerateInstanceExtensionProperties") == 0 || strcmp(name, "xrCreateInstance") == 0;
+    if (instance == XR_NULL_HANDLE && !global) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    auto it = GetFunctions().find(name);
+    if (it == GetFunctions().end()) {
+        return XR_ERROR_FUNCTION_UNSUPPORTED;
+    }
+    *function = it->second;
+    return XR_SUCCESS;
+}
+
+
+MOCK_RUNTIME_EXPORT XrResult XRAPI_CALL xrNegotiateLoaderRuntimeInterface(const XrNegotiateLoaderInfo *loaderInfo, XrNegotiateRuntimeRequest *runtimeRequest) {
+    if (!loaderInfo || !runtimeRequest ||
+        loaderInfo->structType != XR_LOADER_INTERFACE_STRUCT_LOADER_INFO || loaderInfo->structVersion != XR_LOADER_INFO_STRUCT_VERSION || loaderInfo->structSize != sizeof(XrNegotiateLoaderInfo) ||
+        runtimeRequest->structType != XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST || runtimeRequest->structVersion != XR_RUNTIME_INFO_STRUCT_VERSION || runtimeRequest->structSize != sizeof(XrNegotiateRuntimeRequest)) {
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+    if (loaderInfo->minInterfaceVersion > XR_CURRENT_LOADER_RUNTIME_VERSION || loaderInfo->maxInterfaceVersion < XR_CURRENT_LOADER_RUNTIME_VERSION ||
+        XR_VERSION_MAJOR(loaderInfo->minApiVersion) > 1 || XR_VERSION_MAJOR(loaderInfo->maxApiVersion) < 1) {
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+    runtimeRequest->runtimeInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION;
+    runtimeRequest->runtimeApiVersion = XR_CURRENT_API_VERSION;
+    runtimeRequest->getInstanceProcAddr = GetInstanceProcAddr;
+    return XR_SUCCESS;
+}
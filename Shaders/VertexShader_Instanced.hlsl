@@ -0,0 +1,44 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+cbuffer CameraConstants : register(b0)
+{
+    float4x4 viewProj;
+};
+cbuffer Normals : register(b1)
+{
+    float4 normals[6];
+};
+
+struct VS_IN
+{
+    uint vertexId : SV_VertexId;
+    float4 a_Positions : TEXCOORD0;
+    // Per-instance attributes. The model matrix is passed as its four columns.
+    float4 i_Model0 : TEXCOORD1;
+    float4 i_Model1 : TEXCOORD2;
+    float4 i_Model2 : TEXCOORD3;
+    float4 i_Model3 : TEXCOORD4;
+    float4 i_Color : TEXCOORD5;
+};
+struct VS_OUT
+{
+    float4 o_Position : SV_Position;
+    nointerpolation float2 o_TexCoord : TEXCOORD0;
+    float3 o_Normal : TEXCOORD1;
+    nointerpolation float3 o_Color : TEXCOORD2;
+};
+
+VS_OUT main(VS_IN IN)
+{
+    VS_OUT OUT;
+    // The float4x4 constructor takes rows, so transpose to rebuild the matrix from its columns.
+    float4x4 model = transpose(float4x4(IN.i_Model0, IN.i_Model1, IN.i_Model2, IN.i_Model3));
+    OUT.o_Position = mul(viewProj, mul(model, IN.a_Positions));
+    int face = IN.vertexId / 6;
+    OUT.o_TexCoord = float2(float(face), 0);
+    OUT.o_Normal = (mul(model, normals[face])).xyz;
+    OUT.o_Color = IN.i_Color.rgb;
+    return OUT;
+}
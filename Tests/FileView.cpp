@@ -0,0 +1,91 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+// Times reading a file with FileView against ReadBinaryFile() and ReadTextFile(), for a file the size of a shader and one
+// the size of a large asset. Every byte read is summed, so that the pages of a mapped file are actually read. Returns
+// non-zero if a file can't be read, or if FileView doesn't see the same bytes as ReadBinaryFile().
+
+#include <FileView.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+
+static uint64_t Checksum(const char *data, size_t size) {
+    uint64_t checksum = 0;
+    for (size_t i = 0; i < size; i++) {
+        checksum += static_cast<unsigned char>(data[i]);
+    }
+    return checksum;
+}
+
+// Writes a text file of at least size bytes, made of lines of shader source.
+static bool WriteTestFile(const std::string &filepath, size_t size) {
+    std::ofstream stream(filepath, std::fstream::out | std::fstream::binary);
+    if (!stream.is_open()) {
+        return false;
+    }
+    const std::string line = "    gl_Position = CameraConstants.viewProj * CameraConstants.model * a_Positions[gl_VertexIndex];\n";
+    for (size_t written = 0; written < size; written += line.size()) {
+        stream << line;
+    }
+    return stream.good();
+}
+
+// Returns the average microseconds per call of read(), which returns the checksum of what it read.
+template <typename Read>
+static double Time(size_t iterations, uint64_t &checksum, Read read) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        checksum = read();
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(iterations);
+}
+
+static bool Benchmark(const std::string &filepath, size_t size, size_t iterations) {
+    if (!WriteTestFile(filepath, size)) {
+        std::cout << "ERROR: Failed to write " << filepath << "." << std::endl;
+        return false;
+    }
+
+    // Read each file once before timing, so that all of them start from the OS's file cache.
+    std::vector<char> binary = ReadBinaryFile(filepath);
+    FileView fileView(filepath);
+    bool success = fileView.IsValid() && fileView.size() == binary.size() && memcmp(fileView.data(), binary.data(), binary.size()) == 0;
+    if (!success) {
+        std::cout << "ERROR: FileView doesn't match ReadBinaryFile() for " << filepath << "." << std::endl;
+    }
+
+    uint64_t fileViewChecksum = 0, binaryChecksum = 0, textChecksum = 0;
+    double fileViewTime = Time(iterations, fileViewChecksum, [&]() {
+        FileView view(filepath);
+        return Checksum(view.data(), view.size());
+    });
+    double binaryTime = Time(iterations, binaryChecksum, [&]() {
+        std::vector<char> data = ReadBinaryFile(filepath);
+        return Checksum(data.data(), data.size());
+    });
+    double textTime = Time(iterations, textChecksum, [&]() {
+        std::string data = ReadTextFile(filepath);
+        return Checksum(data.data(), data.size());
+    });
+    std::cout << binary.size() << " bytes: FileView " << fileViewTime << " us, ReadBinaryFile() " << binaryTime << " us, ReadTextFile() " << textTime << " us per read." << std::endl;
+    if (fileViewChecksum != binaryChecksum) {
+        std::cout << "ERROR: FileView read different bytes to ReadBinaryFile() for " << filepath << "." << std::endl;
+        success = false;
+    }
+
+    std::remove(filepath.c_str());
+    return success;
+}
+
+int main() {
+    const std::string directory = std::filesystem::temp_directory_path().string() + "/";
+    bool success = true;
+    success &= Benchmark(directory + "OpenXRTutorialFileViewTest_Shader.glsl", 4 * 1024, 2000);
+    success &= Benchmark(directory + "OpenXRTutorialFileViewTest_Asset.bin", 16 * 1024 * 1024, 10);
+    return success ? 0 : 1;
+}
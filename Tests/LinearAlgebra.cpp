@@ -0,0 +1,162 @@
+// Copyright 2023, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// OpenXR Tutorial for Khronos Group
+
+// Checks that the SSE and NEON paths of xr_linear_algebra.h and xr_linear_algebra_batch.h return the same results as the
+// _Scalar reference versions for random inputs, and times XrMatrix4x4f_Multiply against XrMatrix4x4f_Multiply_Scalar.
+// Returns non-zero if any result differs. Zeros of opposite sign compare equal, as the SIMD versions of
+// XrMatrix4x4f_CreateTranslationRotationScale and the batch functions may differ from the reference in the sign of zeros.
+
+#include <GraphicsAPI.h>
+#include <xr_linear_algebra.h>
+#include <xr_linear_algebra_batch.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+static std::mt19937 randomGenerator(1234);
+
+static float RandomFloat(float min, float max) {
+    return std::uniform_real_distribution<float>(min, max)(randomGenerator);
+}
+
+static XrMatrix4x4f RandomMatrix() {
+    XrMatrix4x4f matrix;
+    for (float &element : matrix.m) {
+        element = RandomFloat(-10.0f, 10.0f);
+    }
+    return matrix;
+}
+
+static XrVector3f RandomVector3f(float min, float max) {
+    return {RandomFloat(min, max), RandomFloat(min, max), RandomFloat(min, max)};
+}
+
+static XrQuaternionf RandomRotation() {
+    XrQuaternionf rotation = {RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f)};
+    float length = sqrtf(rotation.x * rotation.x + rotation.y * rotation.y + rotation.z * rotation.z + rotation.w * rotation.w);
+    return {rotation.x / length, rotation.y / length, rotation.z / length, rotation.w / length};
+}
+
+static bool Equal(const float *a, const float *b, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool Check(bool equal, const char *function, size_t iteration) {
+    if (!equal) {
+        std::cout << "ERROR: " << function << " differs from the _Scalar version for input " << iteration << "." << std::endl;
+    }
+    return equal;
+}
+
+int main() {
+#if defined(XR_LINEAR_SSE)
+    std::cout << "Testing the SSE path." << std::endl;
+#elif defined(XR_LINEAR_NEON)
+    std::cout << "Testing the NEON path." << std::endl;
+#else
+    std::cout << "Testing the scalar path, as neither SSE nor NEON is enabled." << std::endl;
+#endif
+
+    const size_t inputCount = 100000;
+    size_t failures = 0;
+    for (size_t i = 0; i < inputCount; i++) {
+        const XrMatrix4x4f a = RandomMatrix();
+        const XrMatrix4x4f b = RandomMatrix();
+        XrMatrix4x4f result, reference;
+        XrMatrix4x4f_Multiply(&result, &a, &b);
+        XrMatrix4x4f_Multiply_Scalar(&reference, &a, &b);
+        failures += !Check(Equal(result.m, reference.m, 16), "XrMatrix4x4f_Multiply", i);
+
+        const XrVector3f translation = RandomVector3f(-10.0f, 10.0f);
+        const XrQuaternionf rotation = RandomRotation();
+        const XrVector3f scale = RandomVector3f(0.01f, 2.0f);
+        XrMatrix4x4f_CreateTranslationRotationScale(&result, &translation, &rotation, &scale);
+        XrMatrix4x4f_CreateTranslationRotationScale_Scalar(&reference, &translation, &rotation, &scale);
+        failures += !Check(Equal(result.m, reference.m, 16), "XrMatrix4x4f_CreateTranslationRotationScale", i);
+
+        const XrVector3f unitScale = {1.0f, 1.0f, 1.0f};
+        XrMatrix4x4f rigidBody;
+        XrMatrix4x4f_CreateTranslationRotationScale_Scalar(&rigidBody, &translation, &rotation, &unitScale);
+        XrMatrix4x4f_InvertRigidBody(&result, &rigidBody);
+        XrMatrix4x4f_InvertRigidBody_Scalar(&reference, &rigidBody);
+        failures += !Check(Equal(result.m, reference.m, 16), "XrMatrix4x4f_InvertRigidBody", i);
+
+        const XrVector4f v = {RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f)};
+        XrVector4f vectorResult, vectorReference;
+        XrMatrix4x4f_TransformVector4f(&vectorResult, &a, &v);
+        XrMatrix4x4f_TransformVector4f_Scalar(&vectorReference, &a, &v);
+        failures += !Check(Equal(&vectorResult.x, &vectorReference.x, 4), "XrMatrix4x4f_TransformVector4f", i);
+    }
+    std::cout << "Compared " << inputCount << " random inputs of each function, " << failures << " differed." << std::endl;
+
+    // The batch functions, for instance counts that do and don't fill the groups of four.
+    const size_t batchCount = 1000;
+    size_t batchFailures = 0;
+    for (size_t i = 0; i < batchCount; i++) {
+        const uint32_t count = static_cast<uint32_t>(i % 19);
+        const uint32_t viewCount = 2;
+        std::vector<float> soa[10];
+        for (uint32_t j = 0; j < count; j++) {
+            const XrVector3f position = RandomVector3f(-10.0f, 10.0f);
+            const XrQuaternionf orientation = RandomRotation();
+            const XrVector3f scale = RandomVector3f(0.01f, 2.0f);
+            const float elements[10] = {position.x, position.y, position.z, orientation.x, orientation.y, orientation.z, orientation.w, scale.x, scale.y, scale.z};
+            for (int k = 0; k < 10; k++) {
+                soa[k].push_back(elements[k]);
+            }
+        }
+        const XrTransformsSoA transforms = {soa[0].data(), soa[1].data(), soa[2].data(), soa[3].data(), soa[4].data(), soa[5].data(), soa[6].data(), soa[7].data(), soa[8].data(), soa[9].data()};
+        const XrMatrix4x4f viewProjections[viewCount] = {RandomMatrix(), RandomMatrix()};
+
+        std::vector<XrMatrix4x4f> models(count);
+        std::vector<XrMatrix4x4f> modelViewProjections(viewCount * count);
+        XrMatrix4x4f_CreateTranslationRotationScaleBatch(models.data(), sizeof(XrMatrix4x4f), &transforms, count);
+        XrMatrix4x4f_CreateModelViewProjectionBatch(modelViewProjections.data(), sizeof(XrMatrix4x4f), viewProjections, viewCount, &transforms, count);
+        for (uint32_t j = 0; j < count; j++) {
+            XrVector3f position, scale;
+            XrQuaternionf orientation;
+            XrBatch_GetTransform(&transforms, j, &position, &orientation, &scale);
+            XrMatrix4x4f model;
+            XrMatrix4x4f_CreateTranslationRotationScale_Scalar(&model, &position, &orientation, &scale);
+            batchFailures += !Check(Equal(models[j].m, model.m, 16), "XrMatrix4x4f_CreateTranslationRotationScaleBatch", i);
+            for (uint32_t v = 0; v < viewCount; v++) {
+                XrMatrix4x4f modelViewProjection;
+                XrMatrix4x4f_Multiply_Scalar(&modelViewProjection, &viewProjections[v], &model);
+                batchFailures += !Check(Equal(modelViewProjections[v * count + j].m, modelViewProjection.m, 16), "XrMatrix4x4f_CreateModelViewProjectionBatch", i);
+            }
+        }
+    }
+    std::cout << "Compared " << batchCount << " random batches of each batch function, " << batchFailures << " matrices differed." << std::endl;
+    failures += batchFailures;
+
+    // Each multiply depends on the last, so that the calls can't be overlapped or removed. Multiplying by a rotation keeps
+    // the values from overflowing.
+    const size_t multiplyCount = 10000000;
+    const XrQuaternionf rotation = RandomRotation();
+    XrMatrix4x4f b;
+    XrMatrix4x4f_CreateFromQuaternion(&b, &rotation);
+    auto TimeMultiply = [&](const char *name, void (*multiply)(XrMatrix4x4f *, const XrMatrix4x4f *, const XrMatrix4x4f *)) {
+        XrMatrix4x4f result;
+        XrMatrix4x4f_CreateIdentity(&result);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < multiplyCount; i++) {
+            XrMatrix4x4f a = result;
+            multiply(&result, &a, &b);
+        }
+        double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << nanoseconds / static_cast<double>(multiplyCount) << " ns per call (checksum " << result.m[0] << ")." << std::endl;
+    };
+    TimeMultiply("XrMatrix4x4f_Multiply", XrMatrix4x4f_Multiply);
+    TimeMultiply("XrMatrix4x4f_Multiply_Scalar", XrMatrix4x4f_Multiply_Scalar);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -80,20 +80,33 @@ done
 # Full Folder
 echo "ALL"
 zip -r build/common_archs/Common.zip \
+    Common/FileView.cpp \
+    Common/FrameTimings.cpp \
     Common/GraphicsAPI.cpp \
     Common/GraphicsAPI_D3D11.cpp \
     Common/GraphicsAPI_D3D12.cpp \
+    Common/GraphicsAPI_Null.cpp \
     Common/GraphicsAPI_OpenGL.cpp \
     Common/GraphicsAPI_OpenGL_ES.cpp \
     Common/GraphicsAPI_Vulkan.cpp \
+    Common/JobSystem.cpp \
     Common/OpenXRDebugUtils.cpp \
+    Common/SpatialGrid.cpp \
+    Common/ThreadPool.cpp \
     Common/DebugOutput.h \
+    Common/FileView.h \
+    Common/FrameTimings.h \
     Common/GraphicsAPI.h \
     Common/GraphicsAPI_D3D11.h \
     Common/GraphicsAPI_D3D12.h \
+    Common/GraphicsAPI_Null.h \
     Common/GraphicsAPI_OpenGL.h \
     Common/GraphicsAPI_OpenGL_ES.h \
     Common/GraphicsAPI_Vulkan.h \
     Common/HelperFunctions.h \
+    Common/JobSystem.h \
     Common/OpenXRDebugUtils.h \
     Common/OpenXRHelper.h \
+    Common/SpatialGrid.h \
+    Common/ThreadPool.h \
+    Common/TripleBuffer.h \